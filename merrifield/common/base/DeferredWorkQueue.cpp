@@ -0,0 +1,199 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <HwcTrace.h>
+#include <DeferredWorkQueue.h>
+
+namespace android {
+namespace intel {
+
+DeferredWorkQueue::DeferredWorkQueue()
+    : mItems(),
+      mLock(),
+      mCondition(),
+      mIdleCondition(),
+      mVsyncPending(false),
+      mRunning(false),
+      mExitThread(false),
+      mInitialized(false)
+{
+}
+
+DeferredWorkQueue::~DeferredWorkQueue()
+{
+    WARN_IF_NOT_DEINIT();
+}
+
+bool DeferredWorkQueue::initialize()
+{
+    mExitThread = false;
+    mVsyncPending = false;
+    mThread = new DeferredWorkThread(this);
+    if (!mThread.get()) {
+        DEINIT_AND_RETURN_FALSE("failed to create deferred work thread");
+    }
+    mThread->run("DeferredWorkQueue", PRIORITY_NORMAL);
+    mInitialized = true;
+    return true;
+}
+
+void DeferredWorkQueue::deinitialize()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        mExitThread = true;
+        mCondition.signal();
+    }
+
+    if (mThread.get()) {
+        mThread->requestExitAndWait();
+        mThread = NULL;
+    }
+
+    // nothing may be left behind once owners start tearing down
+    mInitialized = false;
+    flush();
+}
+
+void DeferredWorkQueue::queue(DeferredWork *work, nsecs_t latency)
+{
+    if (!work) {
+        return;
+    }
+
+    if (!mInitialized) {
+        work->run();
+        delete work;
+        return;
+    }
+
+    WorkItem item;
+    item.work = work;
+    item.deadline = systemTime(SYSTEM_TIME_MONOTONIC) + latency;
+
+    Mutex::Autolock _l(mLock);
+    mItems.push_back(item);
+    // wake up to track the deadline if vsync is off
+    mCondition.signal();
+}
+
+void DeferredWorkQueue::flush()
+{
+    Vector<WorkItem> items;
+
+    {
+        Mutex::Autolock _l(mLock);
+        // the item being run may still use resources of the caller
+        while (mRunning) {
+            mIdleCondition.wait(mLock);
+        }
+        items = mItems;
+        mItems.clear();
+    }
+
+    for (size_t i = 0; i < items.size(); i++) {
+        runItem(items.itemAt(i));
+    }
+}
+
+void DeferredWorkQueue::onVsync(int64_t timestamp)
+{
+    Mutex::Autolock _l(mLock);
+    if (mItems.size()) {
+        mVsyncPending = true;
+        mCondition.signal();
+    }
+}
+
+ssize_t DeferredWorkQueue::findExpired(nsecs_t now) const
+{
+    for (size_t i = 0; i < mItems.size(); i++) {
+        if (mItems.itemAt(i).deadline <= now) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+nsecs_t DeferredWorkQueue::getEarliestDeadline() const
+{
+    nsecs_t deadline = mItems.itemAt(0).deadline;
+    for (size_t i = 1; i < mItems.size(); i++) {
+        if (mItems.itemAt(i).deadline < deadline) {
+            deadline = mItems.itemAt(i).deadline;
+        }
+    }
+    return deadline;
+}
+
+void DeferredWorkQueue::runItem(const WorkItem& item)
+{
+    item.work->run();
+    delete item.work;
+}
+
+bool DeferredWorkQueue::threadLoop()
+{
+    Mutex::Autolock _l(mLock);
+
+    while (!mExitThread) {
+        nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        if (mVsyncPending || findExpired(now) >= 0) {
+            break;
+        }
+
+        if (mItems.size()) {
+            mCondition.waitRelative(mLock, getEarliestDeadline() - now);
+        } else {
+            mCondition.wait(mLock);
+        }
+    }
+
+    if (mExitThread) {
+        ITRACE("exiting thread loop");
+        return false;
+    }
+
+    // the flip of this period has been latched, spend the budget
+    bool aligned = mVsyncPending;
+    mVsyncPending = false;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    while (mItems.size() && !mExitThread) {
+        nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        ssize_t index = 0;
+        // out of budget, only work that can't wait any longer runs
+        if (!aligned || now - start >= PERIOD_BUDGET) {
+            index = findExpired(now);
+            if (index < 0) {
+                VTRACE("budget used, %d items left", mItems.size());
+                break;
+            }
+        }
+
+        WorkItem item = mItems.itemAt(index);
+        mItems.removeAt(index);
+        mRunning = true;
+        mLock.unlock();
+        runItem(item);
+        mLock.lock();
+        mRunning = false;
+        mIdleCondition.broadcast();
+    }
+
+    return true;
+}
+
+} // namespace intel
+} // namespace android
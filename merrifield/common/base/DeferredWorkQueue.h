@@ -0,0 +1,89 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef DEFERRED_WORK_QUEUE_H
+#define DEFERRED_WORK_QUEUE_H
+
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <SimpleThread.h>
+
+namespace android {
+namespace intel {
+
+// housekeeping that can run after the frame has been flipped
+class DeferredWork {
+public:
+    DeferredWork() {}
+    virtual ~DeferredWork() {}
+public:
+    virtual void run() = 0;
+};
+
+// runs deferred work in the idle part of a vsync period, within a time
+// budget per period; work past its deadline runs even without vsync
+class DeferredWorkQueue {
+public:
+    DeferredWorkQueue();
+    virtual ~DeferredWorkQueue();
+
+public:
+    bool initialize();
+    void deinitialize();
+
+    // takes ownership of work, which runs within latency from now. work
+    // runs inline if the queue is not running
+    void queue(DeferredWork *work, nsecs_t latency = DEFAULT_LATENCY);
+    // runs all pending work in the calling thread
+    void flush();
+    void onVsync(int64_t timestamp);
+
+private:
+    struct WorkItem {
+        DeferredWork *work;
+        nsecs_t deadline;
+    };
+
+    enum {
+        // time allowed per vsync period
+        PERIOD_BUDGET = 2000000,
+        DEFAULT_LATENCY = 100000000,
+    };
+
+    // both called with mLock held
+    ssize_t findExpired(nsecs_t now) const;
+    nsecs_t getEarliestDeadline() const;
+    void runItem(const WorkItem& item);
+
+private:
+    Vector<WorkItem> mItems;
+    Mutex mLock;
+    Condition mCondition;
+    // signaled when the thread finishes an item
+    Condition mIdleCondition;
+    bool mVsyncPending;
+    bool mRunning;
+    bool mExitThread;
+    bool mInitialized;
+
+private:
+    DECLARE_THREAD(DeferredWorkThread, DeferredWorkQueue);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* DEFERRED_WORK_QUEUE_H */
@@ -22,6 +22,7 @@
 #include <Hwcomposer.h>
 #include <DisplayAnalyzer.h>
 #include <cutils/properties.h>
+#include <sync/sync.h>
 #include <GraphicBuffer.h>
 #include <ExternalDevice.h>
 #include <VirtualDevice.h>
@@ -37,14 +38,22 @@ DisplayAnalyzer::DisplayAnalyzer()
       mBlankDevice(false),
       mOverlayAllowed(true),
       mActiveInputState(true),
-      mIgnoreVideoSkipFlag(false),
+      mIgnoreVideoSkipFlags(),
       mProtectedVideoSession(false),
+      mCloneModeEnabled(false),
+      mCloneModeActive(false),
       mCachedNumDisplays(0),
       mCachedDisplays(0),
       mPendingEvents(),
       mEventMutex(),
-      mEventHandledCondition()
+      mEventHandledCondition(),
+      mDpmsDeadline(0),
+      mVideoCheckDeadline(0),
+      mDeadlineLock(),
+      mDeadlineCondition(),
+      mExitThread(false)
 {
+    memset(&mSavedExternalTarget, 0, sizeof(mSavedExternalTarget));
 }
 
 DisplayAnalyzer::~DisplayAnalyzer()
@@ -58,17 +67,31 @@ bool DisplayAnalyzer::initialize()
     if (property_get("hwc.video.extmode.enable", prop, "1") > 0) {
         mVideoExtModeEnabled = atoi(prop) ? true : false;
     }
+    // clone mode is disabled by default
+    if (property_get("hwc.hdmi.clone.enable", prop, "0") > 0) {
+        mCloneModeEnabled = atoi(prop) ? true : false;
+    }
+    mCloneModeActive = false;
     mVideoExtModeEligible = false;
     mVideoExtModeActive = false;
     mBlankDevice = false;
     mOverlayAllowed = true;
     mActiveInputState = true;
-    mIgnoreVideoSkipFlag = false;
+    mIgnoreVideoSkipFlags.clear();
     mProtectedVideoSession = false;
     mCachedNumDisplays = 0;
     mCachedDisplays = 0;
     mPendingEvents.clear();
     mVideoStateMap.clear();
+    mDpmsDeadline = 0;
+    mVideoCheckDeadline = 0;
+    mExitThread = false;
+    mThread = new DeadlineThread(this);
+    if (!mThread.get()) {
+        ETRACE("failed to create deadline thread");
+        return false;
+    }
+    mThread->run("DisplayAnalyzer", PRIORITY_URGENT_DISPLAY);
     mInitialized = true;
 
     return true;
@@ -76,6 +99,17 @@ bool DisplayAnalyzer::initialize()
 
 void DisplayAnalyzer::deinitialize()
 {
+    {
+        Mutex::Autolock _l(mDeadlineLock);
+        mExitThread = true;
+        mDpmsDeadline = 0;
+        mVideoCheckDeadline = 0;
+        mDeadlineCondition.signal();
+    }
+    if (mThread.get()) {
+        mThread->requestExitAndWait();
+        mThread = NULL;
+    }
     mPendingEvents.clear();
     mVideoStateMap.clear();
     mInitialized = false;
@@ -94,6 +128,10 @@ void DisplayAnalyzer::analyzeContents(
         handleVideoExtMode();
     }
 
+    if (mCloneModeEnabled || mCloneModeActive) {
+        handleCloneMode();
+    }
+
     if (mBlankDevice) {
         // this will make sure device is blanked after geometry changes.
         // blank event is only processed once
@@ -126,7 +164,7 @@ void DisplayAnalyzer::handleVideoExtMode()
 
 void DisplayAnalyzer::checkVideoExtMode()
 {
-    if (mVideoStateMap.size() != 1) {
+    if (mVideoStateMap.size() == 0) {
         mVideoExtModeEligible = false;
         return;
     }
@@ -178,54 +216,328 @@ void DisplayAnalyzer::checkVideoExtMode()
         return;
     }
 
-    buffer_handle_t videoHandle = 0;
-    bool videoLayerExist = false;
-    bool videoFullScreenOnPrimary = false;
-    bool isVideoLayerSkipped = false;
+    // every video session is checked on its own. Primary device can only be
+    // turned off if all video layers are also shown on a secondary device and
+    // at least one of them is eligible for extended mode.
+    bool eligible = false;
+    int videoLayers = 0;
 
     // exclude the frame buffer target layer
     for (int j = 0; j < (int)content->numHwLayers - 1; j++) {
-        videoLayerExist = isVideoLayer(content->hwLayers[j]);
-        if (videoLayerExist) {
-            if ((content->hwLayers[j].flags & HWC_SKIP_LAYER)) {
-                isVideoLayerSkipped = true;
-            }
-            videoHandle = content->hwLayers[j].handle;
-            videoFullScreenOnPrimary = isVideoFullScreen(0, content->hwLayers[j]);
-            break;
+        if (!isVideoLayer(content->hwLayers[j])) {
+            continue;
         }
+        videoLayers++;
+
+        bool sessionEligible = false;
+        if (!checkVideoSession(content->hwLayers[j], &sessionEligible)) {
+            VTRACE("video layer %d is on the primary device only", j);
+            return;
+        }
+        eligible |= sessionEligible;
     }
 
-    if (videoLayerExist == false) {
+    if (videoLayers == 0) {
         // no video layer is found in the primary layer
         return;
     }
 
+    VTRACE("%d video layers, %zu sessions, eligible %d",
+            videoLayers, mVideoStateMap.size(), eligible);
+    mVideoExtModeEligible = eligible;
+}
+
+bool DisplayAnalyzer::checkVideoSession(hwc_layer_1_t &layer, bool *eligible)
+{
+    bool isVideoLayerSkipped = layer.flags & HWC_SKIP_LAYER;
+    bool videoFullScreenOnPrimary = isVideoFullScreen(0, layer);
+
+    *eligible = false;
+
     // check whether video layer exists in external device or virtual device
     // TODO: video may exist in virtual device but no in external device or vice versa
-    // TODO: multiple video layers are not addressed here
     for (int i = 1; i < (int)mCachedNumDisplays; i++) {
-        content = mCachedDisplays[i];
+        hwc_display_contents_1_t *content = mCachedDisplays[i];
         if (content == NULL) {
             continue;
         }
 
         // exclude the frame buffer target layer
         for (int j = 0; j < (int)content->numHwLayers - 1; j++) {
-            if (content->hwLayers[j].handle == videoHandle) {
+            if (content->hwLayers[j].handle == layer.handle) {
                 isVideoLayerSkipped |= (content->hwLayers[j].flags & HWC_SKIP_LAYER);
                 VTRACE("video layer exists in device %d", i);
                 if (isVideoLayerSkipped || videoFullScreenOnPrimary){
                     VTRACE("Video ext mode eligible, %d, %d",
                             isVideoLayerSkipped, videoFullScreenOnPrimary);
-                    mVideoExtModeEligible = true;
+                    *eligible = true;
                 } else {
-                    mVideoExtModeEligible = isVideoFullScreen(i, content->hwLayers[j]);
+                    *eligible = isVideoFullScreen(i, content->hwLayers[j]);
                 }
-                return;
+                return true;
             }
         }
     }
+    return false;
+}
+
+static inline bool isScaledFrame(const hwc_rect_t& src, const hwc_rect_t& dst,
+        float scale, float offsetX, float offsetY, int tolerance)
+{
+    return abs(dst.left - (int)(offsetX + src.left * scale)) <= tolerance &&
+           abs(dst.top - (int)(offsetY + src.top * scale)) <= tolerance &&
+           abs(dst.right - (int)(offsetX + src.right * scale)) <= tolerance &&
+           abs(dst.bottom - (int)(offsetY + src.bottom * scale)) <= tolerance;
+}
+
+void DisplayAnalyzer::handleCloneMode()
+{
+    bool eligible = checkCloneMode();
+    if (eligible != mCloneModeActive) {
+        if (eligible) {
+            enterCloneMode();
+        } else {
+            exitCloneMode();
+        }
+        return;
+    }
+
+    if (mCloneModeActive) {
+        // layers of the external device need to be marked every frame
+        setCompositionType(IDisplayDevice::DEVICE_EXTERNAL, HWC_OVERLAY, false);
+        cloneFrameBufferTarget(mCachedNumDisplays, mCachedDisplays);
+    }
+}
+
+bool DisplayAnalyzer::checkCloneMode()
+{
+    if (!mCloneModeEnabled || mVideoExtModeActive || mBlankDevice) {
+        return false;
+    }
+
+    if (mCachedNumDisplays <= IDisplayDevice::DEVICE_EXTERNAL) {
+        return false;
+    }
+
+    hwc_display_contents_1_t *primary = mCachedDisplays[IDisplayDevice::DEVICE_PRIMARY];
+    hwc_display_contents_1_t *external = mCachedDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+    if (!primary || !external ||
+        primary->numHwLayers < 2 ||
+        primary->numHwLayers != external->numHwLayers) {
+        return false;
+    }
+
+    Hwcomposer& hwc = Hwcomposer::getInstance();
+    IDisplayDevice *pDev = hwc.getDisplayDevice(IDisplayDevice::DEVICE_PRIMARY);
+    IDisplayDevice *eDev = hwc.getDisplayDevice(IDisplayDevice::DEVICE_EXTERNAL);
+    if (!pDev || !eDev || !eDev->isConnected()) {
+        return false;
+    }
+
+    int srcW = 0, srcH = 0, dstW = 0, dstH = 0;
+    if (!pDev->getDisplaySize(&srcW, &srcH) ||
+        !eDev->getDisplaySize(&dstW, &dstH) ||
+        srcW <= 0 || srcH <= 0) {
+        return false;
+    }
+
+    // panel fitter can only scale up
+    if (srcW > dstW || srcH > dstH) {
+        VTRACE("primary %dx%d is larger than external %dx%d", srcW, srcH, dstW, dstH);
+        return false;
+    }
+
+    // SurfaceFlinger centers the primary scene keeping its aspect ratio
+    float scale = (float)dstW / srcW;
+    if ((float)dstH / srcH < scale) {
+        scale = (float)dstH / srcH;
+    }
+    float offsetX = (dstW - srcW * scale) / 2;
+    float offsetY = (dstH - srcH * scale) / 2;
+
+    // exclude the frame buffer target layer
+    for (int i = 0; i < (int)primary->numHwLayers - 1; i++) {
+        hwc_layer_1_t &p = primary->hwLayers[i];
+        hwc_layer_1_t &e = external->hwLayers[i];
+
+        // background color would be lost when marking layers
+        if (p.compositionType == HWC_BACKGROUND ||
+            e.compositionType == HWC_BACKGROUND) {
+            return false;
+        }
+
+        if (p.handle != e.handle ||
+            p.transform != e.transform ||
+            p.blending != e.blending ||
+            p.planeAlpha != e.planeAlpha ||
+            ((p.flags | e.flags) & HWC_SKIP_LAYER)) {
+            return false;
+        }
+
+        // video is left to overlay and video extended mode
+        if (isVideoLayer(p) || isProtectedLayer(p)) {
+            return false;
+        }
+
+        if (!isScaledFrame(p.displayFrame, e.displayFrame,
+                scale, offsetX, offsetY, CLONE_FRAME_TOLERANCE)) {
+            VTRACE("layer %d is not a scaled copy", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DisplayAnalyzer::enterCloneMode()
+{
+    ITRACE("entering clone mode...");
+
+    hwc_display_contents_1_t *primary = mCachedDisplays[IDisplayDevice::DEVICE_PRIMARY];
+    hwc_display_contents_1_t *external = mCachedDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+
+    mSavedExternalTarget = external->hwLayers[external->numHwLayers - 1];
+    mCloneModeActive = true;
+
+    // primary device composes all UI layers to its frame buffer target
+    primary->flags |= HWC_GEOMETRY_CHANGED;
+    setCompositionType(IDisplayDevice::DEVICE_EXTERNAL, HWC_OVERLAY, true);
+    cloneFrameBufferTarget(mCachedNumDisplays, mCachedDisplays);
+}
+
+void DisplayAnalyzer::exitCloneMode()
+{
+    ITRACE("exiting clone mode...");
+
+    mCloneModeActive = false;
+    if (mCachedNumDisplays <= IDisplayDevice::DEVICE_EXTERNAL) {
+        return;
+    }
+
+    hwc_display_contents_1_t *primary = mCachedDisplays[IDisplayDevice::DEVICE_PRIMARY];
+    if (primary) {
+        primary->flags |= HWC_GEOMETRY_CHANGED;
+    }
+
+    hwc_display_contents_1_t *external = mCachedDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+    if (!external || external->numHwLayers == 0) {
+        return;
+    }
+
+    // SurfaceFlinger does not set frame buffer target geometry every frame
+    hwc_layer_1_t &target = external->hwLayers[external->numHwLayers - 1];
+    target.handle = mSavedExternalTarget.handle;
+    target.sourceCropf = mSavedExternalTarget.sourceCropf;
+    target.displayFrame = mSavedExternalTarget.displayFrame;
+    setCompositionType(IDisplayDevice::DEVICE_EXTERNAL, HWC_FRAMEBUFFER, true);
+}
+
+bool DisplayAnalyzer::isCloneModeActive()
+{
+    return mCloneModeActive;
+}
+
+void DisplayAnalyzer::disableCloneMode()
+{
+    if (!mCloneModeEnabled) {
+        return;
+    }
+
+    WTRACE("clone mode is disabled");
+    mCloneModeEnabled = false;
+    Hwcomposer::getInstance().invalidate();
+}
+
+void DisplayAnalyzer::cloneFrameBufferTarget(
+        size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    if (!mCloneModeActive || numDisplays <= IDisplayDevice::DEVICE_EXTERNAL) {
+        return;
+    }
+
+    hwc_display_contents_1_t *primary = displays[IDisplayDevice::DEVICE_PRIMARY];
+    hwc_display_contents_1_t *external = displays[IDisplayDevice::DEVICE_EXTERNAL];
+    if (!primary || !external ||
+        primary->numHwLayers == 0 || external->numHwLayers == 0) {
+        return;
+    }
+
+    // external device scans out the primary frame buffer target unscaled,
+    // panel fitter of the external pipe takes care of the display size
+    hwc_layer_1_t &source = primary->hwLayers[primary->numHwLayers - 1];
+    hwc_layer_1_t &target = external->hwLayers[external->numHwLayers - 1];
+    target.handle = source.handle;
+    target.sourceCropf = source.sourceCropf;
+    target.displayFrame = source.displayFrame;
+}
+
+void DisplayAnalyzer::cloneAcquireFence(
+        size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    if (!mCloneModeActive || numDisplays <= IDisplayDevice::DEVICE_EXTERNAL) {
+        return;
+    }
+
+    hwc_display_contents_1_t *primary = displays[IDisplayDevice::DEVICE_PRIMARY];
+    hwc_display_contents_1_t *external = displays[IDisplayDevice::DEVICE_EXTERNAL];
+    if (!primary || !external ||
+        primary->numHwLayers == 0 || external->numHwLayers == 0) {
+        return;
+    }
+
+    shareAcquireFence(primary->hwLayers[primary->numHwLayers - 1],
+                      external->hwLayers[external->numHwLayers - 1]);
+}
+
+void DisplayAnalyzer::shareAcquireFence(hwc_layer_1_t& source, hwc_layer_1_t& target)
+{
+    // external pipe must not scan out the buffer before GLES is done
+    if (target.acquireFenceFd != -1) {
+        close(target.acquireFenceFd);
+        target.acquireFenceFd = -1;
+    }
+    if (source.acquireFenceFd != -1) {
+        target.acquireFenceFd = dup(source.acquireFenceFd);
+    }
+}
+
+void DisplayAnalyzer::mergeCloneReleaseFence(
+        size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    if (!mCloneModeActive || numDisplays <= IDisplayDevice::DEVICE_EXTERNAL) {
+        return;
+    }
+
+    hwc_display_contents_1_t *primary = displays[IDisplayDevice::DEVICE_PRIMARY];
+    hwc_display_contents_1_t *external = displays[IDisplayDevice::DEVICE_EXTERNAL];
+    if (!primary || !external ||
+        primary->numHwLayers == 0 || external->numHwLayers == 0) {
+        return;
+    }
+
+    mergeReleaseFence(primary->hwLayers[primary->numHwLayers - 1],
+                      external->hwLayers[external->numHwLayers - 1]);
+}
+
+void DisplayAnalyzer::mergeReleaseFence(hwc_layer_1_t& source, hwc_layer_1_t& target)
+{
+    // the primary target is released once both pipes are done with it
+    if (target.releaseFenceFd == -1) {
+        return;
+    }
+
+    if (source.releaseFenceFd == -1) {
+        source.releaseFenceFd = dup(target.releaseFenceFd);
+        return;
+    }
+
+    int fence = sync_merge("hwc_clone", source.releaseFenceFd, target.releaseFenceFd);
+    if (fence < 0) {
+        ETRACE("failed to merge release fences, error = %d", fence);
+        return;
+    }
+    close(source.releaseFenceFd);
+    source.releaseFenceFd = fence;
 }
 
 bool DisplayAnalyzer::isVideoExtModeActive()
@@ -251,7 +563,7 @@ bool DisplayAnalyzer::isVideoLayer(hwc_layer_1_t &layer)
 {
     bool ret = false;
     BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
-    if (!layer.handle) {
+    if (!layer.handle || layer.compositionType == HWC_BACKGROUND) {
         return false;
     }
     DataBuffer *buffer = bm->lockDataBuffer(layer.handle);
@@ -418,15 +730,15 @@ void DisplayAnalyzer::handlePendingEvents()
     case INPUT_EVENT:
         handleInputEvent(e.bValue);
         break;
-    case DPMS_EVENT:
-        handleDpmsEvent(e.nValue);
-        break;
     case IDLE_ENTRY_EVENT:
         handleIdleEntryEvent(e.nValue);
         break;
     case IDLE_EXIT_EVENT:
         handleIdleExitEvent();
         break;
+    case DPMS_EVENT:
+        handleDpmsEvent();
+        break;
     case VIDEO_CHECK_EVENT:
         handleVideoCheckEvent();
         break;
@@ -437,7 +749,7 @@ void DisplayAnalyzer::handleHotplugEvent(bool connected)
 {
     Hwcomposer *hwc = &Hwcomposer::getInstance();
     if (connected) {
-        if (mVideoStateMap.size() == 1) {
+        if (mVideoStateMap.size() > 0) {
             // Some video apps wouldn't update video state again when plugin HDMI
             // and fail to reset refresh rate
             ExternalDevice *dev = NULL;
@@ -450,21 +762,16 @@ void DisplayAnalyzer::handleHotplugEvent(bool connected)
                 VTRACE("Timing of external device is fixed.");
                 return;
             }
-            VideoSourceInfo info;
-            int instanceID = mVideoStateMap.keyAt(0);
-            status_t err = hwc->getMultiDisplayObserver()->getVideoSourceInfo(
-                    instanceID, &info);
-            if (err == NO_ERROR) {
-                int hz = dev->getRefreshRate();
-                if (hz > 0 && info.frameRate > 0 && hz != info.frameRate) {
-                    ITRACE("Old Hz %d, new one %d", hz, info.frameRate);
-                    dev->setRefreshRate(info.frameRate);
-                } else
-                    WTRACE("Old Hz %d is invalid, %d", hz, info.frameRate);
-            }
+            int frameRate = getVideoFrameRate();
+            int hz = dev->getRefreshRate();
+            if (hz > 0 && frameRate > 0 && hz != frameRate) {
+                ITRACE("Old Hz %d, new one %d", hz, frameRate);
+                dev->setRefreshRate(frameRate);
+            } else
+                WTRACE("Old Hz %d is invalid, %d", hz, frameRate);
         }
     } else {
-        if (mVideoStateMap.size() == 1) {
+        if (mVideoStateMap.size() > 0) {
             // Reset input state if HDMI is plug out to
             // avoid entering extended mode immediately after HDMI is plug in
             mActiveInputState = true;
@@ -508,18 +815,28 @@ void DisplayAnalyzer::handleTimingEvent()
         return;
     }
 
-    int hz = 0;
-    if (mVideoStateMap.size() == 1) {
+    dev->setRefreshRate(getVideoFrameRate());
+}
+
+int DisplayAnalyzer::getVideoFrameRate()
+{
+    // refresh rate can only follow the video if all sessions agree on it
+    Hwcomposer *hwc = &Hwcomposer::getInstance();
+    int frameRate = 0;
+    for (size_t i = 0; i < mVideoStateMap.size(); i++) {
         VideoSourceInfo info;
-        int instanceID = mVideoStateMap.keyAt(0);
         status_t err = hwc->getMultiDisplayObserver()->getVideoSourceInfo(
-                instanceID, &info);
-        if (err == NO_ERROR) {
-            hz = info.frameRate;
+                mVideoStateMap.keyAt(i), &info);
+        if (err != NO_ERROR || info.frameRate <= 0) {
+            return 0;
+        }
+        if (frameRate > 0 && frameRate != info.frameRate) {
+            VTRACE("sessions have different frame rate %d, %d", frameRate, info.frameRate);
+            return 0;
         }
+        frameRate = info.frameRate;
     }
-
-    dev->setRefreshRate(hz);
+    return frameRate;
 }
 
 void DisplayAnalyzer::handleVideoEvent(int instanceID, int state)
@@ -567,12 +884,19 @@ void DisplayAnalyzer::handleVideoEvent(int instanceID, int state)
         mActiveInputState = true;
     }
 
+    // protected if any of the started sessions is protected
     mProtectedVideoSession = false;
-    if (state == VIDEO_PLAYBACK_STARTED) {
+    for (size_t i = 0; i < mVideoStateMap.size(); i++) {
+        if (mVideoStateMap.valueAt(i) != VIDEO_PLAYBACK_STARTED) {
+            continue;
+        }
         VideoSourceInfo info;
-        hwc->getMultiDisplayObserver()->getVideoSourceInfo(
-                getFirstVideoInstanceSessionID(), &info);
-        mProtectedVideoSession = info.isProtected;
+        status_t err = hwc->getMultiDisplayObserver()->getVideoSourceInfo(
+                mVideoStateMap.keyAt(i), &info);
+        if (err == NO_ERROR && info.isProtected) {
+            mProtectedVideoSession = true;
+            break;
+        }
     }
     // Setting timing immediately,
     // Don't posthone to next circle
@@ -629,22 +953,86 @@ void DisplayAnalyzer::handleInputEvent(bool active)
     }
 }
 
-void DisplayAnalyzer::handleDpmsEvent(int delayCount)
+void DisplayAnalyzer::scheduleDpmsOff()
 {
-    if (mActiveInputState || !mVideoExtModeEligible) {
-        ITRACE("aborting display power off in video extended mode");
-        return;
+    // Do not power off primary display immediately as flip is asynchronous,
+    // deadline thread posts the power off once the delay has passed
+    Mutex::Autolock _l(mDeadlineLock);
+    mDpmsDeadline = systemTime(SYSTEM_TIME_MONOTONIC) + ms2ns(DELAY_BEFORE_DPMS_OFF_MS);
+    mDeadlineCondition.signal();
+}
+
+void DisplayAnalyzer::scheduleVideoCheck(bool enable)
+{
+    Mutex::Autolock _l(mDeadlineLock);
+    mVideoCheckDeadline = 0;
+    if (enable) {
+        mVideoCheckDeadline = systemTime(SYSTEM_TIME_MONOTONIC) + ms2ns(VIDEO_CHECK_INTERVAL_MS);
     }
+    mDeadlineCondition.signal();
+}
 
-    if (delayCount < DELAY_BEFORE_DPMS_OFF) {
-        Event e;
+bool DisplayAnalyzer::threadLoop()
+{
+    // analyzer state is owned by the prepare thread, this thread only
+    // posts events back to it when a deadline expires
+    bool dpms = false;
+    bool videoCheck = false;
+    {
+        Mutex::Autolock _l(mDeadlineLock);
+        while (!mExitThread && mDpmsDeadline == 0 && mVideoCheckDeadline == 0) {
+            mDeadlineCondition.wait(mDeadlineLock);
+        }
+        if (mExitThread) {
+            ITRACE("exiting thread loop");
+            return false;
+        }
+
+        nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        nsecs_t next = 0;
+        if (mDpmsDeadline && now >= mDpmsDeadline) {
+            mDpmsDeadline = 0;
+            dpms = true;
+        } else if (mDpmsDeadline) {
+            next = mDpmsDeadline;
+        }
+        if (mVideoCheckDeadline && now >= mVideoCheckDeadline) {
+            mVideoCheckDeadline = 0;
+            videoCheck = true;
+        } else if (mVideoCheckDeadline &&
+                   (next == 0 || mVideoCheckDeadline < next)) {
+            next = mVideoCheckDeadline;
+        }
+
+        if (!dpms && !videoCheck) {
+            mDeadlineCondition.waitRelative(mDeadlineLock, next - now);
+            return true;
+        }
+    }
+
+    Event e;
+    if (videoCheck) {
+        // video keeps composition going, no invalidate is needed
+        e.type = VIDEO_CHECK_EVENT;
+        postEvent(e);
+    }
+    if (dpms) {
         e.type = DPMS_EVENT;
-        e.nValue = delayCount + 1;
         postEvent(e);
         Hwcomposer::getInstance().invalidate();
+    }
+    return true;
+}
+
+void DisplayAnalyzer::handleDpmsEvent()
+{
+    if (mActiveInputState || !mVideoExtModeEligible || !mVideoExtModeActive) {
+        ITRACE("aborting display power off in video extended mode");
         return;
     }
 
+    DTRACE("powering off primary display");
+
     if (Hwcomposer::getInstance().getVsyncManager()->getVsyncSource() ==
         IDisplayDevice::DEVICE_PRIMARY) {
             Hwcomposer::getInstance().getDrm()->setDpmsMode(
@@ -705,47 +1093,58 @@ void DisplayAnalyzer::handleIdleExitEvent()
 
 void DisplayAnalyzer::handleVideoCheckEvent()
 {
-    // check if the first seen video layer on secondary device (HDMI/WFD) is marked as skipped
-    // it is assumed video is always skipped if the first seen video layer is skipped
+    // check if the video layer first seen on secondary device (HDMI/WFD) is marked as skipped
+    // it is assumed video is always skipped if the first seen video layer is skipped.
+    // every video session is checked on its own, the k-th video layer on the
+    // secondary device is taken as the k-th session.
     // this is to workaround secure video layer transmitted over non secure output
     // and HWC_SKIP_LAYER set during rotation animation.
-    mIgnoreVideoSkipFlag = false;
+    mIgnoreVideoSkipFlags.clear();
+    scheduleVideoCheck(false);
 
-    if (mVideoStateMap.size() != 1 ||
+    if (mVideoStateMap.size() == 0 ||
         mCachedNumDisplays <= 1) {
         return;
     }
 
-    intptr_t videoHandles[mCachedNumDisplays];
+    bool onPrimary = false;
     for (int i = 0; i < (int)mCachedNumDisplays; i++) {
-        videoHandles[i] = 0;
         hwc_display_contents_1_t *content = mCachedDisplays[i];
         if (content == NULL) {
             continue;
         }
+        Vector<bool> flags;
         for (int j = 0; j < (int)content->numHwLayers - 1; j++) {
-            if (isVideoLayer(content->hwLayers[j])) {
-                videoHandles[i] = (intptr_t)content->hwLayers[j].handle;
-                if (i > 0) {
-                    mIgnoreVideoSkipFlag = !(content->hwLayers[j].flags & HWC_SKIP_LAYER);
-                    ITRACE("Ignoring video HWC_SKIP_LAYER: %d on output %d", mIgnoreVideoSkipFlag, i);
-                    return;
-                }
+            if (!isVideoLayer(content->hwLayers[j])) {
+                continue;
+            }
+            if (i == 0) {
+                onPrimary = true;
                 break;
             }
+            flags.push_back(!(content->hwLayers[j].flags & HWC_SKIP_LAYER));
+        }
+        if (i > 0 && flags.size()) {
+            mIgnoreVideoSkipFlags = flags;
+            ITRACE_LIMITED("%zu of %zu video sessions found on output %d",
+                    flags.size(), mVideoStateMap.size(), i);
+            if (flags.size() < mVideoStateMap.size()) {
+                // sessions still to show up are checked once they do
+                scheduleVideoCheck(true);
+            }
+            return;
         }
     }
 
-    if (videoHandles[0]) {
-        WTRACE("Video is on the primary panel only");
+    if (onPrimary) {
+        WTRACE_LIMITED("Video is on the primary panel only");
         return;
     }
 
     // video state map indicates video session is active and there is secondary
-    // display, need to continue checking as video is not found in the buffers yet
-    Event e;
-    e.type = VIDEO_CHECK_EVENT;
-    postEvent(e);
+    // display, need to continue checking as video is not found in the buffers yet.
+    // the deadline thread posts the next check after an interval.
+    scheduleVideoCheck(true);
 }
 
 void DisplayAnalyzer::enterVideoExtMode()
@@ -761,12 +1160,7 @@ void DisplayAnalyzer::enterVideoExtMode()
 
     setCompositionType(0, HWC_OVERLAY, true);
 
-    // Do not power off primary display immediately as flip is asynchronous
-    Event e;
-    e.type = DPMS_EVENT;
-    e.nValue = 0;
-    postEvent(e);
-    Hwcomposer::getInstance().invalidate();
+    scheduleDpmsOff();
 }
 
 void DisplayAnalyzer::exitVideoExtMode()
@@ -778,6 +1172,11 @@ void DisplayAnalyzer::exitVideoExtMode()
 
     ITRACE("exiting video extended mode...");
 
+    {
+        // a power off already posted is dropped as extended mode is inactive
+        Mutex::Autolock _l(mDeadlineLock);
+        mDpmsDeadline = 0;
+    }
     mVideoExtModeActive = false;
 
     Hwcomposer::getInstance().getDrm()->setDpmsMode(
@@ -842,7 +1241,7 @@ bool DisplayAnalyzer::hasProtectedLayer()
 
 bool DisplayAnalyzer::isProtectedLayer(hwc_layer_1_t &layer)
 {
-    if (!layer.handle) {
+    if (!layer.handle || layer.compositionType == HWC_BACKGROUND) {
         return false;
     }
     bool ret = false;
@@ -857,9 +1256,32 @@ bool DisplayAnalyzer::isProtectedLayer(hwc_layer_1_t &layer)
     return ret;
 }
 
-bool DisplayAnalyzer::ignoreVideoSkipFlag()
+bool DisplayAnalyzer::ignoreVideoSkipFlag(hwc_layer_1_t &layer)
 {
-    return mIgnoreVideoSkipFlag;
+    if (mIgnoreVideoSkipFlags.size() == 0 || mCachedDisplays == NULL) {
+        return false;
+    }
+
+    // the session of a video layer is its position among the video layers
+    // of its device
+    for (int i = 1; i < (int)mCachedNumDisplays; i++) {
+        hwc_display_contents_1_t *content = mCachedDisplays[i];
+        if (content == NULL ||
+            &layer < content->hwLayers ||
+            &layer >= content->hwLayers + content->numHwLayers) {
+            continue;
+        }
+
+        size_t session = 0;
+        for (hwc_layer_1_t *l = content->hwLayers; l != &layer; l++) {
+            if (isVideoLayer(*l)) {
+                session++;
+            }
+        }
+        return session < mIgnoreVideoSkipFlags.size() &&
+               mIgnoreVideoSkipFlags[session];
+    }
+    return false;
 }
 
 void DisplayAnalyzer::setCompositionType(hwc_display_contents_1_t *display, int type)
@@ -18,6 +18,7 @@
 
 #include <utils/threads.h>
 #include <utils/Vector.h>
+#include <SimpleThread.h>
 
 
 namespace android {
@@ -47,8 +48,17 @@ public:
     void postIdleEntryEvent();
     bool isPresentationLayer(hwc_layer_1_t &layer);
     bool isProtectedLayer(hwc_layer_1_t &layer);
-    bool ignoreVideoSkipFlag();
+    bool ignoreVideoSkipFlag(hwc_layer_1_t &layer);
     int  getFirstVideoInstanceSessionID();
+    bool isCloneModeActive();
+    void disableCloneMode();
+    void cloneFrameBufferTarget(size_t numDisplays, hwc_display_contents_1_t** displays);
+    // fences of the cloned target, valid only at commit
+    void cloneAcquireFence(size_t numDisplays, hwc_display_contents_1_t** displays);
+    void mergeCloneReleaseFence(size_t numDisplays, hwc_display_contents_1_t** displays);
+    // fence handling between the primary target and its clone
+    static void shareAcquireFence(hwc_layer_1_t& source, hwc_layer_1_t& target);
+    static void mergeReleaseFence(hwc_layer_1_t& source, hwc_layer_1_t& target);
 
 private:
     enum DisplayEventType {
@@ -85,7 +95,7 @@ private:
     void handleVideoEvent(int instanceID, int state);
     void handleTimingEvent();
     void handleInputEvent(bool active);
-    void handleDpmsEvent(int delayCount);
+    void handleDpmsEvent();
     void handleIdleEntryEvent(int count);
     void handleIdleExitEvent();
     void handleVideoCheckEvent();
@@ -93,11 +103,19 @@ private:
     void blankSecondaryDevice();
     void handleVideoExtMode();
     void checkVideoExtMode();
+    bool checkVideoSession(hwc_layer_1_t &layer, bool *eligible);
+    int  getVideoFrameRate();
     void enterVideoExtMode();
     void exitVideoExtMode();
     bool hasProtectedLayer();
+    void handleCloneMode();
+    bool checkCloneMode();
+    void enterCloneMode();
+    void exitCloneMode();
     inline void setCompositionType(hwc_display_contents_1_t *content, int type);
     inline void setCompositionType(int device, int type, bool reset);
+    void scheduleDpmsOff();
+    void scheduleVideoCheck(bool enable);
 
 private:
     // Video playback state, must match defintion in Multi Display Service
@@ -112,8 +130,12 @@ private:
 
     enum
     {
-        // number of flips before display can be powered off in video extended mode
-        DELAY_BEFORE_DPMS_OFF = 0,
+        // delay before display can be powered off in video extended mode
+        DELAY_BEFORE_DPMS_OFF_MS = 34,
+        // interval between checks for video layer on secondary device
+        VIDEO_CHECK_INTERVAL_MS = 100,
+        // pixels a cloned layer may be off due to rounding in SurfaceFlinger
+        CLONE_FRAME_TOLERANCE = 2,
     };
 
 private:
@@ -125,9 +147,16 @@ private:
     bool mOverlayAllowed;
     bool mActiveInputState;
     // workaround HWC_SKIP_LAYER set during rotation for extended video mode
-    // by default if layer has HWC_SKIP_LAYER flag it should not be processed by HWC
-    bool mIgnoreVideoSkipFlag;
+    // by default if layer has HWC_SKIP_LAYER flag it should not be processed by HWC.
+    // one entry per video session, in z order of the video layers on the
+    // secondary device
+    Vector<bool> mIgnoreVideoSkipFlags;
     bool mProtectedVideoSession;
+    // external device scans out the frame buffer target of the primary device
+    bool mCloneModeEnabled;
+    bool mCloneModeActive;
+    // frame buffer target of the external device before cloning started
+    hwc_layer_1_t mSavedExternalTarget;
     // map video instance ID to video state
     KeyedVector<int, int> mVideoStateMap;
     int mCachedNumDisplays;
@@ -135,6 +164,17 @@ private:
     Vector<Event> mPendingEvents;
     Mutex mEventMutex;
     Condition mEventHandledCondition;
+    // deferred work is driven by monotonic deadlines, 0 if not armed.
+    // deadlines are guarded by mDeadlineLock, the rest of the analyzer
+    // state is only touched on the prepare thread
+    nsecs_t mDpmsDeadline;
+    nsecs_t mVideoCheckDeadline;
+    Mutex mDeadlineLock;
+    Condition mDeadlineCondition;
+    bool mExitThread;
+
+private:
+    DECLARE_THREAD(DeadlineThread, DisplayAnalyzer);
 };
 
 } // namespace intel
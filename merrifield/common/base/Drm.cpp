@@ -682,6 +682,95 @@ int Drm::getPanelOrientation(int device)
     return output->panelOrientation;
 }
 
+bool Drm::setPipeSource(int device, int width, int height, bool keepAspect)
+{
+    Mutex::Autolock _l(mLock);
+
+    int outputIndex = getOutputIndex(device);
+    if (outputIndex < 0) {
+        return false;
+    }
+
+    DrmOutput *output = &mOutputs[outputIndex];
+    if (output->connected == false) {
+        ETRACE("device is not connected");
+        return false;
+    }
+
+    int hdisplay = output->mode.hdisplay;
+    int vdisplay = output->mode.vdisplay;
+    if (width <= 0 || height <= 0) {
+        width = hdisplay;
+        height = vdisplay;
+    }
+
+    if (width > hdisplay || height > vdisplay) {
+        ETRACE("source %dx%d exceeds mode %dx%d", width, height, hdisplay, vdisplay);
+        return false;
+    }
+
+    struct drm_psb_register_rw_arg arg;
+    memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
+
+    uint32_t pipeSrc = ((width - 1) << 16) | (height - 1);
+    if (outputIndex == OUTPUT_EXTERNAL) {
+        arg.display_write_mask = REGRWBITS_PIPEBSRC;
+        arg.display.pipebsrc = pipeSrc;
+    } else {
+        arg.display_write_mask = REGRWBITS_PIPEASRC;
+        arg.display.pipeasrc = pipeSrc;
+    }
+
+    // auto scaling stretches the source to the full mode, letter and
+    // pillar box keep its aspect ratio with black bars filling the rest
+    if (width != hdisplay || height != vdisplay) {
+        uint32_t scaling = PFIT_SCALING_AUTO;
+        if (keepAspect && width * vdisplay > height * hdisplay) {
+            scaling = PFIT_SCALING_LETTER;
+        } else if (keepAspect && width * vdisplay < height * hdisplay) {
+            scaling = PFIT_SCALING_PILLAR;
+        }
+        arg.display.pfit_controls = PFIT_ENABLE |
+            (outputIndex << PFIT_PIPE_SHIFT) | scaling;
+    }
+    arg.display_write_mask |= REGRWBITS_PFIT_CONTROLS;
+
+    ITRACE("pipe source of device %d is %dx%d, mode %dx%d",
+           device, width, height, hdisplay, vdisplay);
+    return writeReadIoctl(DRM_PSB_REGISTER_RW, &arg, sizeof(arg));
+}
+
+bool Drm::checkPipeUnderrun(int device)
+{
+    Mutex::Autolock _l(mLock);
+
+    // register access exposes the status of pipe A only
+    int outputIndex = getOutputIndex(device);
+    if (outputIndex != OUTPUT_PRIMARY) {
+        return false;
+    }
+
+    struct drm_psb_register_rw_arg arg;
+    memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
+    arg.display_read_mask = REGRWBITS_PIPEASTAT;
+    if (!writeReadIoctl(DRM_PSB_REGISTER_RW, &arg, sizeof(arg))) {
+        return false;
+    }
+
+    uint32_t status = arg.display.pipestat_a;
+    if (!(status & PIPESTAT_FIFO_UNDERRUN)) {
+        return false;
+    }
+
+    // the underrun bit is sticky until written with 1. Enable bits are
+    // written back unchanged and other status bits with 0 to keep them
+    memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
+    arg.display_write_mask = REGRWBITS_PIPEASTAT;
+    arg.display.pipestat_a = status & (PIPESTAT_FIFO_UNDERRUN | PIPESTAT_ENABLE_MASK);
+    writeReadIoctl(DRM_PSB_REGISTER_RW, &arg, sizeof(arg));
+    return true;
+}
+
 // HWC 1.4 requires that we return all of the compatible configs in getDisplayConfigs
 // this is needed so getActiveConfig/setActiveConfig work correctly.  It is up to the
 // user space to decide what speed to send.
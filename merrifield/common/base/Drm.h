@@ -60,6 +60,12 @@ public:
     bool isSameDrmMode(drmModeModeInfoPtr mode, drmModeModeInfoPtr base) const;
     int getPanelOrientation(int device);
     drmModeModeInfoPtr detectAllConfigs(int device, int *modeCount);
+    // scale a source of the given size to the current mode through the
+    // panel fitter, 0 width or height restores the native pipe source
+    bool setPipeSource(int device, int width, int height, bool keepAspect = true);
+    // returns true if the pipe underran since the last check, only the
+    // status of the primary pipe is readable
+    bool checkPipeUnderrun(int device);
 
 private:
     bool initDrmMode(int index);
@@ -70,6 +76,21 @@ private:
     inline int getOutputIndex(int device);
 
 private:
+    // panel fitter control
+    enum {
+        PFIT_ENABLE = 0x80000000,
+        PFIT_PIPE_SHIFT = 29,
+        PFIT_SCALING_AUTO = 0 << 26,
+        PFIT_SCALING_PILLAR = 2 << 26,
+        PFIT_SCALING_LETTER = 3 << 26,
+    };
+
+    // pipe status
+    enum {
+        PIPESTAT_FIFO_UNDERRUN = 0x80000000,
+        PIPESTAT_ENABLE_MASK = 0x7fff0000,
+    };
+
     // DRM object index
     enum {
         OUTPUT_PRIMARY = 0,
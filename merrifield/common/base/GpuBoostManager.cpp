@@ -0,0 +1,134 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/properties.h>
+#include <HwcTrace.h>
+#include <GpuBoostManager.h>
+
+namespace android {
+namespace intel {
+
+GpuBoostManager::GpuBoostManager(IGpuBoostControl *control)
+    : mControl(control),
+      mEnabled(false),
+      mBoosted(false),
+      mThreshold(BOOST_THRESHOLD),
+      mFrameWork(0),
+      mLowFrames(0),
+      mInitialized(false)
+{
+    memset(mWork, 0, sizeof(mWork));
+}
+
+GpuBoostManager::~GpuBoostManager()
+{
+    WARN_IF_NOT_DEINIT();
+}
+
+bool GpuBoostManager::initialize()
+{
+    char prop[PROPERTY_VALUE_MAX];
+
+    if (!mControl || !mControl->initialize()) {
+        DEINIT_AND_RETURN_FALSE("failed to initialize GPU boost control");
+    }
+
+    mEnabled = true;
+    if (property_get("hwc.gpu.boost.enable", prop, "1") > 0) {
+        mEnabled = atoi(prop) ? true : false;
+    }
+
+    if (property_get("hwc.gpu.boost.threshold", prop, NULL) > 0 &&
+        atoi(prop) > 0) {
+        mThreshold = atoi(prop);
+    }
+
+    mInitialized = true;
+    return true;
+}
+
+void GpuBoostManager::deinitialize()
+{
+    if (mControl) {
+        if (mBoosted) {
+            mControl->boost(false);
+        }
+        mControl->deinitialize();
+        delete mControl;
+        mControl = NULL;
+    }
+    mBoosted = false;
+    mInitialized = false;
+}
+
+void GpuBoostManager::beginFrame()
+{
+    // a display that skips prepare contributes no GLES work
+    memset(mWork, 0, sizeof(mWork));
+}
+
+void GpuBoostManager::addWork(int disp, uint32_t work)
+{
+    if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
+        return;
+    }
+    mWork[disp] = work;
+}
+
+void GpuBoostManager::endFrame()
+{
+    if (!mInitialized || !mEnabled) {
+        return;
+    }
+
+    mFrameWork = 0;
+    for (int i = 0; i < IDisplayDevice::DEVICE_COUNT; i++) {
+        mFrameWork += mWork[i];
+    }
+
+    if (!mBoosted) {
+        // boost right away, the governor reacts only after missed frames
+        if (mFrameWork >= mThreshold) {
+            DTRACE("boosting GPU, GLES work %d%%", mFrameWork);
+            mControl->boost(true);
+            mBoosted = true;
+            mLowFrames = 0;
+        }
+        return;
+    }
+
+    if (mFrameWork * 100 >= mThreshold * (100 - RELEASE_MARGIN)) {
+        mLowFrames = 0;
+        return;
+    }
+
+    if (++mLowFrames >= RELEASE_FRAMES) {
+        DTRACE("releasing GPU boost, GLES work %d%%", mFrameWork);
+        mControl->boost(false);
+        mBoosted = false;
+        mLowFrames = 0;
+    }
+}
+
+void GpuBoostManager::dump(Dump& d)
+{
+    d.append("GPU boost: %s, GLES work %d%%, threshold %d%%\n",
+             mBoosted ? "on" : "off", mFrameWork, mThreshold);
+}
+
+} // namespace intel
+} // namespace android
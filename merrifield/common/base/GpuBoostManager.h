@@ -0,0 +1,68 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef GPU_BOOST_MANAGER_H
+#define GPU_BOOST_MANAGER_H
+
+#include <Dump.h>
+#include <IDisplayDevice.h>
+#include <IGpuBoostControl.h>
+
+namespace android {
+namespace intel {
+
+// raises a GPU boost hint when the layers handed back to GLES exceed a
+// threshold and drops it after the load stays low for a while
+class GpuBoostManager {
+public:
+    GpuBoostManager(IGpuBoostControl *control);
+    virtual ~GpuBoostManager();
+
+public:
+    bool initialize();
+    void deinitialize();
+
+    // GLES work of a frame is the sum reported by all displays
+    void beginFrame();
+    void addWork(int disp, uint32_t work);
+    void endFrame();
+
+    bool isBoosted() const { return mBoosted; }
+    void dump(Dump& d);
+
+private:
+    enum {
+        // work is measured in percent of a full screen of fill
+        BOOST_THRESHOLD = 300,
+        // percentage below the threshold to start releasing
+        RELEASE_MARGIN = 30,
+        // frames the work has to stay low before releasing
+        RELEASE_FRAMES = 30,
+    };
+
+    IGpuBoostControl *mControl;
+    bool mEnabled;
+    bool mBoosted;
+    uint32_t mThreshold;
+    uint32_t mWork[IDisplayDevice::DEVICE_COUNT];
+    uint32_t mFrameWork;
+    int mLowFrames;
+    bool mInitialized;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* GPU_BOOST_MANAGER_H */
@@ -65,11 +65,17 @@ HwcLayer::HwcLayer(int index, hwc_layer_1_t *layer)
       mUsage(0),
       mHandle(0),
       mIsProtected(false),
+      mIsCompressed(false),
+      mIsScanoutCompressed(false),
+      mIsBlackBackground(false),
       mType(LAYER_FB),
       mPriority(0),
       mTransform(0),
       mStaticCount(0),
-      mUpdated(false)
+      mUpdated(false),
+      mFlags(0),
+      mBlending(HWC_BLENDING_NONE),
+      mPlaneAlpha(0xff)
 {
     memset(&mSourceCropf, 0, sizeof(mSourceCropf));
     memset(&mDisplayFrame, 0, sizeof(mDisplayFrame));
@@ -161,6 +167,12 @@ void HwcLayer::setType(uint32_t type)
     case LAYER_CURSOR_OVERLAY:
         mLayer->compositionType = HWC_CURSOR_OVERLAY;
         break;
+    case LAYER_BACKGROUND:
+        // pipe background is black, SF draws any other color with GLES
+        mIsBlackBackground = isBlackBackground(mLayer);
+        mLayer->compositionType =
+            mIsBlackBackground ? HWC_BACKGROUND : HWC_FRAMEBUFFER;
+        break;
     default:
         break;
     }
@@ -173,6 +185,12 @@ uint32_t HwcLayer::getType() const
     return mType;
 }
 
+bool HwcLayer::isBlackBackground(hwc_layer_1_t *layer)
+{
+    hwc_color_t& color = layer->backgroundColor;
+    return !color.r && !color.g && !color.b;
+}
+
 void HwcLayer::setCompositionType(int32_t type)
 {
     mLayer->compositionType = type;
@@ -233,6 +251,16 @@ bool HwcLayer::isProtected() const
     return mIsProtected;
 }
 
+bool HwcLayer::isCompressed() const
+{
+    return mIsCompressed;
+}
+
+bool HwcLayer::isScanoutCompressed() const
+{
+    return mIsScanoutCompressed;
+}
+
 hwc_layer_1_t* HwcLayer::getLayer() const
 {
     return mLayer;
@@ -257,6 +285,13 @@ bool HwcLayer::update(hwc_layer_1_t *layer)
 {
     // update layer
     mLayer = layer;
+
+    // SF marks the background layer on every prepare
+    if (mType == LAYER_BACKGROUND) {
+        setType(LAYER_BACKGROUND);
+        return true;
+    }
+
     setupAttributes();
 
 #ifdef HWC_TRACE_FPS
@@ -324,6 +359,73 @@ uint32_t HwcLayer::getStaticCount()
     return mStaticCount;
 }
 
+bool HwcLayer::hasSameGeometry(hwc_layer_1_t *layer)
+{
+    if (!layer) {
+        return false;
+    }
+
+    // background color shares storage with the buffer handle, and a
+    // color switching between black and GLES changes the plan
+    if (mType == LAYER_BACKGROUND) {
+        return layer->compositionType == HWC_BACKGROUND &&
+               isBlackBackground(layer) == mIsBlackBackground;
+    }
+
+    if (mTransform != layer->transform ||
+        mSourceCropf != layer->sourceCropf ||
+        mDisplayFrame != layer->displayFrame ||
+        mBlending != layer->blending ||
+        mPlaneAlpha != layer->planeAlpha ||
+        (mFlags & (HWC_SKIP_LAYER | HWC_IS_CURSOR_LAYER)) !=
+            (layer->flags & (HWC_SKIP_LAYER | HWC_IS_CURSOR_LAYER))) {
+        return false;
+    }
+
+    if (mHandle == layer->handle) {
+        return true;
+    }
+
+    // a new buffer of a GLES layer is composed whatever it is, and frame
+    // buffer targets all come in the frame buffer format
+    if (!mPlane || mType == LAYER_FRAMEBUFFER_TARGET) {
+        return true;
+    }
+
+    // buffer was not known when layer was set up, plane capabilities
+    // were not checked against it
+    if (mFormat == DataBuffer::FORMAT_INVALID || layer->handle == NULL) {
+        return false;
+    }
+
+    BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
+    DataBuffer *buffer = bm->lockDataBuffer(layer->handle);
+    if (!buffer) {
+        ETRACE("failed to get buffer");
+        return false;
+    }
+
+    bool same = (buffer->getFormat() == mFormat &&
+                 buffer->getWidth() == mWidth &&
+                 buffer->getHeight() == mHeight &&
+                 GraphicBuffer::isProtectedBuffer((GraphicBuffer*)buffer) == mIsProtected &&
+                 GraphicBuffer::isCompressionBuffer((GraphicBuffer*)buffer) == mIsCompressed);
+    bm->unlockDataBuffer(buffer);
+    return same;
+}
+
+void HwcLayer::suspend()
+{
+    // layer provided by surface flinger is not valid any more
+    mLayer = NULL;
+}
+
+void HwcLayer::resume(hwc_layer_1_t *layer)
+{
+    mLayer = layer;
+    setType(mType);
+}
+
 void HwcLayer::postFlip()
 {
     mUpdated = false;
@@ -344,13 +446,21 @@ void HwcLayer::postFlip()
 
 void HwcLayer::setupAttributes()
 {
+    // a background layer carries a color instead of a buffer
+    if (mLayer->compositionType == HWC_BACKGROUND) {
+        return;
+    }
+
     if ((mLayer->flags & HWC_SKIP_LAYER) ||
         mTransform != mLayer->transform ||
         mSourceCropf != mLayer->sourceCropf ||
         mDisplayFrame != mLayer->displayFrame ||
         mHandle != mLayer->handle ||
-        DisplayQuery::isVideoFormat(mFormat)) {
-        // TODO: same handle does not mean there is always no update
+        mBlending != mLayer->blending ||
+        mPlaneAlpha != mLayer->planeAlpha ||
+        (DisplayQuery::isVideoFormat(mFormat) &&
+         (!mPlane || mPlane->isContentUpdated()))) {
+        // same video handle is an update unless its payload is unchanged
         mUpdated = true;
         mStaticCount = 0;
     } else {
@@ -365,6 +475,9 @@ void HwcLayer::setupAttributes()
     mSourceCropf = mLayer->sourceCropf;
     mDisplayFrame = mLayer->displayFrame;
     mHandle = mLayer->handle;
+    mFlags = mLayer->flags;
+    mBlending = mLayer->blending;
+    mPlaneAlpha = mLayer->planeAlpha;
 
     if (mFormat != DataBuffer::FORMAT_INVALID) {
         // other attributes have been set.
@@ -396,6 +509,8 @@ void HwcLayer::setupAttributes()
         GraphicBuffer *gBuffer = (GraphicBuffer*)buffer;
         mUsage = gBuffer->getUsage();
         mIsProtected = GraphicBuffer::isProtectedBuffer((GraphicBuffer*)buffer);
+        mIsCompressed = GraphicBuffer::isCompressionBuffer((GraphicBuffer*)buffer);
+        mIsScanoutCompressed = GraphicBuffer::isScanoutCompressionBuffer((GraphicBuffer*)buffer);
         if (mIsProtected) {
             mPriority |= LAYER_PRIORITY_PROTECTED;
         } else if (PlaneCapabilities::isFormatSupported(DisplayPlane::PLANE_OVERLAY, this)) {
@@ -50,6 +50,9 @@ public:
         LAYER_SIDEBAND,
         // LAYER_CURSOR_OVERLAY layers support hardware cursor planes
         LAYER_CURSOR_OVERLAY,
+        // LAYER_BACKGROUND layers are marked as HWC_BACKGROUND and filled
+        // by the display pipe below all planes
+        LAYER_BACKGROUND,
     };
 
     enum {
@@ -80,6 +83,8 @@ public:
     buffer_handle_t getHandle() const;
     uint32_t getTransform() const;
     bool isProtected() const;
+    bool isCompressed() const;
+    bool isScanoutCompressed() const;
     hwc_layer_1_t* getLayer() const;
     DisplayPlane* getPlane() const;
 
@@ -91,12 +96,18 @@ public:
     bool isUpdated();
     uint32_t getStaticCount();
 
+    // suspend/restore support across display blank
+    bool hasSameGeometry(hwc_layer_1_t *layer);
+    void suspend();
+    void resume(hwc_layer_1_t *layer);
+
 public:
     // temporary solution for plane assignment
     bool mPlaneCandidate;
 
 private:
     void setupAttributes();
+    static bool isBlackBackground(hwc_layer_1_t *layer);
 
 private:
     const int mIndex;
@@ -111,6 +122,10 @@ private:
     uint32_t mUsage;
     buffer_handle_t mHandle;
     bool mIsProtected;
+    bool mIsCompressed;
+    bool mIsScanoutCompressed;
+    // background color is black and left to the pipe
+    bool mIsBlackBackground;
     uint32_t mType;
     uint32_t mPriority;
     uint32_t mTransform;
@@ -121,6 +136,11 @@ private:
     uint32_t mStaticCount;
     bool mUpdated;
 
+    // for validating a restored layer
+    uint32_t mFlags;
+    uint32_t mBlending;
+    uint8_t mPlaneAlpha;
+
 #ifdef HWC_TRACE_FPS
     // for frame per second trace
     bool mTraceFps;
@@ -25,7 +25,7 @@
 namespace android {
 namespace intel {
 
-HwcLayerList::HwcLayerList(hwc_display_contents_1_t *list, int disp)
+HwcLayerList::HwcLayerList(hwc_display_contents_1_t *list, int disp, bool animating)
     : mList(list),
       mLayerCount(0),
       mLayers(),
@@ -36,7 +36,10 @@ HwcLayerList::HwcLayerList(hwc_display_contents_1_t *list, int disp)
       mZOrderConfig(),
       mFrameBufferTarget(NULL),
       mDisplayIndex(disp),
-      mLayerSize(0)
+      mLayerSize(0),
+      mSuspended(false),
+      mAnimating(animating),
+      mCloneSource(false)
 {
     initialize();
 }
@@ -109,10 +112,69 @@ bool HwcLayerList::checkSupported(int planeType, HwcLayer *hwcLayer)
         return false;
     }
 
+    // check configurations learned to underrun the pipe
+    PlaneConfig config;
+    getPlaneConfig(planeType, hwcLayer, config);
+    if (Hwcomposer::getInstance().getPlaneManager()->isBlacklisted(config)) {
+        VTRACE("plane type %d: (blacklisted after underruns)", planeType);
+        return false;
+    }
+
     // TODO: check visible region?
     return true;
 }
 
+void HwcLayerList::getPlaneConfig(int planeType, HwcLayer *hwcLayer, PlaneConfig& config)
+{
+    hwc_frect_t& src = hwcLayer->getLayer()->sourceCropf;
+    hwc_rect_t& dest = hwcLayer->getLayer()->displayFrame;
+    int srcWidth = (int)src.right - (int)src.left;
+    int srcHeight = (int)src.bottom - (int)src.top;
+
+    // a plane fetches lines of the rotated source
+    uint32_t transform = hwcLayer->getTransform();
+    if (transform == HAL_TRANSFORM_ROT_90 || transform == HAL_TRANSFORM_ROT_270) {
+        int tmp = srcWidth;
+        srcWidth = srcHeight;
+        srcHeight = tmp;
+    }
+
+    config.planeType = planeType;
+    config.format = hwcLayer->getFormat();
+    config.width = srcWidth;
+    config.scale = UnderrunBlacklist::getScale(srcHeight, dest.bottom - dest.top);
+}
+
+void HwcLayerList::updateUnderrunCandidate()
+{
+    // the layer fetching most on an overlay or sprite plane goes to GLES
+    // if the pipe underruns with the plan just flipped
+    PlaneConfig candidate;
+    uint32_t maxBandwidth = 0;
+    for (size_t i = 0; i < mLayers.size(); i++) {
+        HwcLayer *hwcLayer = mLayers.itemAt(i);
+        DisplayPlane *plane = hwcLayer->getPlane();
+        if (!plane || hwcLayer->getType() != HwcLayer::LAYER_OVERLAY) {
+            continue;
+        }
+
+        int planeType = plane->getType();
+        if (planeType != DisplayPlane::PLANE_OVERLAY &&
+            planeType != DisplayPlane::PLANE_SPRITE) {
+            continue;
+        }
+
+        uint32_t bandwidth = plane->getFetchBandwidth();
+        if (candidate.planeType < 0 || bandwidth > maxBandwidth) {
+            getPlaneConfig(planeType, hwcLayer, candidate);
+            maxBandwidth = bandwidth;
+        }
+    }
+
+    DisplayPlaneManager *planeManager = Hwcomposer::getInstance().getPlaneManager();
+    planeManager->setUnderrunCandidate(mDisplayIndex, candidate);
+}
+
 bool HwcLayerList::checkCursorSupported(HwcLayer *hwcLayer)
 {
     hwc_layer_1_t& layer = *(hwcLayer->getLayer());
@@ -135,7 +197,7 @@ bool HwcLayerList::checkCursorSupported(HwcLayer *hwcLayer)
     }
 
     if (hwcLayer->getIndex() != mLayerCount - 2) {
-        WTRACE("cursor layer is not on top of zorder");
+        WTRACE_LIMITED("cursor layer is not on top of zorder");
         return false;
     }
 
@@ -153,13 +215,13 @@ bool HwcLayerList::checkCursorSupported(HwcLayer *hwcLayer)
     uint32_t format = hwcLayer->getFormat();
     if (format != HAL_PIXEL_FORMAT_BGRA_8888 &&
         format != HAL_PIXEL_FORMAT_RGBA_8888) {
-        WTRACE("unexpected color format %u for cursor", format);
+        WTRACE_LIMITED("unexpected color format %u for cursor", format);
         return false;
     }
 
     uint32_t trans = hwcLayer->getLayer()->transform;
     if (trans != 0) {
-        WTRACE("unexpected transform %u for cursor", trans);
+        WTRACE_LIMITED("unexpected transform %u for cursor", trans);
         return false;
     }
 
@@ -170,13 +232,13 @@ bool HwcLayerList::checkCursorSupported(HwcLayer *hwcLayer)
     int dstW = dest.right - dest.left;
     int dstH = dest.bottom - dest.top;
     if (srcW != dstW || srcH != dstH) {
-        WTRACE("unexpected scaling for cursor: %dx%d => %dx%d",
+        WTRACE_LIMITED("unexpected scaling for cursor: %dx%d => %dx%d",
         srcW, srcH, dstW, dstH);
         //return false;
     }
 
     if (srcW > 256 || srcH > 256) {
-        WTRACE("unexpected size %dx%d for cursor", srcW, srcH);
+        WTRACE_LIMITED("unexpected size %dx%d for cursor", srcW, srcH);
         return false;
     }
 
@@ -216,6 +278,13 @@ bool HwcLayerList::initialize()
     mZOrderConfig.setCapacity(mLayerCount);
     Hwcomposer& hwc = Hwcomposer::getInstance();
 
+    // in clone mode the primary frame buffer target carries every layer
+    // and is scanned out on the external device as well
+    bool cloned = hwc.getDisplayAnalyzer()->isCloneModeActive();
+    bool cloneSource = cloned && mDisplayIndex == IDisplayDevice::DEVICE_PRIMARY;
+    bool uiOnGles = mAnimating || cloneSource;
+    mCloneSource = cloneSource;
+
     for (int i = 0; i < mLayerCount; i++) {
         hwc_layer_1_t *layer = &mList->hwLayers[i];
         if (!layer) {
@@ -242,11 +311,15 @@ bool HwcLayerList::initialize()
             // by default use GPU composition
             hwcLayer->setType(HwcLayer::LAYER_FB);
             mFBLayers.add(hwcLayer);
-            if (checkCursorSupported(hwcLayer)) {
+            // UI layers stay in GLES while an animation is running,
+            // video may still go to overlay
+            if (!uiOnGles && checkCursorSupported(hwcLayer)) {
                 mCursorCandidates.add(hwcLayer);
-            } else if (checkSupported(DisplayPlane::PLANE_SPRITE, hwcLayer)) {
+            } else if (!uiOnGles &&
+                checkSupported(DisplayPlane::PLANE_SPRITE, hwcLayer)) {
                 mSpriteCandidates.add(hwcLayer);
-            } else if (hwc.getDisplayAnalyzer()->isOverlayAllowed() &&
+            } else if (!cloneSource &&
+                hwc.getDisplayAnalyzer()->isOverlayAllowed() &&
                 checkSupported(DisplayPlane::PLANE_OVERLAY, hwcLayer)) {
                 mOverlayCandidates.add(hwcLayer);
             } else {
@@ -254,6 +327,13 @@ bool HwcLayerList::initialize()
             }
         } else if (layer->compositionType == HWC_SIDEBAND){
             hwcLayer->setType(HwcLayer::LAYER_SIDEBAND);
+        } else if (layer->compositionType == HWC_BACKGROUND) {
+            // nothing to scan out, pipe background shows below all planes.
+            // a color other than black is turned into HWC_FRAMEBUFFER
+            hwcLayer->setType(HwcLayer::LAYER_BACKGROUND);
+            if (layer->compositionType == HWC_FRAMEBUFFER) {
+                mFBLayers.add(hwcLayer);
+            }
         } else {
             DEINIT_AND_RETURN_FALSE("invalid composition type %d", layer->compositionType);
         }
@@ -271,7 +351,8 @@ bool HwcLayerList::initialize()
     // layer; we need to have this FB_Target to be flipped as well, otherwise it
     // will have the buffer queue blocked. (The buffer hold by driver cannot be
     // released if new buffers' flip is skipped).
-    if ((mFBLayers.size() == 0) && (mLayers.size() > 1)) {
+    if ((mFBLayers.size() == 0) && (mLayers.size() > 1) &&
+        !(cloned && mDisplayIndex == IDisplayDevice::DEVICE_EXTERNAL)) {
         VTRACE("no FB layers, skip plane allocation");
         return true;
     }
@@ -635,6 +716,12 @@ bool HwcLayerList::useAsFrameBufferTarget(HwcLayer *target)
 
 bool HwcLayerList::hasIntersection(HwcLayer *la, HwcLayer *lb)
 {
+    // background layer has no frame and covers the whole display
+    if (la->getType() == HwcLayer::LAYER_BACKGROUND ||
+        lb->getType() == HwcLayer::LAYER_BACKGROUND) {
+        return true;
+    }
+
     hwc_layer_1_t *a = la->getLayer();
     hwc_layer_1_t *b = lb->getLayer();
     hwc_rect_t *aRect = &a->displayFrame;
@@ -735,6 +822,7 @@ void HwcLayerList::setupSmartComposition()
         switch (hwcLayer->getType()) {
         case HwcLayer::LAYER_FB:
         case HwcLayer::LAYER_FORCE_FB:
+        case HwcLayer::LAYER_BACKGROUND:
             hwcLayer->setCompositionType(compositionType);
             break;
         default:
@@ -959,7 +1047,8 @@ DisplayPlane* HwcLayerList::getPlane(uint32_t index) const
     hwcLayer = mLayers.itemAt(index);
     if ((hwcLayer->getType() == HwcLayer::LAYER_FB) ||
         (hwcLayer->getType() == HwcLayer::LAYER_FORCE_FB) ||
-        (hwcLayer->getType() == HwcLayer::LAYER_SKIPPED)) {
+        (hwcLayer->getType() == HwcLayer::LAYER_SKIPPED) ||
+        (hwcLayer->getType() == HwcLayer::LAYER_BACKGROUND)) {
         return 0;
     }
 
@@ -977,11 +1066,217 @@ void HwcLayerList::postFlip()
         HwcLayer *hwcLayer = mLayers.itemAt(i);
         hwcLayer->postFlip();
     }
+
+    updateUnderrunCandidate();
+}
+
+void HwcLayerList::suspend()
+{
+    if (mSuspended) {
+        return;
+    }
+
+    VTRACE("suspending layer list of device %d", mDisplayIndex);
+
+    // planes stay attached and keep their buffer mappings so the first
+    // frame after unblank flips without a new plan. layers provided by
+    // surface flinger are not valid any more
+    for (int i = 0; i < mLayerCount; i++) {
+        mLayers.itemAt(i)->suspend();
+    }
+
+    mList = NULL;
+    mSuspended = true;
+}
+
+bool HwcLayerList::restore(hwc_display_contents_1_t *list)
+{
+    if (!mSuspended || !list) {
+        return false;
+    }
+
+    if ((int)list->numHwLayers != mLayerCount) {
+        DTRACE("layer count changed during suspension");
+        return false;
+    }
+
+    Hwcomposer& hwc = Hwcomposer::getInstance();
+    bool cloned = hwc.getDisplayAnalyzer()->isCloneModeActive();
+    bool cloneSource = cloned && mDisplayIndex == IDisplayDevice::DEVICE_PRIMARY;
+    if (cloneSource != mCloneSource) {
+        DTRACE("clone mode changed during suspension");
+        return false;
+    }
+
+    bool geometryChanged = list->flags & HWC_GEOMETRY_CHANGED;
+    for (int i = 0; i < mLayerCount; i++) {
+        HwcLayer *hwcLayer = mLayers.itemAt(i);
+        hwc_layer_1_t *layer = &list->hwLayers[i];
+
+        if (!isRestorable(hwcLayer, layer->compositionType, geometryChanged)) {
+            DTRACE("composition type of layer %d changed during suspension", i);
+            return false;
+        }
+
+        if (hwcLayer->getType() == HwcLayer::LAYER_OVERLAY &&
+            !hwc.getDisplayAnalyzer()->isOverlayAllowed()) {
+            DTRACE("overlay is not allowed any more");
+            return false;
+        }
+
+        if (!hwcLayer->hasSameGeometry(layer)) {
+            DTRACE("geometry of layer %d changed during suspension", i);
+            return false;
+        }
+    }
+
+    // composition types are set again as the plan was made
+    for (int i = 0; i < mLayerCount; i++) {
+        mLayers.itemAt(i)->resume(&list->hwLayers[i]);
+    }
+
+    mList = list;
+    mSuspended = false;
+    DTRACE("layer list of device %d is restored", mDisplayIndex);
+    return true;
+}
+
+bool HwcLayerList::isRestorable(HwcLayer *hwcLayer, int32_t type, bool geometryChanged)
+{
+    // without a geometry change surface flinger hands back the types
+    // set by the plan, otherwise it resets them to HWC_FRAMEBUFFER
+    switch (hwcLayer->getType()) {
+    case HwcLayer::LAYER_FRAMEBUFFER_TARGET:
+        return type == HWC_FRAMEBUFFER_TARGET;
+    case HwcLayer::LAYER_SKIPPED:
+        return type == HWC_OVERLAY;
+    case HwcLayer::LAYER_SIDEBAND:
+        return type == HWC_SIDEBAND;
+    case HwcLayer::LAYER_BACKGROUND:
+        return type == HWC_BACKGROUND;
+    case HwcLayer::LAYER_FB:
+    case HwcLayer::LAYER_FORCE_FB:
+        return type == HWC_FRAMEBUFFER;
+    case HwcLayer::LAYER_OVERLAY:
+        return type == HWC_FRAMEBUFFER ||
+               (type == HWC_OVERLAY && !geometryChanged);
+    case HwcLayer::LAYER_CURSOR_OVERLAY:
+        return type == HWC_FRAMEBUFFER ||
+               (type == HWC_CURSOR_OVERLAY && !geometryChanged);
+    default:
+        return false;
+    }
+}
+
+bool HwcLayerList::isReusable(hwc_display_contents_1_t *list)
+{
+    if (!mAnimating || !list || (int)list->numHwLayers != mLayerCount) {
+        return false;
+    }
+
+    // only an all-GLES plan survives geometry changes, plane
+    // capabilities are not re-checked for the new geometry
+    for (int i = 0; i < mLayerCount; i++) {
+        HwcLayer *hwcLayer = mLayers.itemAt(i);
+        if (hwcLayer == mFrameBufferTarget) {
+            continue;
+        }
+
+        if (hwcLayer->getType() == HwcLayer::LAYER_BACKGROUND) {
+            continue;
+        }
+
+        if (hwcLayer->getPlane() ||
+            hwcLayer->getType() == HwcLayer::LAYER_SKIPPED ||
+            hwcLayer->getType() == HwcLayer::LAYER_SIDEBAND) {
+            return false;
+        }
+
+        if (hwcLayer->getHandle() != list->hwLayers[i].handle) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void HwcLayerList::resetCompositionTypes(hwc_display_contents_1_t *list)
+{
+    if (!list || (int)list->numHwLayers != mLayerCount) {
+        return;
+    }
+
+    // undo smart composition and plane assignment so the next list sees
+    // plain FB layers, otherwise they would be taken as skipped layers
+    for (int i = 0; i < mLayerCount; i++) {
+        HwcLayer *hwcLayer = mLayers.itemAt(i);
+        hwc_layer_1_t *layer = &list->hwLayers[i];
+        uint32_t type = hwcLayer->getType();
+
+        if ((type == HwcLayer::LAYER_FB ||
+             type == HwcLayer::LAYER_FORCE_FB ||
+             type == HwcLayer::LAYER_OVERLAY) &&
+            layer->compositionType == HWC_OVERLAY) {
+            layer->compositionType = HWC_FRAMEBUFFER;
+        } else if (type == HwcLayer::LAYER_CURSOR_OVERLAY &&
+            layer->compositionType == HWC_CURSOR_OVERLAY) {
+            layer->compositionType = HWC_FRAMEBUFFER;
+        }
+    }
+}
+
+uint32_t HwcLayerList::getGlesWork() const
+{
+    // fixed cost of a layer draw on top of its fill, in percent of screen
+    static const uint32_t LAYER_OVERHEAD = 10;
+
+    if (!mFrameBufferTarget) {
+        return 0;
+    }
+
+    hwc_rect_t& fb = mFrameBufferTarget->getLayer()->displayFrame;
+    uint64_t screenArea = (uint64_t)(fb.right - fb.left) * (fb.bottom - fb.top);
+    if (!screenArea) {
+        return 0;
+    }
+
+    uint64_t area = 0;
+    uint32_t count = 0;
+    for (size_t i = 0; i < mFBLayers.size(); i++) {
+        hwc_layer_1_t *layer = mFBLayers.itemAt(i)->getLayer();
+        // static layers left out by smart composition cost nothing
+        if (layer->compositionType != HWC_FRAMEBUFFER) {
+            continue;
+        }
+
+        // background color is a fill of the whole screen
+        if (mFBLayers.itemAt(i)->getType() == HwcLayer::LAYER_BACKGROUND) {
+            area += screenArea;
+            count++;
+            continue;
+        }
+
+        hwc_rect_t& dst = layer->displayFrame;
+        hwc_frect_t& src = layer->sourceCropf;
+        uint64_t dstArea = (uint64_t)(dst.right - dst.left) * (dst.bottom - dst.top);
+        uint64_t srcArea = (uint64_t)((src.right - src.left) * (src.bottom - src.top));
+
+        // downscaling samples every source texel
+        area += (srcArea > dstArea) ? srcArea : dstArea;
+        count++;
+    }
+
+    if (!count) {
+        return 0;
+    }
+
+    return (uint32_t)(area * 100 / screenArea) + count * LAYER_OVERHEAD;
 }
 
 void HwcLayerList::dump(Dump& d)
 {
-    d.append("Layer list: (number of layers %d):\n", mLayers.size());
+    d.append("Layer list: (number of layers %d)%s:\n", mLayers.size(),
+             mSuspended ? " suspended" : "");
     d.append(" LAYER |          TYPE          |   PLANE  | INDEX | Z Order \n");
     d.append("-------+------------------------+----------------------------\n");
     for (size_t i = 0; i < mLayers.size(); i++) {
@@ -1011,6 +1306,9 @@ void HwcLayerList::dump(Dump& d)
             case HwcLayer::LAYER_CURSOR_OVERLAY:
                 type = "HWC_CURSOR_OVERLAY";
                 break;
+            case HwcLayer::LAYER_BACKGROUND:
+                type = "HWC_BACKGROUND";
+                break;
             default:
                 type = "Unknown";
             }
@@ -30,7 +30,7 @@ namespace intel {
 
 class HwcLayerList {
 public:
-    HwcLayerList(hwc_display_contents_1_t *list, int disp);
+    HwcLayerList(hwc_display_contents_1_t *list, int disp, bool animating = false);
     virtual ~HwcLayerList();
 
 public:
@@ -42,12 +42,30 @@ public:
 
     void postFlip();
 
+    // keep the plan, planes and mappings while display is blanked
+    void suspend();
+    // take the list resubmitted after unblank with the kept plan, returns
+    // false if it is not the list the plan was built for
+    bool restore(hwc_display_contents_1_t *list);
+    bool isSuspended() const { return mSuspended; }
+
+    // list built while an animation is running keeps UI layers in GLES
+    bool isAnimating() const { return mAnimating; }
+    bool isReusable(hwc_display_contents_1_t *list);
+    void resetCompositionTypes(hwc_display_contents_1_t *list);
+
+    // GLES composition load in percent of a full screen of fill
+    uint32_t getGlesWork() const;
+
     // dump interface
     virtual void dump(Dump& d);
 
 private:
     bool checkSupported(int planeType, HwcLayer *hwcLayer);
     bool checkCursorSupported(HwcLayer *hwcLayer);
+    static void getPlaneConfig(int planeType, HwcLayer *hwcLayer, PlaneConfig& config);
+    static bool isRestorable(HwcLayer *hwcLayer, int32_t type, bool geometryChanged);
+    void updateUnderrunCandidate();
     bool allocatePlanes();
     bool assignCursorPlanes();
     bool assignCursorPlanes(int index, int planeNumber);
@@ -103,6 +121,9 @@ private:
     HwcLayer *mFrameBufferTarget;
     int mDisplayIndex;
     int mLayerSize;
+    bool mSuspended;
+    bool mAnimating;
+    bool mCloneSource;
 };
 
 } // namespace intel
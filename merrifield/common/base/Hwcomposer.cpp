@@ -34,6 +34,8 @@ Hwcomposer::Hwcomposer(IPlatFactory *factory)
       mPlaneManager(0),
       mBufferManager(0),
       mDisplayContext(0),
+      mGpuBoostManager(0),
+      mDeferredWorkQueue(0),
       mInitialized(false)
 {
     CTRACE();
@@ -74,6 +76,8 @@ bool Hwcomposer::prepare(size_t numDisplays,
         if(numDisplays > mDisplayDevices.size())
                 numDisplays = mDisplayDevices.size();
 
+    mGpuBoostManager->beginFrame();
+
     // reclaim all allocated planes if possible
     for (size_t i = 0; i < numDisplays; i++) {
         IDisplayDevice *device = mDisplayDevices.itemAt(i);
@@ -105,6 +109,9 @@ bool Hwcomposer::prepare(size_t numDisplays,
         }
     }
 
+    // hint the GPU before the GLES work of this frame is queued
+    mGpuBoostManager->endFrame();
+
     return ret;
 }
 
@@ -124,6 +131,10 @@ bool Hwcomposer::commit(size_t numDisplays,
         if(numDisplays > mDisplayDevices.size())
                 numDisplays = mDisplayDevices.size();
 
+    // frame buffer target of the primary device is known only at commit
+    mDisplayAnalyzer->cloneFrameBufferTarget(numDisplays, displays);
+    mDisplayAnalyzer->cloneAcquireFence(numDisplays, displays);
+
     mDisplayContext->commitBegin(numDisplays, displays);
 
     for (size_t i = 0; i < numDisplays; i++) {
@@ -149,6 +160,9 @@ bool Hwcomposer::commit(size_t numDisplays,
     }
 
     mDisplayContext->commitEnd(numDisplays, displays);
+    mDisplayAnalyzer->mergeCloneReleaseFence(numDisplays, displays);
+
+    mPlaneManager->updateBandwidth();
     // return true always
     return true;
 }
@@ -330,6 +344,9 @@ void Hwcomposer::vsync(int disp, int64_t timestamp)
 {
     RETURN_VOID_IF_NOT_INIT();
 
+    // the flip is done, housekeeping can use the rest of the period
+    mDeferredWorkQueue->onVsync(timestamp);
+
     if (mProcs && mProcs->vsync) {
         VTRACE("report vsync on disp %d, timestamp %llu", disp, timestamp);
         // workaround to pretend vsync is from primary display
@@ -378,8 +395,12 @@ bool Hwcomposer::dump(char *buff, int buff_len, int *cur_len)
 
     Dump d(buff, buff_len);
 
+    // log level may be changed at runtime, picked up on dump
+    hwcTraceUpdateLevel();
+
     // dump composer status
     d.append("Hardware Composer state:");
+    d.append(" log level %d\n", android_atomic_acquire_load(&gHwcTraceLevel));
     // dump device status
     for (size_t i= 0; i < mDisplayDevices.size(); i++) {
         IDisplayDevice *device = mDisplayDevices.itemAt(i);
@@ -391,6 +412,9 @@ bool Hwcomposer::dump(char *buff, int buff_len, int *cur_len)
     if (mPlaneManager)
         mPlaneManager->dump(d);
 
+    if (mGpuBoostManager)
+        mGpuBoostManager->dump(d);
+
     // dump buffer manager status
     if (mBufferManager)
         mBufferManager->dump(d);
@@ -412,6 +436,14 @@ bool Hwcomposer::initialize()
 {
     CTRACE();
 
+    hwcTraceUpdateLevel();
+
+    // housekeeping of all other objects may be deferred
+    mDeferredWorkQueue = new DeferredWorkQueue();
+    if (!mDeferredWorkQueue || !mDeferredWorkQueue->initialize()) {
+        DEINIT_AND_RETURN_FALSE("failed to create deferred work queue");
+    }
+
     // create drm
     mDrm = new Drm();
     if (!mDrm || !mDrm->initialize()) {
@@ -439,6 +471,11 @@ bool Hwcomposer::initialize()
         DEINIT_AND_RETURN_FALSE("failed to create display context");
     }
 
+    mGpuBoostManager = new GpuBoostManager(mPlatFactory->createGpuBoostControl());
+    if (!mGpuBoostManager || !mGpuBoostManager->initialize()) {
+        DEINIT_AND_RETURN_FALSE("failed to create GPU boost manager");
+    }
+
     mUeventObserver = new UeventObserver();
     if (!mUeventObserver || !mUeventObserver->initialize()) {
         DEINIT_AND_RETURN_FALSE("failed to initialize uevent observer");
@@ -481,6 +518,10 @@ bool Hwcomposer::initialize()
 
 void Hwcomposer::deinitialize()
 {
+    // run pending work while its owners still exist, later work runs inline
+    if (mDeferredWorkQueue)
+        mDeferredWorkQueue->deinitialize();
+
     DEINIT_AND_DELETE_OBJ(mMultiDisplayObserver);
     DEINIT_AND_DELETE_OBJ(mDisplayAnalyzer);
     // delete mVsyncManager first as it holds reference to display devices.
@@ -499,10 +540,12 @@ void Hwcomposer::deinitialize()
         mPlatFactory = 0;
     }
 
+    DEINIT_AND_DELETE_OBJ(mGpuBoostManager);
     DEINIT_AND_DELETE_OBJ(mDisplayContext);
     DEINIT_AND_DELETE_OBJ(mPlaneManager);
     DEINIT_AND_DELETE_OBJ(mBufferManager);
     DEINIT_AND_DELETE_OBJ(mDrm);
+    DEINIT_AND_DELETE_OBJ(mDeferredWorkQueue);
     mInitialized = false;
 }
 
@@ -550,6 +593,16 @@ VsyncManager* Hwcomposer::getVsyncManager()
     return mVsyncManager;
 }
 
+GpuBoostManager* Hwcomposer::getGpuBoostManager()
+{
+    return mGpuBoostManager;
+}
+
+DeferredWorkQueue* Hwcomposer::getDeferredWorkQueue()
+{
+    return mDeferredWorkQueue;
+}
+
 UeventObserver* Hwcomposer::getUeventObserver()
 {
     return mUeventObserver;
@@ -15,6 +15,7 @@
 */
 #include <HwcTrace.h>
 #include <GraphicBuffer.h>
+#include <hal_public.h>
 
 namespace android {
 namespace intel {
@@ -55,22 +56,77 @@ bool GraphicBuffer::isCompressionUsage(uint32_t usage)
         return false;
     }
 
+    // gralloc has no usage bit for compression, it is encoded in the
+    // vendor format instead. see isCompressionFormat
     return false;
 }
 
+bool GraphicBuffer::isCompressionFormat(uint32_t format)
+{
+    if ((format & ~0xff) != VENDOR_FORMAT_BASE) {
+        return false;
+    }
+
+    return (format & (VENDOR_FORMAT_COMPRESSION_MASK |
+                      VENDOR_FORMAT_TWIDDLED)) != 0;
+}
+
 bool GraphicBuffer::isCompressionBuffer(GraphicBuffer *buffer)
 {
     if (buffer == NULL) {
         return false;
     }
 
-    return isCompressionUsage(buffer->mUsage);
+    return isCompressionUsage(buffer->mUsage) ||
+           isCompressionFormat(buffer->mGrallocFormat);
+}
+
+bool GraphicBuffer::isScanoutCompressionFormat(uint32_t format)
+{
+    if ((format & ~0xff) != VENDOR_FORMAT_BASE) {
+        return false;
+    }
+
+    // display controller fetches compressed surfaces in 32-pixel wide
+    // tiles, that is only the direct 32x2 mode in the strided layout.
+    // other modes and the twiddled layout are left to GLES
+    uint32_t mode = (format & VENDOR_FORMAT_COMPRESSION_MASK) >>
+                    VENDOR_FORMAT_COMPRESSION_SHIFT;
+    return mode == HAL_FB_COMPRESSION_DIRECT_32x2 &&
+           (format & VENDOR_FORMAT_TWIDDLED) == 0;
+}
+
+bool GraphicBuffer::isScanoutCompressionBuffer(GraphicBuffer *buffer)
+{
+    if (buffer == NULL) {
+        return false;
+    }
+
+    return isScanoutCompressionFormat(buffer->mGrallocFormat);
+}
+
+uint32_t GraphicBuffer::getBaseFormat(uint32_t format)
+{
+    if ((format & ~0xff) != VENDOR_FORMAT_BASE) {
+        return format;
+    }
+
+    uint32_t index = format & VENDOR_FORMAT_INDEX_MASK;
+
+    // vendor index 4 and 5 alias the core RGB_565 and BGRA_8888 formats
+    if (index == HAL_PIXEL_FORMAT_RGB_565 ||
+        index == HAL_PIXEL_FORMAT_BGRA_8888) {
+        return index;
+    }
+
+    return VENDOR_FORMAT_BASE | index;
 }
 
 void GraphicBuffer::initBuffer(buffer_handle_t handle)
 {
     mUsage = USAGE_INVALID;
     mBpp = 0;
+    mGrallocFormat = 0;
 }
 
 }
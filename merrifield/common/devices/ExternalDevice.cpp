@@ -29,9 +29,21 @@ ExternalDevice::ExternalDevice(Hwcomposer& hwc, DeviceControlFactory* controlFac
       mAbortModeSettingCond(),
       mPendingDrmMode(),
       mHotplugEventPending(false),
-      mExpectedRefreshRate(0)
+      mExpectedRefreshRate(0),
+      mPipeSourceWidth(0),
+      mPipeSourceHeight(0),
+      mScalingType(PipeGeometry::SCALING_ASPECT),
+      mOverscanH(0),
+      mOverscanV(0),
+      mScalingChanged(false),
+      mImageScalable(false),
+      mPendingPipeWidth(0),
+      mPendingPipeHeight(0),
+      mPendingKeepAspect(true),
+      mPipeSourceDirty(false)
 {
     CTRACE();
+    memset(&mCloneFrame, 0, sizeof(mCloneFrame));
 }
 
 ExternalDevice::~ExternalDevice()
@@ -83,9 +95,184 @@ void ExternalDevice::deinitialize()
     }
 
     mHotplugEventPending = false;
+    mPipeSourceWidth = 0;
+    mPipeSourceHeight = 0;
+    mPendingPipeWidth = 0;
+    mPendingPipeHeight = 0;
     PhysicalDevice::deinitialize();
 }
 
+bool ExternalDevice::prepare(hwc_display_contents_1_t *display)
+{
+    RETURN_FALSE_IF_NOT_INIT();
+
+    updatePipeGeometry(display);
+    return PhysicalDevice::prepare(display);
+}
+
+bool ExternalDevice::commit(hwc_display_contents_1_t *display, IDisplayContext *context)
+{
+    RETURN_FALSE_IF_NOT_INIT();
+
+    // pipe source and panel fitter change with the frame posted next
+    updatePipeSource(display);
+    return PhysicalDevice::commit(display, context);
+}
+
+void ExternalDevice::updatePipeGeometry(hwc_display_contents_1_t *display)
+{
+    int width = 0, height = 0;
+    int srcWidth = 0, srcHeight = 0;
+    int modeWidth = 0, modeHeight = 0;
+    hwc_rect_t frame;
+    int type, hOverscan, vOverscan;
+    bool scalable = false;
+
+    {
+        Mutex::Autolock _l(mLock);
+        type = mScalingType;
+        hOverscan = mOverscanH;
+        vOverscan = mOverscanV;
+        if (mScalingChanged) {
+            mPipeSourceDirty = true;
+            mScalingChanged = false;
+        }
+    }
+
+    drmModeModeInfo mode;
+    Drm *drm = mHwc.getDrm();
+    if (mConnected && drm->getModeInfo(mType, mode)) {
+        modeWidth = mode.hdisplay;
+        modeHeight = mode.vdisplay;
+    }
+
+    // frame buffer target carries the primary geometry in clone mode,
+    // otherwise layers are composed at the mode size and scaling type
+    // and overscan have nothing to work on
+    DisplayAnalyzer *analyzer = mHwc.getDisplayAnalyzer();
+    if (mConnected && !mBlank && display && display->numHwLayers && modeWidth) {
+        srcWidth = modeWidth;
+        srcHeight = modeHeight;
+        if (analyzer->isCloneModeActive()) {
+            hwc_layer_1_t& target = display->hwLayers[display->numHwLayers - 1];
+            srcWidth = target.displayFrame.right - target.displayFrame.left;
+            srcHeight = target.displayFrame.bottom - target.displayFrame.top;
+        }
+        scalable = PipeGeometry::getPipeSource(type, hOverscan, vOverscan,
+                                               srcWidth, srcHeight,
+                                               modeWidth, modeHeight,
+                                               width, height, frame);
+        if (!scalable) {
+            width = 0;
+            height = 0;
+            if (mPipeSourceDirty && (hOverscan || vOverscan)) {
+                WTRACE("overscan needs an image smaller than the mode");
+            }
+        }
+    }
+
+    {
+        Mutex::Autolock _l(mLock);
+        mImageScalable = scalable;
+    }
+
+    // planes are positioned in prepare, the pipe follows at commit
+    mPendingPipeWidth = width;
+    mPendingPipeHeight = height;
+    mPendingKeepAspect = type != PipeGeometry::SCALING_FULL;
+    if (width) {
+        mCloneFrame = frame;
+    }
+    offsetCloneTarget(display);
+}
+
+void ExternalDevice::updatePipeSource(hwc_display_contents_1_t *display)
+{
+    int width = mPendingPipeWidth;
+    int height = mPendingPipeHeight;
+
+    if (width == mPipeSourceWidth && height == mPipeSourceHeight && !mPipeSourceDirty) {
+        offsetCloneTarget(display);
+        return;
+    }
+    mPipeSourceDirty = false;
+
+    // pipe is reprogrammed by the next mode setting if disconnected
+    if (mConnected) {
+        Drm *drm = mHwc.getDrm();
+        if (!drm->setPipeSource(mType, width, height, mPendingKeepAspect) && width) {
+            ETRACE("failed to scale %dx%d, falling back to composition", width, height);
+            mHwc.getDisplayAnalyzer()->disableCloneMode();
+            drm->setPipeSource(mType, 0, 0);
+            width = 0;
+            height = 0;
+            mPendingPipeWidth = 0;
+            mPendingPipeHeight = 0;
+        }
+    }
+
+    mPipeSourceWidth = width;
+    mPipeSourceHeight = height;
+    offsetCloneTarget(display);
+}
+
+void ExternalDevice::offsetCloneTarget(hwc_display_contents_1_t *display)
+{
+    if (!mPendingPipeWidth || !display || !display->numHwLayers) {
+        return;
+    }
+
+    // the target is rewritten from the primary one every frame
+    hwc_layer_1_t& target = display->hwLayers[display->numHwLayers - 1];
+    target.displayFrame = mCloneFrame;
+}
+
+bool ExternalDevice::setScalingType(int type)
+{
+    if (type < PipeGeometry::SCALING_ASPECT || type > PipeGeometry::SCALING_CENTER) {
+        WTRACE("invalid scaling type %d", type);
+        return false;
+    }
+
+    {
+        Mutex::Autolock _l(mLock);
+        // an image as large as the mode is always shown 1:1
+        if (!mImageScalable && type != PipeGeometry::SCALING_ASPECT) {
+            WTRACE("scaling type %d needs an image smaller than the mode", type);
+            return false;
+        }
+        ITRACE("scaling type %d", type);
+        mScalingType = type;
+        mScalingChanged = true;
+    }
+    mHwc.invalidate();
+    return true;
+}
+
+bool ExternalDevice::setOverscan(int hPercent, int vPercent)
+{
+    if (hPercent < 0 || hPercent > PipeGeometry::MAX_OVERSCAN ||
+        vPercent < 0 || vPercent > PipeGeometry::MAX_OVERSCAN) {
+        WTRACE("invalid overscan compensation %d%%, %d%%", hPercent, vPercent);
+        return false;
+    }
+
+    {
+        Mutex::Autolock _l(mLock);
+        // the panel fitter can't shrink an image as large as the mode
+        if (!mImageScalable && (hPercent || vPercent)) {
+            WTRACE("overscan compensation needs an image smaller than the mode");
+            return false;
+        }
+        ITRACE("overscan compensation %d%%, %d%%", hPercent, vPercent);
+        mOverscanH = hPercent;
+        mOverscanV = vPercent;
+        mScalingChanged = true;
+    }
+    mHwc.invalidate();
+    return true;
+}
+
 bool ExternalDevice::setDrmMode(drmModeModeInfo& value)
 {
     if (!mConnected) {
@@ -149,6 +336,9 @@ void ExternalDevice::setDrmMode()
 
     // TODO: potential threading issue with onHotplug callback
     mHdcpControl->stopHdcp();
+    // mode setting restores the native pipe source
+    mPipeSourceWidth = 0;
+    mPipeSourceHeight = 0;
     if (!drm->setDrmMode(mType, mPendingDrmMode)) {
         ETRACE("failed to set Drm mode");
         mHwc.hotplug(mType, true);
@@ -237,6 +427,8 @@ void ExternalDevice::hotplugListener()
 
     if (mConnected == false) {
         mHotplugEventPending = false;
+        mPipeSourceWidth = 0;
+        mPipeSourceHeight = 0;
         mHwc.getVsyncManager()->resetVsyncSource();
         mHdcpControl->stopHdcp();
         mHwc.hotplug(mType, mConnected);
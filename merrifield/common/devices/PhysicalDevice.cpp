@@ -32,6 +32,7 @@ PhysicalDevice::PhysicalDevice(uint32_t type, Hwcomposer& hwc, DeviceControlFact
       mLayerList(NULL),
       mConnected(false),
       mBlank(false),
+      mBlacklistVersion(0),
       mDisplayState(DEVICE_DISPLAY_ON),
       mInitialized(false),
       mFpsDivider(1)
@@ -73,7 +74,7 @@ void PhysicalDevice::onGeometryChanged(hwc_display_contents_1_t *list)
     }
 
     // create a new layer list
-    mLayerList = new HwcLayerList(list, mType);
+    mLayerList = new HwcLayerList(list, mType, mAnimationDetector.isAnimating());
     if (!mLayerList) {
         WTRACE("failed to create layer list");
     }
@@ -84,16 +85,65 @@ bool PhysicalDevice::prePrepare(hwc_display_contents_1_t *display)
     RETURN_FALSE_IF_NOT_INIT();
     Mutex::Autolock _l(mLock);
 
+    if (mConnected && mBlank) {
+        // keep the plan, planes and mappings of the layer list while
+        // display is blanked, first frame after unblank reuses them
+        if (mLayerList) {
+            mLayerList->suspend();
+        }
+        return true;
+    }
+
     // for a null list, delete hwc list
-    if (!mConnected || !display || mBlank) {
+    if (!mConnected || !display) {
         if (mLayerList) {
             DEINIT_AND_DELETE_OBJ(mLayerList);
         }
+        mAnimationDetector.reset();
+        return true;
+    }
+
+    if (mLayerList && mLayerList->isSuspended()) {
+        // surface flinger resubmits the same layers after unblank in most
+        // cases, the list is only rebuilt if they changed during blank
+        if (mLayerList->restore(display)) {
+            return true;
+        }
+        DTRACE("layer list of device %d changed during blank", mType);
+        mLayerList->resetCompositionTypes(display);
+        DEINIT_AND_DELETE_OBJ(mLayerList);
+        display->flags |= HWC_GEOMETRY_CHANGED;
+        return true;
+    }
+
+    if (mAnimationDetector.update(display, systemTime(SYSTEM_TIME_MONOTONIC))) {
+        DTRACE("animation %s on device %d",
+               mAnimationDetector.isAnimating() ? "started" : "settled", mType);
+    }
+
+    if (mLayerList && mLayerList->isAnimating() && !mAnimationDetector.isAnimating() &&
+        !(display->flags & HWC_GEOMETRY_CHANGED)) {
+        // animation settled, move layers back to hardware planes
+        mLayerList->resetCompositionTypes(display);
+        DEINIT_AND_DELETE_OBJ(mLayerList);
+        display->flags |= HWC_GEOMETRY_CHANGED;
         return true;
     }
 
+    // plan again without configurations learned to underrun the pipe
+    uint32_t version = mHwc.getPlaneManager()->getBlacklistVersion();
+    if (version != mBlacklistVersion) {
+        mBlacklistVersion = version;
+        display->flags |= HWC_GEOMETRY_CHANGED;
+    }
+
     // check if geometry is changed, if changed delete list
     if ((display->flags & HWC_GEOMETRY_CHANGED) && mLayerList) {
+        if (mAnimationDetector.isAnimating() && mLayerList->isReusable(display)) {
+            // keep the GLES plan instead of re-assigning planes per frame
+            VTRACE("keeping layer list of device %d during animation", mType);
+            return true;
+        }
         DEINIT_AND_DELETE_OBJ(mLayerList);
     }
     return true;
@@ -107,8 +157,8 @@ bool PhysicalDevice::prepare(hwc_display_contents_1_t *display)
     if (!mConnected || !display || mBlank)
         return true;
 
-    // check if geometry is changed
-    if (display->flags & HWC_GEOMETRY_CHANGED) {
+    // check if geometry is changed, a list kept during animation is reused
+    if ((display->flags & HWC_GEOMETRY_CHANGED) && !mLayerList) {
         onGeometryChanged(display);
     }
     if (!mLayerList) {
@@ -117,7 +167,9 @@ bool PhysicalDevice::prepare(hwc_display_contents_1_t *display)
     }
 
     // update list with new list
-    return mLayerList->update(display);
+    bool ret = mLayerList->update(display);
+    mHwc.getGpuBoostManager()->addWork(mType, mLayerList->getGlesWork());
+    return ret;
 }
 
 
@@ -128,6 +180,9 @@ bool PhysicalDevice::commit(hwc_display_contents_1_t *display, IDisplayContext *
     if (!display || !context || !mLayerList || mBlank) {
         return true;
     }
+
+    // an underrun since the last commit happened with the plan last flipped
+    checkUnderrun();
     return context->commitContents(display, mLayerList);
 }
 
@@ -495,6 +550,23 @@ void PhysicalDevice::onVsync(int64_t timestamp)
     mHwc.vsync(mType, timestamp);
 }
 
+void PhysicalDevice::checkUnderrun()
+{
+    DisplayPlaneManager *planeManager = mHwc.getPlaneManager();
+    if (!planeManager->isUnderrunBlacklistEnabled()) {
+        return;
+    }
+
+    if (!mHwc.getDrm()->checkPipeUnderrun(mType)) {
+        return;
+    }
+
+    WTRACE_LIMITED("pipe underrun on device %d", mType);
+    if (planeManager->reportUnderrun(mType)) {
+        mHwc.invalidate();
+    }
+}
+
 void PhysicalDevice::dump(Dump& d)
 {
     Mutex::Autolock _l(mLock);
@@ -517,6 +589,7 @@ void PhysicalDevice::dump(Dump& d)
                      config->getDpiY());
         }
     }
+    d.append("Animating: %s\n", mAnimationDetector.isAnimating() ? "yes" : "no");
     // dump layer list
     if (mLayerList)
         mLayerList->dump(d);
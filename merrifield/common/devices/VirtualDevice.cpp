@@ -18,6 +18,7 @@
 #include <DisplayPlaneManager.h>
 #include <DisplayQuery.h>
 #include <VirtualDevice.h>
+#include <VaRotation.h>
 #include <SoftVsyncObserver.h>
 
 #include <binder/IServiceManager.h>
@@ -319,6 +320,7 @@ struct VirtualDevice::ComposeTask : public VirtualDevice::RenderTask {
           rgbHandle(NULL),
           mappedRgbIn(NULL),
           outputHandle(NULL),
+          rotation(VA_ROTATION_NONE),
           yuvAcquireFenceFd(-1),
           rgbAcquireFenceFd(-1),
           outbufAcquireFenceFd(-1),
@@ -376,17 +378,17 @@ struct VirtualDevice::ComposeTask : public VirtualDevice::RenderTask {
         if (mappedRgbIn != NULL) {
             if (dump)
                 dumpSurface(vd.va_dpy, "/data/misc/vsp_in.rgb", mappedRgbIn->surface, align_width(outWidth)*align_height(outHeight)*4);
-            vd.vspCompose(videoInSurface, mappedRgbIn->surface, mappedVideoOut.surface, &surface_region, &output_region);
+            vd.vspCompose(videoInSurface, mappedRgbIn->surface, mappedVideoOut.surface, &surface_region, &output_region, rotation);
         }
         else if (rgbHandle != NULL) {
             VAMappedHandle localMappedRgbIn(vd.va_dpy, rgbHandle, align_width(outWidth), align_height(outHeight), (unsigned int)VA_FOURCC_BGRA);
-            vd.vspCompose(videoInSurface, localMappedRgbIn.surface, mappedVideoOut.surface, &surface_region, &output_region);
+            vd.vspCompose(videoInSurface, localMappedRgbIn.surface, mappedVideoOut.surface, &surface_region, &output_region, rotation);
         }
         else {
             // No RGBA, so compose with 100% transparent RGBA frame.
             if (dump)
                 dumpSurface(vd.va_dpy, "/data/misc/vsp_in.rgb", vd.va_blank_rgb_in, align_width(outWidth)*align_height(outHeight)*4);
-            vd.vspCompose(videoInSurface, vd.va_blank_rgb_in, mappedVideoOut.surface, &surface_region, &output_region);
+            vd.vspCompose(videoInSurface, vd.va_blank_rgb_in, mappedVideoOut.surface, &surface_region, &output_region, rotation);
         }
         if (dump)
             dumpSurface(vd.va_dpy, "/data/misc/vsp_out.yuv", mappedVideoOut.surface, align_width(outWidth)*align_height(outHeight)*3/2);
@@ -420,6 +422,8 @@ struct VirtualDevice::ComposeTask : public VirtualDevice::RenderTask {
     VARectangle output_region;
     uint32_t outWidth;
     uint32_t outHeight;
+    // VA_ROTATION_xxx applied by VSP, output_region is in rotated coordinates
+    uint32_t rotation;
     sp<CachedBuffer> videoCachedBuffer;
     sp<RefBase> heldVideoBuffer;
     int yuvAcquireFenceFd;
@@ -719,6 +723,7 @@ status_t VirtualDevice::start(sp<IFrameTypeChangeListener> typeChangeListener)
         Hwcomposer::getInstance().getDisplayAnalyzer()->isVideoExtModeEnabled();
     mVideoFramerate = 0;
     mFirstVideoFrame = true;
+    mFrameRateEstimator.reset();
     mNextConfig.frameServerActive = true;
     mNextConfig.forceNotifyFrameType = true;
     mNextConfig.forceNotifyBufferInfo = true;
@@ -786,6 +791,9 @@ static bool canUseDirectly(const hwc_display_contents_1_t *display, size_t n)
 {
     const hwc_layer_1_t& fbTarget = display->hwLayers[display->numHwLayers-1];
     const hwc_layer_1_t& layer = display->hwLayers[n];
+    if (layer.compositionType == HWC_BACKGROUND) {
+        return false;
+    }
     const IMG_native_handle_t* nativeHandle = reinterpret_cast<const IMG_native_handle_t*>(layer.handle);
     return !(layer.flags & HWC_SKIP_LAYER) && layer.transform == 0 &&
             layer.blending == HWC_BLENDING_PREMULT &&
@@ -890,7 +898,7 @@ bool VirtualDevice::prepare(hwc_display_contents_1_t *display)
         if (analyzer->isVideoLayer(layer) && (mCurrentConfig.extendedModeEnabled || mDebugVspClear || analyzer->isProtectedLayer(layer))) {
             if (mCurrentConfig.frameServerActive && mCurrentConfig.extendedModeEnabled) {
                 // If composed in surface flinger, then stream fbtarget.
-                if ((layer.flags & HWC_SKIP_LAYER) && !analyzer->ignoreVideoSkipFlag()) {
+                if ((layer.flags & HWC_SKIP_LAYER) && !analyzer->ignoreVideoSkipFlag(layer)) {
                     continue;
                 }
 
@@ -911,6 +919,7 @@ bool VirtualDevice::prepare(hwc_display_contents_1_t *display)
 
     if (mYuvLayer == -1) {
         mFirstVideoFrame = true;
+        mFrameRateEstimator.reset();
         mDecWidth = 0;
         mDecHeight = 0;
     }
@@ -1068,7 +1077,7 @@ bool VirtualDevice::queueCompose(hwc_display_contents_1_t *display)
 
         composeTask->outputHandle = mCscBuffers.get(composeTask->outWidth, composeTask->outHeight, &heldBuffer);
         if (composeTask->outputHandle == NULL) {
-            WTRACE("Out of CSC buffers, dropping frame");
+            WTRACE_LIMITED("Out of CSC buffers, dropping frame");
             return true;
         }
     } else {
@@ -1443,7 +1452,7 @@ bool VirtualDevice::queueColorConvert(hwc_display_contents_1_t *display)
     display->retireFenceFd = dup(layer.releaseFenceFd);
 #endif
     if (blitTask->destHandle == NULL) {
-        WTRACE("Out of CSC buffers, dropping frame");
+        WTRACE_LIMITED("Out of CSC buffers, dropping frame");
         return false;
     }
 
@@ -1523,15 +1532,17 @@ bool VirtualDevice::handleExtendedMode(hwc_display_contents_1_t *display)
         return false;
     }
 
-    if (metadata.transform == 0 || metadata.transform == HAL_TRANSFORM_ROT_180) {
+    if (!VaRotation::isRotation(metadata.transform)) {
+        WTRACE_LIMITED("transform %d is not a rotation", metadata.transform);
+        return false;
+    }
+
+    if (!VaRotation::isSwapped(metadata.transform)) {
         inputFrameInfo.contentWidth = metadata.normalBuffer.width;
         inputFrameInfo.contentHeight = metadata.normalBuffer.height;
     } else {
         inputFrameInfo.contentWidth = metadata.normalBuffer.height;
         inputFrameInfo.contentHeight = metadata.normalBuffer.width;
-        // 90 and 270 have some issues that appear to be decoder bugs
-        ITRACE("Skipping extended mode due to rotation of 90 or 270");
-        return false;
     }
     // Use the crop size if something changed derive it again..
     // Only get video source info if frame rate has not been initialized.
@@ -1540,6 +1551,7 @@ bool VirtualDevice::handleExtendedMode(hwc_display_contents_1_t *display)
     if (mFirstVideoFrame || (mOrigContentWidth != metadata.normalBuffer.width) ||
         (mOrigContentHeight != metadata.normalBuffer.height)) {
         mVideoFramerate = inputFrameInfo.contentFrameRateN;
+        mFrameRateEstimator.reset();
         VTRACE("VideoWidth = %d, VideoHeight = %d", metadata.normalBuffer.width, metadata.normalBuffer.height);
         mOrigContentWidth = metadata.normalBuffer.width;
         mOrigContentHeight = metadata.normalBuffer.height;
@@ -1561,8 +1573,15 @@ bool VirtualDevice::handleExtendedMode(hwc_display_contents_1_t *display)
         }
         mFirstVideoFrame = false;
     }
-    inputFrameInfo.contentFrameRateN = mVideoFramerate;
-    inputFrameInfo.contentFrameRateD = 1;
+
+    // frame rate derived from media timestamps is preferred, the one
+    // reported by MDS is used until the estimate is stable
+    int32_t frameRateN = mVideoFramerate;
+    int32_t frameRateD = 1;
+    mFrameRateEstimator.addTimestamp(metadata.timestamp);
+    mFrameRateEstimator.getFrameRate(&frameRateN, &frameRateD);
+    inputFrameInfo.contentFrameRateN = frameRateN;
+    inputFrameInfo.contentFrameRateD = frameRateD;
 
     sp<ComposeTask> composeTask;
     sp<RefBase> heldBuffer;
@@ -1585,10 +1604,9 @@ bool VirtualDevice::handleExtendedMode(hwc_display_contents_1_t *display)
     int64_t mediaTimestamp = metadata.timestamp;
 
     VARectangle surface_region;
-    surface_region.x = info.offsetX;
-    surface_region.y = info.offsetY;
-    surface_region.width = info.width;
-    surface_region.height = info.height;
+    VARectangle output_region;
+    VaRotation::getRegions(metadata.transform, info.offsetX, info.offsetY,
+            info.width, info.height, &surface_region, &output_region);
     FrameInfo outputFrameInfo = inputFrameInfo;
     outputFrameInfo.bufferFormat = metadata.format;
 
@@ -1639,29 +1657,39 @@ bool VirtualDevice::handleExtendedMode(hwc_display_contents_1_t *display)
     // so we use VSP only when cropping is needed. But using the khandle directly when
     // both rotation and scaling are involved can encode the frame with the wrong
     // tiling status, so use VSP to normalize if any rotation is involved.
+    // For 90 and 270 the decoder rotation buffer has the same issue, so the
+    // unrotated frame is used and VSP does the rotation.
     if (metadata.transform != 0) {
         // Cropping (or above workaround) needed, so use VSP to do it.
+        // 90 and 270 are rotated by VSP from the unrotated decoder output
+        bool vspRotation = VaRotation::isSwapped(metadata.transform);
+        uint32_t outWidth = output_region.width;
+        uint32_t outHeight = output_region.height;
+
         mVspInUse = true;
-        vspPrepare(info.width, info.height);
+        vspPrepare(outWidth, outHeight);
+
+        if (vspRotation &&
+            !VaRotation::isSupported(mVspRotationFlags, VaRotation::fromHalTransform(metadata.transform))) {
+            WTRACE_LIMITED("transform %d is not supported by VSP", metadata.transform);
+            return false;
+        }
 
         composeTask = new ComposeTask();
         composeTask->heldVideoBuffer = heldBuffer;
         heldBuffer = NULL;
-        composeTask->outWidth = info.width;
-        composeTask->outHeight = info.height;
+        composeTask->outWidth = outWidth;
+        composeTask->outHeight = outHeight;
+        composeTask->rotation = vspRotation ? VaRotation::fromHalTransform(metadata.transform) : VA_ROTATION_NONE;
         composeTask->outputHandle = mCscBuffers.get(composeTask->outWidth, composeTask->outHeight, &heldBuffer);
         if (composeTask->outputHandle == NULL) {
-            ITRACE("Out of CSC buffers, dropping frame");
+            ITRACE_LIMITED("Out of CSC buffers, dropping frame");
             return true;
         }
 
         composeTask->surface_region = surface_region;
         composeTask->videoCachedBuffer = cachedBuffer;
-        VARectangle& output_region = composeTask->output_region;
-        output_region.x = 0;
-        output_region.y = 0;
-        output_region.width = info.width;
-        output_region.height = info.height;
+        composeTask->output_region = output_region;
 
         composeTask->videoKhandle = info.khandle;
         composeTask->videoStride = info.lumaStride;
@@ -1900,6 +1928,12 @@ void VirtualDevice::vspEnable(uint32_t width, uint32_t height)
                 &va_context);
     if (va_status != VA_STATUS_SUCCESS) ETRACE("vaCreateContext returns %08x", va_status);
 
+    VAProcPipelineCaps pipeline_caps;
+    memset(&pipeline_caps, 0, sizeof(pipeline_caps));
+    va_status = vaQueryVideoProcPipelineCaps(va_dpy, va_context, NULL, 0, &pipeline_caps);
+    if (va_status != VA_STATUS_SUCCESS) ETRACE("vaQueryVideoProcPipelineCaps returns %08x", va_status);
+    mVspRotationFlags = pipeline_caps.rotation_flags;
+
     VASurfaceID tmp_yuv;
     va_status = vaCreateSurfaces(
                 va_dpy,
@@ -2006,6 +2040,7 @@ void VirtualDevice::vspDisable()
     va_status = vaDestroyContext(va_dpy, va_context);
     if (va_status != VA_STATUS_SUCCESS) ETRACE("vaDestroyContext returns %08x", va_status);
     va_context = 0;
+    mVspRotationFlags = 0;
 
     va_status = vaDestroySurfaces(va_dpy, &va_blank_yuv_in, 1);
     if (va_status != VA_STATUS_SUCCESS) ETRACE("vaDestroySurfaces (video in) returns %08x", va_status);
@@ -2025,7 +2060,8 @@ void VirtualDevice::vspDisable()
 }
 
 void VirtualDevice::vspCompose(VASurfaceID videoIn, VASurfaceID rgbIn, VASurfaceID videoOut,
-                               const VARectangle* surface_region, const VARectangle* output_region)
+                               const VARectangle* surface_region, const VARectangle* output_region,
+                               uint32_t rotation)
 {
     VAStatus va_status;
 
@@ -2054,6 +2090,7 @@ void VirtualDevice::vspCompose(VASurfaceID videoIn, VASurfaceID rgbIn, VASurface
 
     pipeline_param->pipeline_flags = 0;
     pipeline_param->num_filters = 0;
+    pipeline_param->rotation_state = rotation;
     pipeline_param->blend_state = &blend_state;
     pipeline_param->num_additional_outputs = 1;
     pipeline_param->additional_outputs = &rgbIn;
@@ -2096,6 +2133,17 @@ bool VirtualDevice::getFrameOfSize(uint32_t width, uint32_t height, const IVideo
             info = metadata.scalingBuffer;
             return true;
         }
+    } else if (VaRotation::isSwapped(metadata.transform)) {
+        // frame is rotated by VSP, so compare against the rotated size
+        if (metadata.normalBuffer.khandle != 0 && metadata.normalBuffer.width <= height && metadata.normalBuffer.height <= width) {
+            info = metadata.normalBuffer;
+            return true;
+        }
+
+        if (metadata.scalingBuffer.khandle != 0 && metadata.scalingBuffer.width <= height && metadata.scalingBuffer.height <= width) {
+            info = metadata.scalingBuffer;
+            return true;
+        }
     } else {
         if (metadata.rotationBuffer.khandle != 0 && metadata.rotationBuffer.width <= width && metadata.rotationBuffer.height <= height) {
             info = metadata.rotationBuffer;
@@ -2286,6 +2334,7 @@ bool VirtualDevice::initialize()
     va_context = 0;
     va_blank_yuv_in = 0;
     va_blank_rgb_in = 0;
+    mVspRotationFlags = 0;
     mVspUpscale = false;
     mDebugVspClear = false;
     mDebugVspDump = false;
@@ -73,15 +73,13 @@ status_t MultiDisplayCallback::updateInputState(bool state)
 status_t MultiDisplayCallback::setHdmiScalingType(MDS_SCALING_TYPE type)
 {
     ITRACE("scaling type: %d", type);
-    // Merrifield doesn't implement this API
-    return INVALID_OPERATION;
+    return mDispObserver->setHdmiScalingType(type);
 }
 
 status_t MultiDisplayCallback::setHdmiOverscan(int hValue, int vValue)
 {
     ITRACE("oversacn compensation, h: %d v: %d", hValue, vValue);
-    // Merrifield doesn't implement this API
-    return INVALID_OPERATION;
+    return mDispObserver->setHdmiOverscan(hValue, vValue);
 }
 
 ////// MultiDisplayObserver
@@ -326,6 +324,56 @@ status_t MultiDisplayObserver::setHdmiTiming(const MDSHdmiTiming& timing)
     return 0;
 }
 
+status_t MultiDisplayObserver::setHdmiScalingType(MDS_SCALING_TYPE type)
+{
+    int scaling;
+    switch (type) {
+    case MDS_SCALING_NONE:
+    case MDS_SCALING_ASPECT_RATIO:
+        scaling = PipeGeometry::SCALING_ASPECT;
+        break;
+    case MDS_SCALING_FULL_SCREEN:
+        scaling = PipeGeometry::SCALING_FULL;
+        break;
+    case MDS_SCALING_CENTER:
+        scaling = PipeGeometry::SCALING_CENTER;
+        break;
+    default:
+        WTRACE("unsupported scaling type %d", type);
+        return BAD_VALUE;
+    }
+
+    ExternalDevice *dev =
+        (ExternalDevice *)Hwcomposer::getInstance().getDisplayDevice(HWC_DISPLAY_EXTERNAL);
+    if (!dev) {
+        return NO_INIT;
+    }
+    if (!dev->setScalingType(scaling)) {
+        return INVALID_OPERATION;
+    }
+    return 0;
+}
+
+status_t MultiDisplayObserver::setHdmiOverscan(int hValue, int vValue)
+{
+    // values are percentages of the mode taken by the overscan area
+    if (hValue < 0 || hValue > PipeGeometry::MAX_OVERSCAN ||
+        vValue < 0 || vValue > PipeGeometry::MAX_OVERSCAN) {
+        WTRACE("overscan compensation out of range, h: %d v: %d", hValue, vValue);
+        return BAD_VALUE;
+    }
+
+    ExternalDevice *dev =
+        (ExternalDevice *)Hwcomposer::getInstance().getDisplayDevice(HWC_DISPLAY_EXTERNAL);
+    if (!dev) {
+        return NO_INIT;
+    }
+    if (!dev->setOverscan(hValue, vValue)) {
+        return INVALID_OPERATION;
+    }
+    return 0;
+}
+
 status_t MultiDisplayObserver::updateInputState(bool active)
 {
     Hwcomposer::getInstance().getDisplayAnalyzer()->postInputEvent(active);
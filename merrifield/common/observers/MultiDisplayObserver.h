@@ -85,6 +85,8 @@ private:
     status_t blankSecondaryDisplay(bool blank);
     status_t updateVideoState(int sessionId, MDS_VIDEO_STATE state);
     status_t setHdmiTiming(const MDSHdmiTiming& timing);
+    status_t setHdmiScalingType(MDS_SCALING_TYPE type);
+    status_t setHdmiOverscan(int hValue, int vValue);
     status_t updateInputState(bool active);
     friend class MultiDisplayCallback;
 
@@ -17,6 +17,7 @@
 #include <Hwcomposer.h>
 #include <DisplayPlane.h>
 #include <GraphicBuffer.h>
+#include <BandwidthEstimator.h>
 
 namespace android {
 namespace intel {
@@ -32,7 +33,7 @@ DisplayPlane::DisplayPlane(int index, int type, int disp)
       mCacheCapacity(0),
       mIsProtectedBuffer(false),
       mTransform(0),
-      mPlaneAlpha(0),
+      mPlaneAlpha(0xff),
       mBlending(HWC_BLENDING_NONE),
       mCurrentDataBuffer(0),
       mUpdateMasks(0)
@@ -311,14 +312,30 @@ void DisplayPlane::invalidateActiveBuffers()
 
 void DisplayPlane::invalidateBufferCache()
 {
-    BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
-    BufferMapper* mapper;
+    // unmapping costs an ioctl per buffer, do it after the flip
+    class UnmapWork : public DeferredWork {
+    public:
+        UnmapWork(const Vector<BufferMapper*>& mappers) : mMappers(mappers) {}
+        virtual void run() {
+            BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
+            for (size_t i = 0; i < mMappers.size(); i++) {
+                bm->unmap(mMappers.itemAt(i));
+            }
+        }
+    private:
+        Vector<BufferMapper*> mMappers;
+    };
 
     RETURN_VOID_IF_NOT_INIT();
 
-    for (size_t i = 0; i < mDataBuffers.size(); i++) {
-        mapper = mDataBuffers.valueAt(i);
-        bm->unmap(mapper);
+    if (mDataBuffers.size()) {
+        Vector<BufferMapper*> mappers;
+        mappers.setCapacity(mDataBuffers.size());
+        for (size_t i = 0; i < mDataBuffers.size(); i++) {
+            mappers.push_back(mDataBuffers.valueAt(i));
+        }
+        DeferredWorkQueue *dwq = Hwcomposer::getInstance().getDeferredWorkQueue();
+        dwq->queue(new UnmapWork(mappers));
     }
 
     mDataBuffers.clear();
@@ -386,5 +403,21 @@ int DisplayPlane::getZOrder() const
     return mZOrder;
 }
 
+uint32_t DisplayPlane::getFetchBandwidth() const
+{
+    // the last active buffer is the one on screen
+    if (!mInitialized || mActiveBuffers.size() == 0) {
+        return 0;
+    }
+
+    BufferMapper *mapper = mActiveBuffers.itemAt(mActiveBuffers.size() - 1);
+    return BandwidthEstimator::getPlaneBandwidth(mapper->getFormat(),
+                                                 mSrcCrop.w,
+                                                 mSrcCrop.h,
+                                                 mPosition.h,
+                                                 mModeInfo.vdisplay,
+                                                 mModeInfo.vrefresh);
+}
+
 } // namespace intel
 } // namespace android
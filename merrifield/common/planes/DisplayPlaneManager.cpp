@@ -16,6 +16,7 @@
 #include <HwcTrace.h>
 #include <IDisplayDevice.h>
 #include <DisplayPlaneManager.h>
+#include <cutils/properties.h>
 
 namespace android {
 namespace intel {
@@ -25,6 +26,10 @@ DisplayPlaneManager::DisplayPlaneManager()
       mPrimaryPlaneCount(DEFAULT_PRIMARY_PLANE_COUNT),
       mSpritePlaneCount(0),
       mOverlayPlaneCount(0),
+      mBandwidth(0),
+      mBandwidthBudget(DEFAULT_BANDWIDTH_BUDGET),
+      mUnderrunBlacklist(),
+      mUnderrunBlacklistEnabled(false),
       mInitialized(false)
 {
     int i;
@@ -77,6 +82,19 @@ bool DisplayPlaneManager::initialize()
     mPlaneCount[DisplayPlane::PLANE_CURSOR] = mCursorPlaneCount;
 
     mTotalPlaneCount = mSpritePlaneCount+ mOverlayPlaneCount+ mPrimaryPlaneCount + mCursorPlaneCount;
+
+    char prop[PROPERTY_VALUE_MAX];
+    mBandwidthBudget = DEFAULT_BANDWIDTH_BUDGET;
+    if (property_get("hwc.bandwidth.budget", prop, NULL) > 0 && atoi(prop) > 0) {
+        mBandwidthBudget = atoi(prop);
+    }
+    mBandwidth = 0;
+
+    mUnderrunBlacklistEnabled = true;
+    if (property_get("hwc.underrun.blacklist", prop, "1") > 0) {
+        mUnderrunBlacklistEnabled = atoi(prop) ? true : false;
+    }
+    mUnderrunBlacklist.reset();
     if (mTotalPlaneCount == 0) {
         ETRACE("plane count is not initialized");
         return false;
@@ -321,6 +339,49 @@ bool DisplayPlaneManager::isOverlayPlanesDisabled()
     return true;
 }
 
+void DisplayPlaneManager::updateBandwidth()
+{
+    RETURN_VOID_IF_NOT_INIT();
+
+    // planes in use may overlap, sum of their peak rates is the worst case
+    uint32_t bandwidth = 0;
+    for (int i = 0; i < DisplayPlane::PLANE_MAX; i++) {
+        for (int j = 0; j < mPlaneCount[i]; j++) {
+            if (!isFreePlane(i, j)) {
+                bandwidth += mPlanes[i].itemAt(j)->getFetchBandwidth();
+            }
+        }
+    }
+    mBandwidth = bandwidth;
+}
+
+void DisplayPlaneManager::setUnderrunCandidate(int dsp, const PlaneConfig& config)
+{
+    mUnderrunBlacklist.setCandidate(dsp, config);
+}
+
+bool DisplayPlaneManager::reportUnderrun(int dsp)
+{
+    if (!mUnderrunBlacklistEnabled) {
+        return false;
+    }
+    return mUnderrunBlacklist.addUnderrun(dsp, systemTime(SYSTEM_TIME_MONOTONIC));
+}
+
+bool DisplayPlaneManager::isBlacklisted(const PlaneConfig& config)
+{
+    if (!mUnderrunBlacklistEnabled) {
+        return false;
+    }
+    return mUnderrunBlacklist.isBlacklisted(config);
+}
+
+uint32_t DisplayPlaneManager::getBlacklistVersion()
+{
+    mUnderrunBlacklist.expire(systemTime(SYSTEM_TIME_MONOTONIC));
+    return mUnderrunBlacklist.getVersion();
+}
+
 void DisplayPlaneManager::dump(Dump& d)
 {
     d.append("Display Plane Manager state:\n");
@@ -343,6 +404,9 @@ void DisplayPlaneManager::dump(Dump& d)
              mPlaneCount[DisplayPlane::PLANE_CURSOR],
              mFreePlanes[DisplayPlane::PLANE_CURSOR],
              mReclaimedPlanes[DisplayPlane::PLANE_CURSOR]);
+    d.append("  Fetch bandwidth: %u MB/s, budget %u MB/s\n",
+             mBandwidth, mBandwidthBudget);
+    mUnderrunBlacklist.dump(d);
 }
 
 } // namespace intel
@@ -0,0 +1,88 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <HwcTrace.h>
+#include <AnimationDetector.h>
+
+namespace android {
+namespace intel {
+
+AnimationDetector::AnimationDetector()
+{
+    reset();
+}
+
+AnimationDetector::~AnimationDetector()
+{
+}
+
+void AnimationDetector::reset()
+{
+    mHandles.clear();
+    mLastGeometryChange = 0;
+    mGeometryChangeCount = 0;
+    mAnimating = false;
+}
+
+bool AnimationDetector::update(hwc_display_contents_1_t *list, nsecs_t now)
+{
+    bool animating = mAnimating;
+
+    if (!(list->flags & HWC_GEOMETRY_CHANGED)) {
+        if (mAnimating && now - mLastGeometryChange > ms2ns(ANIMATION_SETTLE_MS)) {
+            mAnimating = false;
+            mGeometryChangeCount = 0;
+        }
+        return animating != mAnimating;
+    }
+
+    // a window transition moves the same buffers on every frame
+    if (hasSameBuffers(list) &&
+        now - mLastGeometryChange < ms2ns(ANIMATION_FRAME_GAP_MS)) {
+        mGeometryChangeCount++;
+    } else {
+        mGeometryChangeCount = 1;
+        mHandles.clear();
+        for (size_t i = 0; i < list->numHwLayers; i++) {
+            hwc_layer_1_t *layer = &list->hwLayers[i];
+            if (layer->compositionType != HWC_FRAMEBUFFER_TARGET) {
+                mHandles.push_back(layer->handle);
+            }
+        }
+    }
+    mLastGeometryChange = now;
+
+    mAnimating = mGeometryChangeCount >= ANIMATION_GEOMETRY_CHANGES;
+    return animating != mAnimating;
+}
+
+bool AnimationDetector::hasSameBuffers(hwc_display_contents_1_t *list) const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < list->numHwLayers; i++) {
+        hwc_layer_1_t *layer = &list->hwLayers[i];
+        if (layer->compositionType == HWC_FRAMEBUFFER_TARGET) {
+            continue;
+        }
+        if (count >= mHandles.size() || mHandles[count] != layer->handle) {
+            return false;
+        }
+        count++;
+    }
+    return count == mHandles.size();
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,62 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef ANIMATION_DETECTOR_H
+#define ANIMATION_DETECTOR_H
+
+#include <hardware/hwcomposer.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+namespace intel {
+
+// detects window animations, that is the same buffers under repeated
+// geometry changes
+class AnimationDetector {
+public:
+    AnimationDetector();
+    ~AnimationDetector();
+
+public:
+    void reset();
+    // layers of a frame prepared at the given monotonic time, returns true
+    // if animation started or stopped
+    bool update(hwc_display_contents_1_t *list, nsecs_t now);
+    bool isAnimating() const { return mAnimating; }
+
+private:
+    bool hasSameBuffers(hwc_display_contents_1_t *list) const;
+
+private:
+    enum {
+        // geometry changes on the same buffers that start an animation
+        ANIMATION_GEOMETRY_CHANGES = 3,
+        // longest gap between geometry changes of an animation
+        ANIMATION_FRAME_GAP_MS = 50,
+        // time without geometry change after which animation has settled
+        ANIMATION_SETTLE_MS = 100,
+    };
+
+    Vector<buffer_handle_t> mHandles;
+    nsecs_t mLastGeometryChange;
+    int mGeometryChangeCount;
+    bool mAnimating;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* ANIMATION_DETECTOR_H */
@@ -0,0 +1,66 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#include <HwcTrace.h>
+#include <hardware/hwcomposer.h>
+#include <hal_public.h>
+#include <DisplayQuery.h>
+#include <BandwidthEstimator.h>
+
+namespace android {
+namespace intel {
+
+int BandwidthEstimator::getBitsPerPixel(uint32_t format)
+{
+    switch (format) {
+    case HAL_PIXEL_FORMAT_YCbCr_422_I:
+    case HAL_PIXEL_FORMAT_RGB_565:
+        return 16;
+    case HAL_PIXEL_FORMAT_NV12:
+    case HAL_PIXEL_FORMAT_I420:
+        return 12;
+    default:
+        break;
+    }
+
+    // 4:2:0 video formats
+    if (DisplayQuery::isVideoFormat(format)) {
+        return 12;
+    }
+    return 32;
+}
+
+uint32_t BandwidthEstimator::getPlaneBandwidth(uint32_t format,
+        int srcWidth, int srcHeight, int dstHeight, int vdisplay, int refresh)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstHeight <= 0 ||
+        vdisplay <= 0 || refresh <= 0) {
+        return 0;
+    }
+
+    // source lines of a downscaled plane are fetched within fewer
+    // display lines, so peak rate grows with the vertical downscale factor
+    uint64_t bits = (uint64_t)srcWidth * getBitsPerPixel(format);
+    uint64_t lines = (uint64_t)vdisplay * refresh;
+    if (srcHeight > dstHeight) {
+        lines = lines * srcHeight / dstHeight;
+    }
+
+    return (uint32_t)(bits * lines / 8 / 1000000);
+}
+
+} // namespace intel
+} // namespace android
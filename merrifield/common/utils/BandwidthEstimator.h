@@ -0,0 +1,40 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef BANDWIDTH_ESTIMATOR_H
+#define BANDWIDTH_ESTIMATOR_H
+
+#include <stdint.h>
+
+namespace android {
+namespace intel {
+
+// estimates peak memory fetch bandwidth of display planes
+class BandwidthEstimator {
+public:
+    // peak fetch bandwidth in MB/s of a plane scanning out srcWidth x srcHeight
+    // pixels into dstHeight lines of a vdisplay lines mode
+    static uint32_t getPlaneBandwidth(uint32_t format,
+                                      int srcWidth, int srcHeight, int dstHeight,
+                                      int vdisplay, int refresh);
+
+private:
+    static int getBitsPerPixel(uint32_t format);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* BANDWIDTH_ESTIMATOR_H */
@@ -0,0 +1,215 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#include <HwcTrace.h>
+#include <FrameRateEstimator.h>
+
+namespace android {
+namespace intel {
+
+// standard content frame rates, in 1/1000 fps
+static const struct {
+    int32_t milliFps;
+    int32_t num;
+    int32_t den;
+} STANDARD_RATES[] = {
+    {23976, 24000, 1001},
+    {24000, 24, 1},
+    {25000, 25, 1},
+    {29970, 30000, 1001},
+    {30000, 30, 1},
+    {50000, 50, 1},
+    {59940, 60000, 1001},
+    {60000, 60, 1},
+};
+
+FrameRateEstimator::FrameRateEstimator()
+{
+    reset();
+}
+
+FrameRateEstimator::~FrameRateEstimator()
+{
+}
+
+void FrameRateEstimator::reset()
+{
+    mLastTimestamp = -1;
+    mIntervalCount = 0;
+    mIntervalIndex = 0;
+    mNum = 0;
+    mDen = 1;
+    mCandidateNum = 0;
+    mCandidateDen = 1;
+    mCandidateCount = 0;
+}
+
+void FrameRateEstimator::addTimestamp(int64_t timestamp)
+{
+    if (timestamp == mLastTimestamp) {
+        // same frame again
+        return;
+    }
+
+    int64_t interval = timestamp - mLastTimestamp;
+    bool first = mLastTimestamp < 0;
+    mLastTimestamp = timestamp;
+
+    if (first) {
+        return;
+    }
+
+    if (interval < 0 || interval > MAX_INTERVAL_US) {
+        // seek, loop or pause, keep the current estimate but restart the window
+        VTRACE("discontinuity of %lld us", (long long)interval);
+        mIntervalCount = 0;
+        mIntervalIndex = 0;
+        return;
+    }
+
+    mIntervals[mIntervalIndex] = interval;
+    mIntervalIndex = (mIntervalIndex + 1) % MAX_INTERVALS;
+    if (mIntervalCount < MAX_INTERVALS) {
+        mIntervalCount++;
+    }
+
+    if (mIntervalCount >= MIN_INTERVALS) {
+        estimate();
+    }
+}
+
+bool FrameRateEstimator::getFrameRate(int32_t *num, int32_t *den) const
+{
+    if (mNum <= 0) {
+        return false;
+    }
+    *num = mNum;
+    *den = mDen;
+    return true;
+}
+
+int64_t FrameRateEstimator::getMedianInterval() const
+{
+    int64_t sorted[MAX_INTERVALS];
+    for (int i = 0; i < mIntervalCount; i++) {
+        sorted[i] = mIntervals[i];
+    }
+
+    // insertion sort, window is small
+    for (int i = 1; i < mIntervalCount; i++) {
+        int64_t v = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[mIntervalCount / 2];
+}
+
+void FrameRateEstimator::estimate()
+{
+    int64_t median = getMedianInterval();
+    if (median <= 0) {
+        return;
+    }
+
+    // mean over the window rather than median, so 3:2 pulldown cadence
+    // (alternating 1.5x intervals) averages to the real rate. A gap close
+    // to a multiple of the median is counted as dropped frames, anything
+    // far shorter or longer is rejected as an outlier.
+    int64_t duration = 0;
+    int frames = 0;
+    for (int i = 0; i < mIntervalCount; i++) {
+        int64_t interval = mIntervals[i];
+        int n;
+        if (interval * 2 < median) {
+            continue;
+        } else if (interval * 4 < median * 7) {
+            n = 1;
+        } else {
+            n = (int)((interval + median / 2) / median);
+        }
+        if (n > MAX_DROPPED_FRAMES) {
+            continue;
+        }
+        duration += interval;
+        frames += n;
+    }
+
+    if (frames < MIN_INTERVALS || duration <= 0) {
+        return;
+    }
+
+    int32_t num, den;
+    snapFrameRate(duration, frames, &num, &den);
+    if (num <= 0) {
+        return;
+    }
+
+    if (num == mNum && den == mDen) {
+        mCandidateCount = 0;
+        return;
+    }
+
+    if (num == mCandidateNum && den == mCandidateDen) {
+        mCandidateCount++;
+    } else {
+        mCandidateNum = num;
+        mCandidateDen = den;
+        mCandidateCount = 1;
+    }
+
+    // report the first estimate at once, later changes only once stable
+    if (mNum <= 0 || mCandidateCount >= STABLE_COUNT) {
+        DTRACE("content frame rate %d/%d", num, den);
+        mNum = num;
+        mDen = den;
+        mCandidateCount = 0;
+    }
+}
+
+void FrameRateEstimator::snapFrameRate(int64_t duration, int frames,
+                                       int32_t *num, int32_t *den) const
+{
+    int64_t milliFps = (int64_t)frames * 1000000000LL / duration;
+
+    // pick the closest standard rate within 1.5%
+    int best = -1;
+    int64_t bestError = milliFps * 15 / 1000;
+    for (int i = 0; i < (int)(sizeof(STANDARD_RATES) / sizeof(STANDARD_RATES[0])); i++) {
+        int64_t error = milliFps - STANDARD_RATES[i].milliFps;
+        if (error < 0) {
+            error = -error;
+        }
+        if (error <= bestError) {
+            bestError = error;
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        *num = STANDARD_RATES[best].num;
+        *den = STANDARD_RATES[best].den;
+    } else {
+        *num = (int32_t)((milliFps + 500) / 1000);
+        *den = 1;
+    }
+}
+
+} // namespace intel
+} // namespace android
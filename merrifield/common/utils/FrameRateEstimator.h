@@ -0,0 +1,70 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef FRAME_RATE_ESTIMATOR_H
+#define FRAME_RATE_ESTIMATOR_H
+
+#include <stdint.h>
+
+namespace android {
+namespace intel {
+
+// estimates content frame rate from media timestamps of decoded frames
+class FrameRateEstimator {
+public:
+    FrameRateEstimator();
+    ~FrameRateEstimator();
+
+public:
+    void reset();
+    // media timestamp of a frame in microseconds
+    void addTimestamp(int64_t timestamp);
+    // returns false until a stable frame rate is available
+    bool getFrameRate(int32_t *num, int32_t *den) const;
+
+private:
+    int64_t getMedianInterval() const;
+    void estimate();
+    void snapFrameRate(int64_t duration, int frames, int32_t *num, int32_t *den) const;
+
+private:
+    enum {
+        // window of frame intervals
+        MAX_INTERVALS = 16,
+        // intervals needed before the first estimate
+        MIN_INTERVALS = 8,
+        // number of estimates a new frame rate must persist for
+        STABLE_COUNT = 8,
+        // longest gap that is counted as dropped frames
+        MAX_DROPPED_FRAMES = 4,
+        // longer gap is a pause or seek
+        MAX_INTERVAL_US = 500000,
+    };
+
+    int64_t mLastTimestamp;
+    int64_t mIntervals[MAX_INTERVALS];
+    int mIntervalCount;
+    int mIntervalIndex;
+    int32_t mNum;
+    int32_t mDen;
+    int32_t mCandidateNum;
+    int32_t mCandidateDen;
+    int mCandidateCount;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* FRAME_RATE_ESTIMATOR_H */
@@ -0,0 +1,71 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/properties.h>
+#include <utils/Timers.h>
+
+#include <HwcTrace.h>
+
+enum {
+    HWC_TRACE_INTERVAL_MS = 1000,
+};
+
+// written by the dump binder thread, read by every thread tracing
+volatile int32_t gHwcTraceLevel = ANDROID_LOG_DEBUG;
+
+void hwcTraceUpdateLevel(void)
+{
+    static const char levels[] = "VDIWES";
+    char prop[PROPERTY_VALUE_MAX];
+
+    if (property_get("hwc.log.level", prop, NULL) <= 0) {
+        return;
+    }
+
+    // a priority letter as used by logcat or its android_LogPriority
+    const char *level = strchr(levels, prop[0]);
+    if (prop[0] && level) {
+        android_atomic_release_store(ANDROID_LOG_VERBOSE + (level - levels),
+                                     &gHwcTraceLevel);
+    } else if (atoi(prop) >= ANDROID_LOG_VERBOSE &&
+               atoi(prop) <= ANDROID_LOG_SILENT) {
+        android_atomic_release_store(atoi(prop), &gHwcTraceLevel);
+    }
+}
+
+int hwcTraceRateLimit(volatile int32_t *last, volatile int32_t *muted)
+{
+    // milliseconds wrap after weeks, intervals are compared modulo 2^32.
+    // 0 means the call site has not logged yet
+    int32_t now = (int32_t)ns2ms(systemTime(SYSTEM_TIME_MONOTONIC));
+    if (!now) {
+        now = 1;
+    }
+
+    int32_t prev = android_atomic_acquire_load(last);
+    if (prev && (uint32_t)(now - prev) < HWC_TRACE_INTERVAL_MS) {
+        android_atomic_inc(muted);
+        return -1;
+    }
+
+    // of threads racing into a new interval only one logs
+    if (android_atomic_cmpxchg(prev, now, last)) {
+        android_atomic_inc(muted);
+        return -1;
+    }
+    return android_atomic_and(0, muted);
+}
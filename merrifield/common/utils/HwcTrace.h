@@ -19,19 +19,58 @@
 #define LOG_TAG "hwcomposer"
 //#define LOG_NDEBUG 0
 #include <cutils/log.h>
+#include <cutils/atomic.h>
+#include <stdint.h>
 
 
-#ifdef _cplusplus
+#ifdef __cplusplus
 extern "C" {
 #endif
+// lowest log priority printed, set from the hwc.log.level property
+extern volatile int32_t gHwcTraceLevel;
+void hwcTraceUpdateLevel(void);
+// -1 while a call site is muted, else the number of messages it muted.
+// last is in milliseconds, both are updated atomically
+int hwcTraceRateLimit(volatile int32_t *last, volatile int32_t *muted);
+#ifdef __cplusplus
+}
+#endif
+
+#define HWC_TRACE_ENABLED(prio)     ((prio) >= android_atomic_acquire_load(&gHwcTraceLevel))
+
+// arguments are not evaluated for a message below the log level
+#define HWC_TRACE(prio, fmt, ...) \
+do { \
+    if (HWC_TRACE_ENABLED(prio)) \
+        LOG_PRI(prio, LOG_TAG, "%s: " fmt, __func__, ##__VA_ARGS__); \
+} while (0)
+
+// for per frame paths, a call site logs at most once per second
+#define HWC_TRACE_LIMITED(prio, fmt, ...) \
+do { \
+    static volatile int32_t hwcTraceLast = 0; \
+    static volatile int32_t hwcTraceMuted = 0; \
+    if (HWC_TRACE_ENABLED(prio)) { \
+        int hwcTraceCount = hwcTraceRateLimit(&hwcTraceLast, &hwcTraceMuted); \
+        if (hwcTraceCount >= 0) { \
+            LOG_PRI(prio, LOG_TAG, "%s: " fmt, __func__, ##__VA_ARGS__); \
+            if (hwcTraceCount) \
+                LOG_PRI(prio, LOG_TAG, "%s: %d similar messages muted", __func__, hwcTraceCount); \
+        } \
+    } \
+} while (0)
 
 // Helper to automatically preappend classname::functionname to the log message
 #define VTRACE(fmt,...)     ALOGV("%s: " fmt, __func__, ##__VA_ARGS__)
-#define DTRACE(fmt,...)     ALOGD("%s: " fmt, __func__, ##__VA_ARGS__)
-#define ITRACE(fmt,...)     ALOGI("%s: " fmt, __func__, ##__VA_ARGS__)
-#define WTRACE(fmt,...)     ALOGW("%s: " fmt, __func__, ##__VA_ARGS__)
+#define DTRACE(fmt,...)     HWC_TRACE(ANDROID_LOG_DEBUG, fmt, ##__VA_ARGS__)
+#define ITRACE(fmt,...)     HWC_TRACE(ANDROID_LOG_INFO, fmt, ##__VA_ARGS__)
+#define WTRACE(fmt,...)     HWC_TRACE(ANDROID_LOG_WARN, fmt, ##__VA_ARGS__)
 #define ETRACE(fmt,...)     ALOGE("%s: " fmt, __func__, ##__VA_ARGS__)
 
+#define DTRACE_LIMITED(fmt,...) HWC_TRACE_LIMITED(ANDROID_LOG_DEBUG, fmt, ##__VA_ARGS__)
+#define ITRACE_LIMITED(fmt,...) HWC_TRACE_LIMITED(ANDROID_LOG_INFO, fmt, ##__VA_ARGS__)
+#define WTRACE_LIMITED(fmt,...) HWC_TRACE_LIMITED(ANDROID_LOG_WARN, fmt, ##__VA_ARGS__)
+
 
 // Function call tracing
 #if 0
@@ -0,0 +1,55 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <PipeGeometry.h>
+
+namespace android {
+namespace intel {
+
+bool PipeGeometry::getPipeSource(int type, int hOverscan, int vOverscan,
+                                 int srcWidth, int srcHeight,
+                                 int modeWidth, int modeHeight,
+                                 int& pipeWidth, int& pipeHeight,
+                                 hwc_rect_t& frame)
+{
+    if (type == SCALING_CENTER) {
+        // panel fitter is off, the image is shown 1:1
+        pipeWidth = modeWidth;
+        pipeHeight = modeHeight;
+    } else {
+        // margins around the image shrink it once the pipe is scaled up
+        pipeWidth = srcWidth * 100 / (100 - hOverscan);
+        pipeHeight = srcHeight * 100 / (100 - vOverscan);
+        if (pipeWidth > modeWidth)
+            pipeWidth = modeWidth;
+        if (pipeHeight > modeHeight)
+            pipeHeight = modeHeight;
+    }
+
+    if (pipeWidth < srcWidth)
+        pipeWidth = srcWidth;
+    if (pipeHeight < srcHeight)
+        pipeHeight = srcHeight;
+
+    frame.left = (pipeWidth - srcWidth) / 2;
+    frame.top = (pipeHeight - srcHeight) / 2;
+    frame.right = frame.left + srcWidth;
+    frame.bottom = frame.top + srcHeight;
+
+    return srcWidth != modeWidth || srcHeight != modeHeight;
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,54 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef PIPE_GEOMETRY_H
+#define PIPE_GEOMETRY_H
+
+#include <hardware/hwcomposer.h>
+
+namespace android {
+namespace intel {
+
+// pipe source the panel fitter scales up to the mode. the fitter can't
+// scale down, so an image as large as the mode is always shown 1:1
+class PipeGeometry {
+public:
+    // how an image smaller than the mode is shown
+    enum {
+        SCALING_ASPECT = 0,
+        SCALING_FULL,
+        SCALING_CENTER,
+    };
+
+    enum {
+        // largest overscan compensation in percent of a dimension
+        MAX_OVERSCAN = 20,
+    };
+
+public:
+    // pipe source to scale a srcWidth x srcHeight image to the mode with,
+    // and the frame of the image within the pipe source. returns false if
+    // the image is shown 1:1 over the whole mode
+    static bool getPipeSource(int type, int hOverscan, int vOverscan,
+                              int srcWidth, int srcHeight,
+                              int modeWidth, int modeHeight,
+                              int& pipeWidth, int& pipeHeight,
+                              hwc_rect_t& frame);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* PIPE_GEOMETRY_H */
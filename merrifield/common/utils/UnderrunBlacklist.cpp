@@ -0,0 +1,201 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <HwcTrace.h>
+#include <UnderrunBlacklist.h>
+
+namespace android {
+namespace intel {
+
+UnderrunBlacklist::UnderrunBlacklist()
+    : mVersion(0)
+{
+}
+
+UnderrunBlacklist::~UnderrunBlacklist()
+{
+}
+
+void UnderrunBlacklist::reset()
+{
+    Mutex::Autolock _l(mLock);
+
+    for (int i = 0; i < IDisplayDevice::DEVICE_COUNT; i++) {
+        mCandidates[i] = PlaneConfig();
+    }
+    mEntries.clear();
+    mVersion++;
+}
+
+int UnderrunBlacklist::getScale(int srcHeight, int dstHeight)
+{
+    // upscaling fetches no more than a 1:1 plane
+    if (dstHeight <= 0 || srcHeight <= dstHeight) {
+        return SCALE_UNIT;
+    }
+    return srcHeight * SCALE_UNIT / dstHeight;
+}
+
+bool UnderrunBlacklist::isSame(const PlaneConfig& a, const PlaneConfig& b)
+{
+    return a.planeType == b.planeType &&
+           a.format == b.format &&
+           a.width == b.width &&
+           a.scale == b.scale;
+}
+
+void UnderrunBlacklist::setCandidate(int disp, const PlaneConfig& config)
+{
+    if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
+        return;
+    }
+
+    Mutex::Autolock _l(mLock);
+    mCandidates[disp] = config;
+}
+
+bool UnderrunBlacklist::addUnderrun(int disp, nsecs_t now)
+{
+    if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
+        return false;
+    }
+
+    Mutex::Autolock _l(mLock);
+
+    const PlaneConfig& candidate = mCandidates[disp];
+    if (candidate.planeType < 0) {
+        WTRACE_LIMITED("underrun on device %d with nothing to move to GLES", disp);
+        return false;
+    }
+
+    ssize_t index = -1;
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        if (isSame(mEntries.itemAt(i).config, candidate)) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index < 0) {
+        if (mEntries.size() >= MAX_ENTRY_COUNT) {
+            // forget the oldest configuration still on probation
+            for (size_t i = 0; i < mEntries.size(); i++) {
+                if (!mEntries.itemAt(i).blacklisted) {
+                    mEntries.removeAt(i);
+                    break;
+                }
+            }
+            if (mEntries.size() >= MAX_ENTRY_COUNT) {
+                WTRACE("underrun blacklist is full");
+                return false;
+            }
+        }
+
+        Entry entry;
+        entry.config = candidate;
+        entry.underruns = 0;
+        entry.lastUnderrun = now;
+        entry.blacklisted = false;
+        index = mEntries.add(entry);
+    }
+
+    Entry& entry = mEntries.editItemAt(index);
+    if (entry.blacklisted) {
+        return false;
+    }
+
+    // a transient underrun long ago does not count
+    if (now - entry.lastUnderrun > ms2ns(UNDERRUN_WINDOW_MS)) {
+        entry.underruns = 0;
+    }
+    entry.underruns++;
+    entry.lastUnderrun = now;
+    if (entry.underruns < UNDERRUN_THRESHOLD) {
+        return false;
+    }
+
+    entry.blacklisted = true;
+    mVersion++;
+    WTRACE("blacklisting plane type %d, format %#x, width %d, scale %d/%d "
+           "after %d underruns on device %d",
+           candidate.planeType, candidate.format, candidate.width,
+           candidate.scale, SCALE_UNIT, entry.underruns, disp);
+    return true;
+}
+
+void UnderrunBlacklist::expire(nsecs_t now)
+{
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i = mEntries.size(); i > 0; i--) {
+        const Entry& entry = mEntries.itemAt(i - 1);
+        nsecs_t age = now - entry.lastUnderrun;
+        if (entry.blacklisted && age > ms2ns(BLACKLIST_DURATION_MS)) {
+            ITRACE("plane type %d, format %#x, width %d, scale %d/%d "
+                   "is no longer blacklisted",
+                   entry.config.planeType, entry.config.format,
+                   entry.config.width, entry.config.scale, SCALE_UNIT);
+            mEntries.removeAt(i - 1);
+            mVersion++;
+        } else if (!entry.blacklisted && age > ms2ns(UNDERRUN_WINDOW_MS)) {
+            mEntries.removeAt(i - 1);
+        }
+    }
+}
+
+bool UnderrunBlacklist::isBlacklisted(const PlaneConfig& config)
+{
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        const Entry& entry = mEntries.itemAt(i);
+        if (entry.blacklisted &&
+            entry.config.planeType == config.planeType &&
+            entry.config.format == config.format &&
+            entry.config.width <= config.width &&
+            entry.config.scale <= config.scale) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t UnderrunBlacklist::getVersion()
+{
+    Mutex::Autolock _l(mLock);
+    return mVersion;
+}
+
+void UnderrunBlacklist::dump(Dump& d)
+{
+    Mutex::Autolock _l(mLock);
+
+    if (mEntries.size() == 0) {
+        return;
+    }
+
+    d.append("  Underrun blacklist:\n");
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        const Entry& entry = mEntries.itemAt(i);
+        d.append("    type %d, format %#x, width %d, scale %d/%d, "
+                 "underruns %d%s\n",
+                 entry.config.planeType, entry.config.format,
+                 entry.config.width, entry.config.scale, SCALE_UNIT,
+                 entry.underruns, entry.blacklisted ? ", blacklisted" : "");
+    }
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,101 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef UNDERRUN_BLACKLIST_H
+#define UNDERRUN_BLACKLIST_H
+
+#include <stdint.h>
+#include <utils/Mutex.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <IDisplayDevice.h>
+#include <Dump.h>
+
+namespace android {
+namespace intel {
+
+// a layer as scanned out by a plane, what its fetch bandwidth depends on
+struct PlaneConfig {
+    PlaneConfig()
+        : planeType(-1), format(0), width(0), scale(0) {}
+
+    int planeType;
+    uint32_t format;
+    // source width in pixels
+    int width;
+    // vertical downscale factor in 1/SCALE_UNIT steps
+    int scale;
+};
+
+// learns plane configurations that underrun a display pipe, so that their
+// layers are composed by GLES instead
+class UnderrunBlacklist {
+public:
+    UnderrunBlacklist();
+    ~UnderrunBlacklist();
+
+public:
+    void reset();
+    static int getScale(int srcHeight, int dstHeight);
+    // costliest configuration on screen of a display that can go to GLES,
+    // a plane type of -1 means there is none
+    void setCandidate(int disp, const PlaneConfig& config);
+    // returns true if the candidate of the display got blacklisted
+    bool addUnderrun(int disp, nsecs_t now);
+    // forgets configurations that did not underrun for a while, so that
+    // they are tried again
+    void expire(nsecs_t now);
+    // true if a blacklisted configuration is not more costly than config
+    bool isBlacklisted(const PlaneConfig& config);
+    // changes each time a configuration is blacklisted or forgotten
+    uint32_t getVersion();
+    void dump(Dump& d);
+
+public:
+    enum {
+        SCALE_UNIT = 4,
+    };
+
+private:
+    static bool isSame(const PlaneConfig& a, const PlaneConfig& b);
+
+private:
+    enum {
+        // underruns before a configuration is blacklisted
+        UNDERRUN_THRESHOLD = 2,
+        // longest gap between underruns counted together
+        UNDERRUN_WINDOW_MS = 1000,
+        // time a configuration stays blacklisted
+        BLACKLIST_DURATION_MS = 60000,
+        MAX_ENTRY_COUNT = 8,
+    };
+
+    struct Entry {
+        PlaneConfig config;
+        int underruns;
+        nsecs_t lastUnderrun;
+        bool blacklisted;
+    };
+
+    Mutex mLock;
+    PlaneConfig mCandidates[IDisplayDevice::DEVICE_COUNT];
+    Vector<Entry> mEntries;
+    uint32_t mVersion;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* UNDERRUN_BLACKLIST_H */
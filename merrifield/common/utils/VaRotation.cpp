@@ -0,0 +1,72 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <hardware/hwcomposer.h>
+#include <va/va.h>
+#include <va/va_vpp.h>
+#include <VaRotation.h>
+
+namespace android {
+namespace intel {
+
+uint32_t VaRotation::fromHalTransform(uint32_t transform)
+{
+    if (transform == HAL_TRANSFORM_ROT_90)
+        return VA_ROTATION_90;
+    if (transform == HAL_TRANSFORM_ROT_180)
+        return VA_ROTATION_180;
+    if (transform == HAL_TRANSFORM_ROT_270)
+        return VA_ROTATION_270;
+    return VA_ROTATION_NONE;
+}
+
+bool VaRotation::isSwapped(uint32_t transform)
+{
+    return transform == HAL_TRANSFORM_ROT_90 || transform == HAL_TRANSFORM_ROT_270;
+}
+
+bool VaRotation::isRotation(uint32_t transform)
+{
+    return transform == 0 ||
+           transform == HAL_TRANSFORM_ROT_90 ||
+           transform == HAL_TRANSFORM_ROT_180 ||
+           transform == HAL_TRANSFORM_ROT_270;
+}
+
+void VaRotation::getRegions(uint32_t transform, int x, int y, int width, int height,
+                            VARectangle *surface, VARectangle *output)
+{
+    surface->x = x;
+    surface->y = y;
+    surface->width = width;
+    surface->height = height;
+
+    output->x = 0;
+    output->y = 0;
+    output->width = isSwapped(transform) ? height : width;
+    output->height = isSwapped(transform) ? width : height;
+}
+
+bool VaRotation::isSupported(uint32_t rotationFlags, uint32_t rotation)
+{
+    // no rotation needs no support
+    if (rotation == VA_ROTATION_NONE) {
+        return true;
+    }
+    return (rotationFlags & (1 << rotation)) != 0;
+}
+
+} // namespace intel
+} // namespace android
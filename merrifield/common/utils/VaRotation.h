@@ -0,0 +1,48 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef VA_ROTATION_H
+#define VA_ROTATION_H
+
+#include <stdint.h>
+#include <va/va.h>
+
+namespace android {
+namespace intel {
+
+// maps HAL transforms to VA post processing rotations
+class VaRotation
+{
+public:
+    // VA_ROTATION_xxx of a HAL transform, both rotate clockwise.
+    // flips have no VA rotation and map to VA_ROTATION_NONE
+    static uint32_t fromHalTransform(uint32_t transform);
+    // true if 90 or 270 degrees, the output has width and height swapped
+    static bool isSwapped(uint32_t transform);
+    // true for no transform and plain 90, 180 or 270 degrees rotations,
+    // combinations with flips can't be done by VSP
+    static bool isRotation(uint32_t transform);
+    // regions of a rotating blit of a width x height crop at (x, y),
+    // the output is rotated to the top left corner of the target
+    static void getRegions(uint32_t transform, int x, int y, int width, int height,
+                           VARectangle *surface, VARectangle *output);
+    // check a rotation against VAProcPipelineCaps::rotation_flags
+    static bool isSupported(uint32_t rotationFlags, uint32_t rotation);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* VA_ROTATION_H */
@@ -16,6 +16,7 @@
 #ifndef BUFFERMAPPER_H__
 #define BUFFERMAPPER_H__
 
+#include <cutils/atomic.h>
 #include <DataBuffer.h>
 
 namespace android {
@@ -30,15 +31,14 @@ public:
     }
     virtual ~BufferMapper() {}
 public:
+    // mappers may be released from the deferred work thread
     int incRef()
     {
-        mRefCount++;
-        return mRefCount;
+        return android_atomic_inc(&mRefCount) + 1;
     }
     int decRef()
     {
-        mRefCount--;
-        return mRefCount;
+        return android_atomic_dec(&mRefCount) - 1;
     }
 
     int getRef() const
@@ -59,7 +59,7 @@ public:
     virtual buffer_handle_t getFbHandle(int subIndex) = 0;
     virtual void putFbHandle() = 0;
 private:
-    int mRefCount;
+    volatile int32_t mRefCount;
 };
 
 } // namespace intel
@@ -87,6 +87,8 @@ public:
 
     // data source
     virtual bool setDataBuffer(buffer_handle_t handle);
+    // false if the current buffer is known to hold the frame last shown
+    virtual bool isContentUpdated() { return true; }
     virtual void resetCurrentBuffer();
     virtual void invalidateBufferCache();
 
@@ -109,6 +111,9 @@ public:
     virtual void setZOrder(int zorder);
     virtual int getZOrder() const;
 
+    // peak memory fetch bandwidth of the current buffer in MB/s
+    virtual uint32_t getFetchBandwidth() const;
+
     virtual void* getContext() const = 0;
 
     virtual bool initialize(uint32_t bufferCount);
@@ -19,6 +19,7 @@
 #include <Dump.h>
 #include <DisplayPlane.h>
 #include <HwcLayer.h>
+#include <UnderrunBlacklist.h>
 #include <utils/Vector.h>
 
 namespace android {
@@ -71,6 +72,20 @@ public:
     virtual void reclaimPlane(int dsp, DisplayPlane& plane);
     virtual void disableReclaimedPlanes();
     virtual bool isOverlayPlanesDisabled();
+    // sum up fetch bandwidth of planes in use after a commit
+    virtual void updateBandwidth();
+    // fetch bandwidth of planes in use at the last commit in MB/s
+    uint32_t getBandwidth() const { return mBandwidth; }
+    // bandwidth planes may use before trading quality for it in MB/s
+    uint32_t getBandwidthBudget() const { return mBandwidthBudget; }
+    // plane configurations learned to underrun a pipe
+    void setUnderrunCandidate(int dsp, const PlaneConfig& config);
+    bool isUnderrunBlacklistEnabled() const { return mUnderrunBlacklistEnabled; }
+    // returns true if a configuration of the display got blacklisted
+    bool reportUnderrun(int dsp);
+    bool isBlacklisted(const PlaneConfig& config);
+    // changes when a configuration is blacklisted or forgotten
+    uint32_t getBlacklistVersion();
     // dump interface
     virtual void dump(Dump& d);
 
@@ -99,10 +114,18 @@ protected:
     uint32_t mFreePlanes[DisplayPlane::PLANE_MAX];
     uint32_t mReclaimedPlanes[DisplayPlane::PLANE_MAX];
 
+    // memory fetch bandwidth
+    uint32_t mBandwidth;
+    uint32_t mBandwidthBudget;
+
+    UnderrunBlacklist mUnderrunBlacklist;
+    bool mUnderrunBlacklistEnabled;
+
     bool mInitialized;
 
 enum {
-    DEFAULT_PRIMARY_PLANE_COUNT = 3
+    DEFAULT_PRIMARY_PLANE_COUNT = 3,
+    DEFAULT_BANDWIDTH_BUDGET = 1600,
 };
 };
 
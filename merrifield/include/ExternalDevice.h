@@ -19,29 +19,40 @@
 #include <PhysicalDevice.h>
 #include <IHdcpControl.h>
 #include <SimpleThread.h>
+#include <PipeGeometry.h>
 
 namespace android {
 namespace intel {
 
 
 class ExternalDevice : public PhysicalDevice {
-
 public:
     ExternalDevice(Hwcomposer& hwc, DeviceControlFactory* controlFactory);
     virtual ~ExternalDevice();
 public:
     virtual bool initialize();
     virtual void deinitialize();
+    virtual bool prepare(hwc_display_contents_1_t *display);
+    virtual bool commit(hwc_display_contents_1_t *display, IDisplayContext *context);
     virtual bool setDrmMode(drmModeModeInfo& value);
     virtual void setRefreshRate(int hz);
     virtual int  getActiveConfig();
     virtual bool setActiveConfig(int index);
     int getRefreshRate();
+    // one of PipeGeometry::SCALING_*, false if the image fills the
+    // mode and only the default can apply
+    bool setScalingType(int type);
+    // shrink the image by the given percent of each dimension, false if
+    // the image fills the mode and can't be shrunk
+    bool setOverscan(int hPercent, int vPercent);
 
 private:
     static void HdcpLinkStatusListener(bool success, void *userData);
     void HdcpLinkStatusListener(bool success);
     void setDrmMode();
+    void updatePipeGeometry(hwc_display_contents_1_t *display);
+    void updatePipeSource(hwc_display_contents_1_t *display);
+    void offsetCloneTarget(hwc_display_contents_1_t *display);
 protected:
     IHdcpControl *mHdcpControl;
 
@@ -54,6 +65,23 @@ private:
     drmModeModeInfo mPendingDrmMode;
     bool mHotplugEventPending;
     int mExpectedRefreshRate;
+    // pipe source size while the image is scaled, 0 if native
+    int mPipeSourceWidth;
+    int mPipeSourceHeight;
+    // frame of the cloned image within the pipe source
+    hwc_rect_t mCloneFrame;
+    int mScalingType;
+    int mOverscanH;
+    int mOverscanV;
+    bool mScalingChanged;
+    // image posted last is smaller than the mode, so the panel fitter
+    // can apply scaling type and overscan to it
+    bool mImageScalable;
+    // pipe source computed in prepare, programmed at commit
+    int mPendingPipeWidth;
+    int mPendingPipeHeight;
+    bool mPendingKeepAspect;
+    bool mPipeSourceDirty;
 
 private:
     DECLARE_THREAD(ModeSettingThread, ExternalDevice);
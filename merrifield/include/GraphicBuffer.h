@@ -28,6 +28,16 @@ public:
         USAGE_INVALID = 0xffffffff,
     };
 
+    // gralloc vendor formats: 0x100 | index, with the framebuffer
+    // compression mode in bits [4-6] and memory layout in bit 7
+    enum {
+        VENDOR_FORMAT_BASE = 0x100,
+        VENDOR_FORMAT_INDEX_MASK = 0xf,
+        VENDOR_FORMAT_COMPRESSION_MASK = 0x70,
+        VENDOR_FORMAT_COMPRESSION_SHIFT = 4,
+        VENDOR_FORMAT_TWIDDLED = 0x80,
+    };
+
 public:
     GraphicBuffer(buffer_handle_t handle);
     virtual ~GraphicBuffer() {}
@@ -41,7 +51,14 @@ public:
     static bool isProtectedBuffer(GraphicBuffer *buffer);
 
     static bool isCompressionUsage(uint32_t usage);
+    static bool isCompressionFormat(uint32_t format);
     static bool isCompressionBuffer(GraphicBuffer *buffer);
+    // compression layout the display controller can fetch
+    static bool isScanoutCompressionFormat(uint32_t format);
+    static bool isScanoutCompressionBuffer(GraphicBuffer *buffer);
+
+    // strip gralloc compression and memory layout bits off a vendor format
+    static uint32_t getBaseFormat(uint32_t format);
 
 private:
     void initBuffer(buffer_handle_t handle);
@@ -49,6 +66,8 @@ private:
 protected:
     uint32_t mUsage;
     uint32_t mBpp;
+    // format as allocated by gralloc, including compression bits
+    uint32_t mGrallocFormat;
 };
 
 } // namespace intel
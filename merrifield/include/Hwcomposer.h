@@ -27,6 +27,8 @@
 #include <DisplayPlaneManager.h>
 #include <DisplayAnalyzer.h>
 #include <VsyncManager.h>
+#include <GpuBoostManager.h>
+#include <DeferredWorkQueue.h>
 #include <MultiDisplayObserver.h>
 #include <UeventObserver.h>
 #include <IPlatFactory.h>
@@ -81,6 +83,8 @@ public:
     IDisplayContext* getDisplayContext();
     DisplayAnalyzer* getDisplayAnalyzer();
     VsyncManager* getVsyncManager();
+    GpuBoostManager* getGpuBoostManager();
+    DeferredWorkQueue* getDeferredWorkQueue();
     MultiDisplayObserver* getMultiDisplayObserver();
     IDisplayDevice* getDisplayDevice(int disp);
     UeventObserver* getUeventObserver();
@@ -120,6 +124,8 @@ private:
     DisplayPlaneManager *mPlaneManager;
     BufferManager *mBufferManager;
     IDisplayContext *mDisplayContext;
+    GpuBoostManager *mGpuBoostManager;
+    DeferredWorkQueue *mDeferredWorkQueue;
 
     Vector<IDisplayDevice*> mDisplayDevices;
 
@@ -0,0 +1,36 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef IGPUBOOSTCONTROL_H_
+#define IGPUBOOSTCONTROL_H_
+
+namespace android {
+namespace intel {
+
+class IGpuBoostControl {
+public:
+    IGpuBoostControl() {}
+    virtual ~IGpuBoostControl() {}
+public:
+    virtual bool initialize() = 0;
+    virtual void deinitialize() = 0;
+    // raise or drop the GPU frequency floor
+    virtual bool boost(bool enable) = 0;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* IGPUBOOSTCONTROL_H_ */
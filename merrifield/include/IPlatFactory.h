@@ -22,6 +22,7 @@
 #include <IDisplayContext.h>
 #include <DisplayPlaneManager.h>
 #include <IVideoPayloadManager.h>
+#include <IGpuBoostControl.h>
 
 
 namespace android {
@@ -38,6 +39,7 @@ public:
     virtual IDisplayDevice* createDisplayDevice(int disp) = 0;
     virtual IDisplayContext* createDisplayContext() = 0;
     virtual IVideoPayloadManager* createVideoPayloadManager() = 0;
+    virtual IGpuBoostControl* createGpuBoostControl() = 0;
 };
 } // namespace intel
 } // namespace android
@@ -22,6 +22,7 @@
 #include <IPrepareListener.h>
 #include <VsyncEventObserver.h>
 #include <HwcLayerList.h>
+#include <AnimationDetector.h>
 #include <Drm.h>
 #include <IDisplayDevice.h>
 
@@ -87,6 +88,7 @@ protected:
     void onGeometryChanged(hwc_display_contents_1_t *list);
     bool updateDisplayConfigs();
     IVsyncControl* createVsyncControl() {return mControlFactory->createVsyncControl();}
+    void checkUnderrun();
     friend class VsyncEventObserver;
 
 protected:
@@ -110,6 +112,11 @@ protected:
     bool mConnected;
     bool mBlank;
 
+    AnimationDetector mAnimationDetector;
+
+    // blacklist version the layer list was planned with
+    uint32_t mBlacklistVersion;
+
     // lock
     Mutex mLock;
 
@@ -19,6 +19,7 @@
 #include <IDisplayDevice.h>
 #include <SimpleThread.h>
 #include <IVideoPayloadManager.h>
+#include <FrameRateEstimator.h>
 #include <utils/Condition.h>
 #include <utils/Mutex.h>
 #include <utils/Vector.h>
@@ -128,6 +129,7 @@ protected:
     FrameInfo mLastOutputFrameInfo;
 #endif
     int32_t mVideoFramerate;
+    FrameRateEstimator mFrameRateEstimator;
 
     android::KeyedVector<buffer_handle_t, android::sp<CachedBuffer> > mMappedBufferCache;
     android::Mutex mHeldBuffersLock;
@@ -143,6 +145,8 @@ protected:
     VAContextID va_context;
     VASurfaceID va_blank_yuv_in;
     VASurfaceID va_blank_rgb_in;
+    // VAProcPipelineCaps::rotation_flags of the VSP context
+    uint32_t mVspRotationFlags;
     android::KeyedVector<buffer_handle_t, android::sp<VAMappedHandleObject> > mVaMapCache;
 
     bool mVspUpscale;
@@ -167,7 +171,8 @@ private:
     void vspEnable(uint32_t width, uint32_t height);
     void vspDisable();
     void vspCompose(VASurfaceID videoIn, VASurfaceID rgbIn, VASurfaceID videoOut,
-                    const VARectangle* surface_region, const VARectangle* output_region);
+                    const VARectangle* surface_region, const VARectangle* output_region,
+                    uint32_t rotation = VA_ROTATION_NONE);
 
     bool getFrameOfSize(uint32_t width, uint32_t height, const IVideoPayloadManager::MetaData& metadata, IVideoPayloadManager::Buffer& info);
     void setMaxDecodeResolution(uint32_t width, uint32_t height);
@@ -33,10 +33,16 @@ AnnOverlayPlane::AnnOverlayPlane(int index, int disp)
       mRotationBufProvider(NULL),
       mRotationConfig(0),
       mZOrderConfig(0),
-      mUseOverlayRotation(true)
+      mUseOverlayRotation(true),
+      mRepostBackBuffer(false),
+      mPostedTransform(0),
+      mPostedPlaneAlpha(0)
 {
     CTRACE();
 
+    memset(&mPostedPosition, 0, sizeof(mPostedPosition));
+    memset(&mPostedCrop, 0, sizeof(mPostedCrop));
+
     memset(&mContext, 0, sizeof(mContext));
 }
 
@@ -74,6 +80,7 @@ void AnnOverlayPlane::setZOrderConfig(ZOrderConfig& zorderConfig,
 bool AnnOverlayPlane::reset()
 {
     OverlayPlaneBase::reset();
+    mRepostBackBuffer = false;
     if (mRotationBufProvider) {
         mRotationBufProvider->reset();
     }
@@ -129,6 +136,30 @@ void AnnOverlayPlane::postFlip()
     //DisplayPlane::postFlip();
 }
 
+bool AnnOverlayPlane::isPostedGeometry() const
+{
+    return !memcmp(&mPosition, &mPostedPosition, sizeof(mPosition)) &&
+           !memcmp(&mSrcCrop, &mPostedCrop, sizeof(mSrcCrop)) &&
+           mTransform == mPostedTransform &&
+           mPlaneAlpha == mPostedPlaneAlpha;
+}
+
+bool AnnOverlayPlane::setDataBuffer(buffer_handle_t handle)
+{
+    // update masks are never reset on this plane, so they cannot tell a
+    // static frame. only skip reprogramming when the payload proves the
+    // decoder has not touched the buffer shown last time
+    mRepostBackBuffer = handle &&
+                        handle == mCurrentDataBuffer &&
+                        !isContentUpdated() &&
+                        isPostedGeometry();
+    if (mRepostBackBuffer) {
+        return true;
+    }
+
+    return OverlayPlaneBase::setDataBuffer(handle);
+}
+
 
 void AnnOverlayPlane::resetBackBuffer(int buf)
 {
@@ -360,7 +391,7 @@ bool AnnOverlayPlane::scalingSetup(BufferMapper& mapper)
     uint32_t dstWidth = w;
     uint32_t dstHeight = h;
 
-    if (mBobDeinterlace && !mTransform)
+    if (isFieldFetch())
         deinterlace_factor = 2;
 
     VTRACE("src (%dx%d), dst (%dx%d), transform %d",
@@ -570,8 +601,24 @@ bool AnnOverlayPlane::flip(void *ctx)
         return false;
     }
 
+    // show the newest decoded frame rather than the one seen in prepare,
+    // it is programmed into the current back buffer
+    if (latchVideoFrame()) {
+        mRepostBackBuffer = false;
+    }
+
+    // the payload is unchanged, re-post the back buffer programmed last
+    // time instead of the unwritten current one
+    int current = mCurrent;
+    if (mRepostBackBuffer) {
+        current = (mCurrent + OVERLAY_BACK_BUFFER_COUNT - 1) %
+                  OVERLAY_BACK_BUFFER_COUNT;
+    }
+
+    writeBackBuffer(current);
+
     // update back buffer address
-    ovadd = (mBackBuffer[mCurrent]->gttOffsetInPage << 12);
+    ovadd = (mBackBuffer[current]->gttOffsetInPage << 12);
 
     // enable rotation mode and setup rotation config
     // if video is interlaced, cannot use overlay rotation
@@ -597,7 +644,10 @@ bool AnnOverlayPlane::flip(void *ctx)
     mContext.ctx.ov_ctx.ovadd |= mPipeConfig;
 
     // move to next back buffer
-    mCurrent = (mCurrent + 1) % OVERLAY_BACK_BUFFER_COUNT;
+    if (!mRepostBackBuffer) {
+        mCurrent = (mCurrent + 1) % OVERLAY_BACK_BUFFER_COUNT;
+    }
+    mRepostBackBuffer = false;
 
     VTRACE("ovadd = %#x, index = %d, device = %d",
           mContext.ctx.ov_ctx.ovadd,
@@ -630,6 +680,11 @@ bool AnnOverlayPlane::setDataBuffer(BufferMapper& mapper)
 
     mContext.gtt_key = (unsigned long)mapper.getCpuAddress(0);
 
+    mPostedPosition = mPosition;
+    mPostedCrop = mSrcCrop;
+    mPostedTransform = mTransform;
+    mPostedPlaneAlpha = mPlaneAlpha;
+
     return true;
 }
 
@@ -812,6 +867,9 @@ bool AnnOverlayPlane::flush(uint32_t flags)
     else if (flags & PLANE_ENABLE)
         arg.plane_enable_mask = 1;
 
+    // enable, disable and z order change every back buffer
+    writeBackBuffers();
+
     arg.plane.type = DC_OVERLAY_PLANE;
     arg.plane.index = mIndex;
     arg.plane.ctx = mContext.ctx.ov_ctx.ovadd;
@@ -38,6 +38,7 @@ public:
     // plane operations
     virtual bool flip(void *ctx);
     virtual bool reset();
+    virtual bool setDataBuffer(buffer_handle_t handle);
     virtual bool enable();
     virtual bool disable();
     virtual void postFlip();
@@ -51,6 +52,7 @@ public:
 private:
     void signalVideoRotation(BufferMapper& mapper);
     bool isSettingRotBitAllowed();
+    bool isPostedGeometry() const;
 
 protected:
     virtual bool setDataBuffer(BufferMapper& mapper);
@@ -67,6 +69,14 @@ protected:
     // z order config
     uint32_t mZOrderConfig;
     bool mUseOverlayRotation;
+    // payload of the current buffer is the frame already on screen,
+    // flip re-posts the last programmed back buffer
+    bool mRepostBackBuffer;
+    // geometry of the last programmed back buffer
+    PlanePosition mPostedPosition;
+    crop_t mPostedCrop;
+    int mPostedTransform;
+    uint8_t mPostedPlaneAlpha;
     // hardware context
     struct intel_dc_plane_ctx mContext;
 };
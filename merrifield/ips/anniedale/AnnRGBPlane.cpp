@@ -19,6 +19,7 @@
 #include <anniedale/AnnRGBPlane.h>
 #include <tangier/TngGrallocBuffer.h>
 #include <common/PixelFormat.h>
+#include <common/RgbSurfaceLayout.h>
 
 namespace android {
 namespace intel {
@@ -59,8 +60,7 @@ void AnnRGBPlane::setZOrderConfig(ZOrderConfig& config, void *nativeConfig)
 bool AnnRGBPlane::setDataBuffer(buffer_handle_t handle)
 {
     if (!handle) {
-        setFramebufferTarget(handle);
-        return true;
+        return setFramebufferTarget(handle);
     }
 
     TngGrallocBuffer tmpBuf(handle);
@@ -71,8 +71,7 @@ bool AnnRGBPlane::setDataBuffer(buffer_handle_t handle)
 
     usage = tmpBuf.getUsage();
     if (GRALLOC_USAGE_HW_FB & usage) {
-        setFramebufferTarget(handle);
-        return true;
+        return setFramebufferTarget(handle);
     }
 
     // use primary as a sprite
@@ -88,12 +87,11 @@ bool AnnRGBPlane::setDataBuffer(buffer_handle_t handle)
 bool AnnRGBPlane::setDataBuffer(BufferMapper& mapper)
 {
     int bpp;
-    int srcX, srcY, srcW, srcH;
     int dstX, dstY, dstW, dstH;
     uint32_t spriteFormat;
-    uint32_t stride;
-    uint32_t linoff;
     uint32_t planeAlpha;
+    RgbSurfaceLayout::Offsets offsets;
+    bool ret;
     drmModeModeInfoPtr mode = &mModeInfo;
 
     CTRACE();
@@ -113,20 +111,16 @@ bool AnnRGBPlane::setDataBuffer(BufferMapper& mapper)
     }
 
     // setup stride and source buffer crop
-    srcX = mapper.getCrop().x;
-    srcY = mapper.getCrop().y;
-    srcW = mapper.getWidth();
-    srcH = mapper.getHeight();
-    stride = mapper.getStride().rgb.stride;
-
-    if (mPanelOrientation == PANEL_ORIENTATION_180)
-        linoff = srcY * stride + srcX * bpp + (mapper.getCrop().h  - 1) * stride + (mapper.getCrop().w - 1) * bpp;
-    else
-        linoff = srcY * stride + srcX * bpp;
-
-    // unlikely happen, but still we need make sure linoff is valid
-    if (linoff > (stride * mapper.getHeight())) {
-        ETRACE("invalid source crop");
+    if (mapper.isCompression()) {
+        ret = RgbSurfaceLayout::getTiled(mapper.getCrop(),
+                mapper.getWidth(), mapper.getHeight(),
+                mPanelOrientation == PANEL_ORIENTATION_180, offsets);
+    } else {
+        ret = RgbSurfaceLayout::getLinear(mapper.getCrop(), mapper.getHeight(),
+                mapper.getStride().rgb.stride, bpp,
+                mPanelOrientation == PANEL_ORIENTATION_180, offsets);
+    }
+    if (ret == false) {
         return false;
     }
 
@@ -137,7 +131,7 @@ bool AnnRGBPlane::setDataBuffer(BufferMapper& mapper)
         mContext.type = DC_PRIMARY_PLANE;
 
     // setup plane alpha
-    if (0 < mPlaneAlpha && mPlaneAlpha < 0xff) {
+    if (mPlaneAlpha < 0xff) {
        planeAlpha = mPlaneAlpha | 0x80000000;
     } else {
        // disable plane alpha to offload HW
@@ -147,8 +141,9 @@ bool AnnRGBPlane::setDataBuffer(BufferMapper& mapper)
     mContext.ctx.sp_ctx.index = mIndex;
     mContext.ctx.sp_ctx.pipe = mDevice;
     mContext.ctx.sp_ctx.cntr = spriteFormat | 0x80000000;
-    mContext.ctx.sp_ctx.linoff = linoff;
-    mContext.ctx.sp_ctx.stride = stride;
+    mContext.ctx.sp_ctx.linoff = offsets.linoff;
+    mContext.ctx.sp_ctx.stride = offsets.stride;
+    mContext.ctx.sp_ctx.tileoff = offsets.tileoff;
 
     // turn off premultipled alpha blending for HWC_BLENDING_COVERAGE
     if (mBlending == HWC_BLENDING_COVERAGE) {
@@ -158,12 +153,8 @@ bool AnnRGBPlane::setDataBuffer(BufferMapper& mapper)
     if (mPanelOrientation == PANEL_ORIENTATION_180)
         mContext.ctx.sp_ctx.cntr |= (0x1 << 15);
 
-    if (mapper.isCompression()) {
-        mContext.ctx.sp_ctx.stride = align_to(srcW, 32) * 4;
-        mContext.ctx.sp_ctx.linoff = (align_to(srcW, 32) * srcH / 64) - 1;
-        mContext.ctx.sp_ctx.tileoff = (srcY & 0xfff) << 16 | (srcX & 0xfff);
+    if (mapper.isCompression())
         mContext.ctx.sp_ctx.cntr |= (0x1 << 11);
-    }
 
     mContext.ctx.sp_ctx.surf = mapper.getGttOffsetInPage(0) << 12;
     mContext.gtt_key = (uint64_t)mapper.getCpuAddress(0);
@@ -258,10 +249,14 @@ void AnnRGBPlane::postFlip()
     // skipping flip may cause flicking
 }
 
-void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
+bool AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
 {
     uint32_t stride;
     uint32_t planeAlpha;
+    bool isCompression = false;
+    crop_t crop;
+    RgbSurfaceLayout::Offsets offsets;
+    bool ret;
 
     CTRACE();
 
@@ -273,7 +268,7 @@ void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
 
     // if no update then do Not need set data buffer
     if (!mUpdateMasks)
-        return;
+        return true;
 
     // don't need to map data buffer for primary plane
     if (mType == PLANE_SPRITE)
@@ -283,7 +278,31 @@ void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
 
     stride = align_to((4 * align_to(mPosition.w, 32)), 64);
 
-    if (0 < mPlaneAlpha && mPlaneAlpha < 0xff) {
+    if (handle) {
+        TngGrallocBuffer tmpBuf(handle);
+        isCompression = GraphicBuffer::isCompressionBuffer(&tmpBuf);
+        if (isCompression && !GraphicBuffer::isScanoutCompressionBuffer(&tmpBuf)) {
+            WTRACE_LIMITED("compression layout of framebuffer target is not supported");
+            return false;
+        }
+    }
+
+    crop.x = 0;
+    crop.y = 0;
+    crop.w = mPosition.w;
+    crop.h = mPosition.h;
+    if (isCompression) {
+        ret = RgbSurfaceLayout::getTiled(crop, mPosition.w, mPosition.h,
+                mPanelOrientation == PANEL_ORIENTATION_180, offsets);
+    } else {
+        ret = RgbSurfaceLayout::getLinear(crop, mPosition.h, stride, 4,
+                mPanelOrientation == PANEL_ORIENTATION_180, offsets);
+    }
+    if (ret == false) {
+        return false;
+    }
+
+    if (mPlaneAlpha < 0xff) {
        planeAlpha = mPlaneAlpha | 0x80000000;
     } else {
        // disable plane alpha to offload HW
@@ -295,13 +314,9 @@ void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
     mContext.ctx.prim_ctx.index = mIndex;
     mContext.ctx.prim_ctx.pipe = mDevice;
 
-    if (mPanelOrientation == PANEL_ORIENTATION_180)
-        mContext.ctx.prim_ctx.linoff = (mPosition.h  - 1) * stride + (mPosition.w - 1) * 4;
-    else
-        mContext.ctx.prim_ctx.linoff = 0;
-
-    mContext.ctx.prim_ctx.stride = stride;
-    mContext.ctx.prim_ctx.tileoff = 0;
+    mContext.ctx.prim_ctx.linoff = offsets.linoff;
+    mContext.ctx.prim_ctx.stride = offsets.stride;
+    mContext.ctx.prim_ctx.tileoff = offsets.tileoff;
     mContext.ctx.prim_ctx.pos = 0;
     mContext.ctx.prim_ctx.size =
         ((mPosition.h - 1) & 0xfff) << 16 | ((mPosition.w - 1) & 0xfff);
@@ -318,6 +333,9 @@ void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
     if (mPanelOrientation == PANEL_ORIENTATION_180)
         mContext.ctx.prim_ctx.cntr |= (0x1 << 15);
 
+    if (isCompression)
+        mContext.ctx.prim_ctx.cntr |= (0x1 << 11);
+
     VTRACE("type = %d, index = %d, cntr = %#x, linoff = %#x, stride = %#x,"
           "surf = %#x, pos = %#x, size = %#x, contalpa = %#x", mType, mIndex,
           mContext.ctx.prim_ctx.cntr,
@@ -329,6 +347,7 @@ void AnnRGBPlane::setFramebufferTarget(buffer_handle_t handle)
           mContext.ctx.sp_ctx.contalpa);
 
     mCurrentDataBuffer = handle;
+    return true;
 }
 
 } // namespace intel
@@ -46,7 +46,7 @@ protected:
     bool setDataBuffer(BufferMapper& mapper);
     bool enablePlane(bool enabled);
 private:
-    void setFramebufferTarget(buffer_handle_t handle);
+    bool setFramebufferTarget(buffer_handle_t handle);
 protected:
     struct intel_dc_plane_ctx mContext;
 };
@@ -59,7 +59,7 @@ bool PlaneCapabilities::isFormatSupported(int planeType, HwcLayer *hwcLayer)
         case HAL_PIXEL_FORMAT_UYVY:
             // TODO: overlay supports 180 degree rotation
             if (trans == HAL_TRANSFORM_ROT_180) {
-                WTRACE("180 degree rotation is not supported yet");
+                WTRACE_LIMITED("180 degree rotation is not supported yet");
             }
             return trans ? false : true;
         case HAL_PIXEL_FORMAT_YV12:
@@ -95,7 +95,28 @@ bool PlaneCapabilities::isSizeSupported(int planeType, HwcLayer *hwcLayer)
         case HAL_PIXEL_FORMAT_RGBX_8888:
         case HAL_PIXEL_FORMAT_RGB_565:
             VTRACE("stride %d", stride.rgb.stride);
-            if (stride.rgb.stride > SPRITE_PLANE_MAX_STRIDE_LINEAR) {
+            if (hwcLayer->isCompressed()) {
+                // compressed surfaces are fetched in 32-pixel wide tiles
+                // of 32-bit pixels only
+                if (!hwcLayer->isScanoutCompressed()) {
+                    VTRACE("compression layout is not supported");
+                    return false;
+                }
+                if (format == HAL_PIXEL_FORMAT_RGB_565) {
+                    VTRACE("compressed RGB565 is not supported");
+                    return false;
+                }
+                // tiled start of a backwards fetch is not known
+                if (Hwcomposer::getInstance().getDrm()->getPanelOrientation(
+                        IDisplayDevice::DEVICE_PRIMARY) == PANEL_ORIENTATION_180) {
+                    VTRACE("compression on a 180 degree panel is not supported");
+                    return false;
+                }
+                maxStride = SPRITE_PLANE_MAX_STRIDE_TILED;
+            } else {
+                maxStride = SPRITE_PLANE_MAX_STRIDE_LINEAR;
+            }
+            if (stride.rgb.stride > maxStride) {
                 VTRACE("too large stride %d", stride.rgb.stride);
                 return false;
             }
@@ -137,13 +158,13 @@ bool PlaneCapabilities::isSizeSupported(int planeType, HwcLayer *hwcLayer)
         uint32_t height = srcCrop.bottom - srcCrop.top;
 
         if (width <= 64 || height <= 64) {
-            DTRACE("width or height of source crop is less than 64, fallback to GLES");
+            DTRACE_LIMITED("width or height of source crop is less than 64, fallback to GLES");
             return false;
         }
 
         if ((height & 0x1) || (width & 0x1)){
             if (!hwcLayer->isProtected()) {
-                 DTRACE("unprotected video content, height or width of source crop is not even, fallback to GLES ");
+                 DTRACE_LIMITED("unprotected video content, height or width of source crop is not even, fallback to GLES ");
                  return false;
             }
         }
@@ -173,8 +194,16 @@ bool PlaneCapabilities::isBlendingSupported(int planeType, HwcLayer *hwcLayer)
             return false;
         }
     } else if (planeType == DisplayPlane::PLANE_OVERLAY) {
-        // overlay doesn't support blending
-        return (blending == HWC_BLENDING_NONE) ? true : false;
+        // overlay formats have no per-pixel alpha, only constant alpha
+        switch (blending) {
+        case HWC_BLENDING_NONE:
+        case HWC_BLENDING_PREMULT:
+        case HWC_BLENDING_COVERAGE:
+            return true;
+        default:
+            VTRACE("unsupported blending %#x, plane alpha %d", blending, planeAlpha);
+            return false;
+        }
     } else {
         ETRACE("invalid plane type %d", planeType);
         return false;
@@ -207,7 +236,7 @@ bool PlaneCapabilities::isScalingSupported(int planeType, HwcLayer *hwcLayer)
                 format == OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar_Tiled) {
                 // will fall back to GLES if no scaling buffer provided by ved later
                 // so don't return false and print a warning, it's for video format only.
-                WTRACE("source size %dx%d hit overlay resolution limitation.", srcW, srcH);
+                WTRACE_LIMITED("source size %dx%d hit overlay resolution limitation.", srcW, srcH);
             } else {
                 return false;
             }
@@ -215,7 +244,7 @@ bool PlaneCapabilities::isScalingSupported(int planeType, HwcLayer *hwcLayer)
 
         if (dstW <= 100 || dstH <= 1 || srcW <= 100 || srcH <= 1) {
             // Workaround: Overlay flip when height is 1 causes MIPI stall on TNG
-            DTRACE("invalid destination size: %dx%d, fall back to GLES", dstW, dstH);
+            DTRACE_LIMITED("invalid destination size: %dx%d, fall back to GLES", dstW, dstH);
             return false;
         }
 
@@ -227,21 +256,21 @@ bool PlaneCapabilities::isScalingSupported(int planeType, HwcLayer *hwcLayer)
 
         if (!hwcLayer->isProtected()) {
             if ((int)src.left & 63) {
-                DTRACE("offset %d is not 64 bytes aligned, fall back to GLES", (int)src.left);
+                DTRACE_LIMITED("offset %d is not 64 bytes aligned, fall back to GLES", (int)src.left);
                 return false;
             }
 
             float scaleX = (float)srcW / dstW;
             float scaleY = (float)srcH / dstH;
             if (scaleX >= 3 || scaleY >= 3) {
-                DTRACE("overlay rotation with scaling >= 3, fall back to GLES");
+                DTRACE_LIMITED("overlay rotation with scaling >= 3, fall back to GLES");
                 return false;
             }
 #if 0
             if (trans == HAL_TRANSFORM_ROT_90 && (float)srcW / srcH != (float)dstW / dstH) {
                 // FIXME: work aournd for pipe crashing issue, when rotate screen
                 // from 90 to 0 degree (with Sharp 25x16 panel).
-                DTRACE("overlay rotation with uneven scaling, fall back to GLES");
+                DTRACE_LIMITED("overlay rotation with uneven scaling, fall back to GLES");
                 return false;
             }
 #endif
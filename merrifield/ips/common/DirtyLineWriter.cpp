@@ -0,0 +1,60 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <common/DirtyLineWriter.h>
+
+namespace android {
+namespace intel {
+
+int DirtyLineWriter::write(const void *image, void *copy, void *dest,
+                           size_t size, bool stale)
+{
+    const uint8_t *src = (const uint8_t *)image;
+    uint8_t *last = (uint8_t *)copy;
+    uint8_t *dst = (uint8_t *)dest;
+    int lines = 0;
+
+    for (size_t off = 0; off < size; off += LINE_SIZE) {
+        if (!stale && !memcmp(src + off, last + off, LINE_SIZE))
+            continue;
+
+        memcpy(last + off, src + off, LINE_SIZE);
+#ifdef __SSE2__
+        // non-temporal stores fill whole write combining lines
+        const __m128i *from = (const __m128i *)(src + off);
+        __m128i *to = (__m128i *)(dst + off);
+        for (size_t i = 0; i < LINE_SIZE / sizeof(__m128i); i++) {
+            _mm_stream_si128(to + i, _mm_load_si128(from + i));
+        }
+#else
+        memcpy(dst + off, src + off, LINE_SIZE);
+#endif
+        lines++;
+    }
+#ifdef __SSE2__
+    if (lines) {
+        _mm_sfence();
+    }
+#endif
+    return lines;
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,43 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef DIRTY_LINE_WRITER_H
+#define DIRTY_LINE_WRITER_H
+
+#include <stddef.h>
+
+namespace android {
+namespace intel {
+
+// copies a cached image to uncached memory, only the cache lines changed
+// since the last write are streamed out and the destination is never read
+class DirtyLineWriter
+{
+public:
+    enum {
+        LINE_SIZE = 64,
+    };
+
+    // copy holds what was last written to dest, every line is written
+    // when it is stale. image and copy are line aligned, dest 16 byte
+    // aligned and size a multiple of LINE_SIZE. returns the lines written
+    static int write(const void *image, void *copy, void *dest,
+                     size_t size, bool stale);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* DIRTY_LINE_WRITER_H */
@@ -0,0 +1,87 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <HwcTrace.h>
+#include <common/GpuBoostControl.h>
+
+namespace android {
+namespace intel {
+
+GpuBoostControl::GpuBoostControl()
+    : IGpuBoostControl(),
+      mNodeFd(-1)
+{
+    mBoostValue[0] = '\0';
+    mReleaseValue[0] = '\0';
+}
+
+GpuBoostControl::~GpuBoostControl()
+{
+}
+
+bool GpuBoostControl::initialize()
+{
+    char node[PROPERTY_VALUE_MAX];
+
+    // no node configured, hints are dropped
+    if (property_get("hwc.gpu.boost.node", node, "") <= 0) {
+        ITRACE("GPU boost node is not configured");
+        return true;
+    }
+
+    property_get("hwc.gpu.boost.on", mBoostValue, "1");
+    property_get("hwc.gpu.boost.off", mReleaseValue, "0");
+
+    mNodeFd = open(node, O_WRONLY);
+    if (mNodeFd < 0) {
+        WTRACE("failed to open %s, error = %d", node, errno);
+    }
+    return true;
+}
+
+void GpuBoostControl::deinitialize()
+{
+    if (mNodeFd >= 0) {
+        writeNode(mReleaseValue);
+        close(mNodeFd);
+        mNodeFd = -1;
+    }
+}
+
+bool GpuBoostControl::boost(bool enable)
+{
+    if (mNodeFd < 0) {
+        return false;
+    }
+
+    return writeNode(enable ? mBoostValue : mReleaseValue);
+}
+
+bool GpuBoostControl::writeNode(const char *value)
+{
+    size_t len = strlen(value);
+    if (pwrite(mNodeFd, value, len, 0) != (ssize_t)len) {
+        WTRACE("failed to write %s, error = %d", value, errno);
+        return false;
+    }
+    return true;
+}
+
+} // namespace intel
+} // namespace android
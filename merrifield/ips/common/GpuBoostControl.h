@@ -0,0 +1,48 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef GPU_BOOST_CONTROL_H
+#define GPU_BOOST_CONTROL_H
+
+#include <cutils/properties.h>
+#include <IGpuBoostControl.h>
+
+namespace android {
+namespace intel {
+
+// writes the boost values to a sysfs node, e.g. the devfreq min_freq
+class GpuBoostControl : public IGpuBoostControl {
+public:
+    GpuBoostControl();
+    virtual ~GpuBoostControl();
+
+public:
+    bool initialize();
+    void deinitialize();
+    bool boost(bool enable);
+
+private:
+    bool writeNode(const char *value);
+
+private:
+    int mNodeFd;
+    char mBoostValue[PROPERTY_VALUE_MAX];
+    char mReleaseValue[PROPERTY_VALUE_MAX];
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* GPU_BOOST_CONTROL_H */
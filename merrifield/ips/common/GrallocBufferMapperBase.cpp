@@ -31,6 +31,7 @@ GrallocBufferMapperBase::GrallocBufferMapperBase(DataBuffer& buffer)
         mCpuAddress[i] = 0;
         mSize[i] = 0;
         mKHandle[i] = 0;
+        mGttMapped[i] = false;
     }
 }
 
@@ -67,6 +68,207 @@ buffer_handle_t GrallocBufferMapperBase::getKHandle(int subIndex)
     return 0;
 }
 
+int GrallocBufferMapperBase::getGttRanges(void *vaddr[], uint32_t size[],
+                                          GttRange *ranges)
+{
+    const uintptr_t pageMask = (1 << GTT_PAGE_SHIFT) - 1;
+    int count = 0;
+
+    for (int i = 0; i < SUB_BUFFER_MAX; i++) {
+        // skip empty sub buffers
+        if (!vaddr[i] || !size[i])
+            continue;
+
+        uintptr_t start = (uintptr_t)vaddr[i];
+        if (count > 0) {
+            // a page aligned sub buffer starting right after the pages of
+            // the previous range shares its mapping
+            GttRange *last = &ranges[count - 1];
+            uintptr_t end = ((uintptr_t)last->vaddr + last->size + pageMask) & ~pageMask;
+            if (!(start & pageMask) && start == end) {
+                last->size = start + size[i] - (uintptr_t)last->vaddr;
+                last->count = i - last->first + 1;
+                continue;
+            }
+        }
+
+        ranges[count].vaddr = vaddr[i];
+        ranges[count].size = size[i];
+        ranges[count].first = i;
+        ranges[count].count = 1;
+        count++;
+    }
+
+    return count;
+}
+
+bool GrallocBufferMapperBase::gttMap(void *vaddr,
+                                     uint32_t size,
+                                     uint32_t gttAlign,
+                                     int *offset)
+{
+    struct psb_gtt_mapping_arg arg;
+    bool ret;
+
+    ATRACE("vaddr = %p, size = %d", vaddr, size);
+
+    if (!vaddr || !size || !offset) {
+        VTRACE("invalid parameters");
+        return false;
+    }
+
+    arg.type = PSB_GTT_MAP_TYPE_VIRTUAL;
+    arg.page_align = gttAlign;
+    arg.vaddr = (unsigned long)vaddr;
+    arg.size = size;
+
+    Drm *drm = Hwcomposer::getInstance().getDrm();
+    ret = drm->writeReadIoctl(DRM_PSB_GTT_MAP, &arg, sizeof(arg));
+    if (ret == false) {
+        ETRACE("gtt mapping failed");
+        return false;
+    }
+
+    VTRACE("offset = %#x", arg.offset_pages);
+    *offset =  arg.offset_pages;
+    return true;
+}
+
+bool GrallocBufferMapperBase::gttUnmap(void *vaddr)
+{
+    struct psb_gtt_mapping_arg arg;
+    bool ret;
+
+    ATRACE("vaddr = %p", vaddr);
+
+    if (!vaddr) {
+        ETRACE("invalid parameter");
+        return false;
+    }
+
+    arg.type = PSB_GTT_MAP_TYPE_VIRTUAL;
+    arg.vaddr = (unsigned long)vaddr;
+
+    Drm *drm = Hwcomposer::getInstance().getDrm();
+    ret = drm->writeIoctl(DRM_PSB_GTT_UNMAP, &arg, sizeof(arg));
+    if (ret == false) {
+        ETRACE("gtt unmapping failed");
+        return false;
+    }
+
+    return true;
+}
+
+bool GrallocBufferMapperBase::gttMap(const GttRange& range,
+                                     void *vaddr[],
+                                     uint32_t size[])
+{
+    int gttOffsetInPage = 0;
+    int i;
+
+    // map all sub buffers of the range with one ioctl
+    if (gttMap(range.vaddr, range.size, 0, &gttOffsetInPage)) {
+        for (i = range.first; i < range.first + range.count; i++) {
+            if (!vaddr[i] || !size[i])
+                continue;
+            mCpuAddress[i] = vaddr[i];
+            mSize[i] = size[i];
+            // range may start in the middle of a page, count pages from
+            // the page it starts in
+            mGttOffsetInPage[i] = gttOffsetInPage +
+                (((uintptr_t)vaddr[i] >> GTT_PAGE_SHIFT) -
+                 ((uintptr_t)range.vaddr >> GTT_PAGE_SHIFT));
+            mGttMapped[i] = (i == range.first);
+            // TODO:  set kernel handle
+            mKHandle[i] = 0;
+        }
+        return true;
+    }
+
+    if (range.count == 1) {
+        return false;
+    }
+
+    // fall back to mapping sub buffers one by one
+    WTRACE("failed to map %d sub buffers at once", range.count);
+    for (i = range.first; i < range.first + range.count; i++) {
+        if (!vaddr[i] || !size[i])
+            continue;
+
+        if (!gttMap(vaddr[i], size[i], 0, &gttOffsetInPage)) {
+            VTRACE("failed to map %d into gtt", i);
+            return false;
+        }
+
+        mCpuAddress[i] = vaddr[i];
+        mSize[i] = size[i];
+        mGttOffsetInPage[i] = gttOffsetInPage;
+        mGttMapped[i] = true;
+        // TODO:  set kernel handle
+        mKHandle[i] = 0;
+    }
+    return true;
+}
+
+bool GrallocBufferMapperBase::gttMap(void *vaddr[], uint32_t size[])
+{
+    GttRange ranges[SUB_BUFFER_MAX];
+    int count;
+    int i;
+
+    // page contiguous sub buffers are mapped to gtt together
+    count = getGttRanges(vaddr, size, ranges);
+    for (i = 0; i < count; i++) {
+        if (!gttMap(ranges[i], vaddr, size)) {
+            VTRACE("failed to map range %d into gtt", i);
+            break;
+        }
+    }
+
+    if (i == count) {
+        return true;
+    }
+
+    gttUnmap();
+    return false;
+}
+
+void GrallocBufferMapperBase::gttUnmap()
+{
+    for (int i = 0; i < SUB_BUFFER_MAX; i++) {
+        // sub buffers sharing a mapping are unmapped with its first one
+        if (mCpuAddress[i] && mGttMapped[i])
+            gttUnmap(mCpuAddress[i]);
+
+        mGttOffsetInPage[i] = 0;
+        mCpuAddress[i] = 0;
+        mSize[i] = 0;
+        mGttMapped[i] = false;
+    }
+}
+
+bool GrallocBufferMapperBase::mapBuffers(GrallocBufferMapperBase *mappers[],
+                                         int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (!mappers[i]->map()) {
+            ETRACE("failed to map buffer %d of %d", i, count);
+            break;
+        }
+    }
+
+    if (i == count) {
+        return true;
+    }
+
+    while (--i >= 0) {
+        mappers[i]->unmap();
+    }
+    return false;
+}
+
 
 } // namespace intel
 } // namespace android
@@ -38,12 +38,42 @@ public:
     virtual buffer_handle_t getFbHandle(int subIndex) = 0;
     virtual void putFbHandle() = 0;
 
+    // map a pool of buffers, on failure none of them stays mapped
+    static bool mapBuffers(GrallocBufferMapperBase *mappers[], int count);
+
+protected:
+    enum {
+        GTT_PAGE_SHIFT = 12,
+    };
+
+    // page contiguous sub buffers that can be gtt mapped in one call
+    struct GttRange {
+        void *vaddr;
+        uint32_t size;
+        int first;
+        int count;
+    };
+
+    // group non-empty sub buffers into gtt ranges, returns number of ranges
+    static int getGttRanges(void *vaddr[], uint32_t size[], GttRange *ranges);
+
+    // map sub buffers into gtt range by range, nothing stays mapped on failure
+    bool gttMap(void *vaddr[], uint32_t size[]);
+    void gttUnmap();
+
+private:
+    bool gttMap(const GttRange& range, void *vaddr[], uint32_t size[]);
+    bool gttMap(void *vaddr, uint32_t size, uint32_t gttAlign, int *offset);
+    bool gttUnmap(void *vaddr);
+
 protected:
     // mapped info
     uint32_t mGttOffsetInPage[SUB_BUFFER_MAX];
     void* mCpuAddress[SUB_BUFFER_MAX];
     uint32_t mSize[SUB_BUFFER_MAX];
     buffer_handle_t mKHandle[SUB_BUFFER_MAX];
+    // sub buffer starts a gtt mapping, others share the preceding one
+    bool mGttMapped[SUB_BUFFER_MAX];
 };
 
 } // namespace intel
@@ -0,0 +1,37 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <common/LineSkipPolicy.h>
+
+namespace android {
+namespace intel {
+
+bool LineSkipPolicy::isEligible(int srcHeight, int dstHeight)
+{
+    return dstHeight > 0 && srcHeight >= dstHeight * MIN_RATIO;
+}
+
+bool LineSkipPolicy::update(bool skipping, uint32_t total, uint32_t budget)
+{
+    if (!skipping) {
+        return total > budget;
+    }
+
+    // stay below the budget by a margin before fetching all lines again
+    return (uint64_t)total * 100 >= (uint64_t)budget * (100 - MARGIN);
+}
+
+} // namespace intel
+} // namespace android
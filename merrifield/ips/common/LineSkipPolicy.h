@@ -0,0 +1,46 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef LINE_SKIP_POLICY_H
+#define LINE_SKIP_POLICY_H
+
+#include <stdint.h>
+
+namespace android {
+namespace intel {
+
+// decides when the overlay fetches a progressive frame by field, dropping
+// every other source line to halve its fetch bandwidth
+class LineSkipPolicy
+{
+public:
+    enum {
+        // vertical downscale at which dropping every other line is invisible
+        MIN_RATIO = 2,
+        // percentage below the budget to fetch all lines again
+        MARGIN = 10,
+    };
+
+    // the scaler still has a source line for every output line
+    static bool isEligible(int srcHeight, int dstHeight);
+    // new line skip state, total is the fetch bandwidth of all planes
+    // with every line of this plane fetched
+    static bool update(bool skipping, uint32_t total, uint32_t budget);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* LINE_SKIP_POLICY_H */
@@ -54,6 +54,11 @@ namespace intel {
 #define OVERLAY_INIT_COLORKEYMASK       ((0x0 << 31) | (0X0 << 30))
 #define OVERLAY_INIT_CONFIG             ((0x1 << 18) | (0x1 << 3))
 
+// constant alpha, value in DCLRKV[31:24] and enable in DCLRKM
+#define OVERLAY_CONST_ALPHA_ENABLE      (0x1 << 30)
+#define OVERLAY_CONST_ALPHA_SHIFT       24
+#define OVERLAY_CONST_ALPHA_MASK        (0xff << OVERLAY_CONST_ALPHA_SHIFT)
+
 // overlay register values
 #define OVERLAY_FORMAT_MASK             (0xf << 10)
 #define OVERLAY_FORMAT_PACKED_YUV422    (0x8 << 10)
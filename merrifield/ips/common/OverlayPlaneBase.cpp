@@ -15,6 +15,8 @@
 */
 
 #include <math.h>
+#include <malloc.h>
+#include <cutils/properties.h>
 #include <HwcTrace.h>
 #include <Drm.h>
 #include <Hwcomposer.h>
@@ -22,7 +24,10 @@
 #include <common/OverlayPlaneBase.h>
 #include <common/TTMBufferMapper.h>
 #include <common/GrallocSubBuffer.h>
+#include <common/DirtyLineWriter.h>
+#include <common/LineSkipPolicy.h>
 #include <DisplayQuery.h>
+#include <BandwidthEstimator.h>
 
 
 // FIXME: remove it
@@ -40,9 +45,13 @@ OverlayPlaneBase::OverlayPlaneBase(int index, int disp)
       mWsbm(0),
       mPipeConfig(0),
       mBobDeinterlace(0),
-      mUseScaledBuffer(0)
+      mUseScaledBuffer(0),
+      mLineSkip(false),
+      mLineSkipEnabled(false),
+      mVideoStampValid(false)
 {
     CTRACE();
+    memset(&mVideoStamp, 0, sizeof(mVideoStamp));
     for (int i = 0; i < OVERLAY_BACK_BUFFER_COUNT; i++) {
         mBackBuffer[i] = 0;
     }
@@ -87,6 +96,13 @@ bool OverlayPlaneBase::initialize(uint32_t bufferCount)
         resetBackBuffer(i);
     }
 
+    char prop[PROPERTY_VALUE_MAX];
+    mLineSkipEnabled = true;
+    if (property_get("hwc.overlay.lineskip", prop, "1") > 0) {
+        mLineSkipEnabled = atoi(prop) ? true : false;
+    }
+    mLineSkip = false;
+
     // disable overlay when created
     flush(PLANE_DISABLE);
 
@@ -138,6 +154,8 @@ void OverlayPlaneBase::deinitialize()
             mBackBuffer[i] = NULL;
         }
     }
+    // deferred TTM mappers still use wsbm
+    Hwcomposer::getInstance().getDeferredWorkQueue()->flush();
     DEINIT_AND_DELETE_OBJ(mWsbm);
 
     DisplayPlane::deinitialize();
@@ -294,7 +312,21 @@ OverlayBackBuffer* OverlayPlaneBase::createBackBuffer()
     void *virtAddr = mWsbm->getCPUAddress(wsbmBufferObject);
     uint32_t gttOffsetInPage = mWsbm->getGttOffset(wsbmBufferObject);
 
-    backBuffer->buf = (OverlayBackBufferBlk *)virtAddr;
+    // TTM buffer is uncached, registers are set up in a cached image
+    OverlayBackBufferBlk *image = (OverlayBackBufferBlk *)memalign(DirtyLineWriter::LINE_SIZE,
+                                  2 * sizeof(OverlayBackBufferBlk));
+    if (!image) {
+        ETRACE("failed to allocate back buffer image");
+        mWsbm->destroyTTMBuffer(wsbmBufferObject);
+        free(backBuffer);
+        return 0;
+    }
+    memset(image, 0, 2 * sizeof(OverlayBackBufferBlk));
+
+    backBuffer->buf = image;
+    backBuffer->ttmBuf = (OverlayBackBufferBlk *)virtAddr;
+    backBuffer->ttmCopy = image + 1;
+    backBuffer->ttmStale = true;
     backBuffer->gttOffsetInPage = gttOffsetInPage;
     backBuffer->bufObject = wsbmBufferObject;
 
@@ -314,10 +346,30 @@ void OverlayPlaneBase::deleteBackBuffer(int buf)
         WTRACE("failed to destroy TTM buffer");
     }
     // free back buffer
+    free(mBackBuffer[buf]->buf);
     free(mBackBuffer[buf]);
     mBackBuffer[buf] = 0;
 }
 
+void OverlayPlaneBase::writeBackBuffer(int buf)
+{
+    OverlayBackBuffer *backBuffer = mBackBuffer[buf];
+    if (!backBuffer || !backBuffer->buf)
+        return;
+
+    DirtyLineWriter::write(backBuffer->buf, backBuffer->ttmCopy,
+                           backBuffer->ttmBuf, sizeof(OverlayBackBufferBlk),
+                           backBuffer->ttmStale);
+    backBuffer->ttmStale = false;
+}
+
+void OverlayPlaneBase::writeBackBuffers()
+{
+    for (int i = 0; i < OVERLAY_BACK_BUFFER_COUNT; i++) {
+        writeBackBuffer(i);
+    }
+}
+
 void OverlayPlaneBase::resetBackBuffer(int buf)
 {
     CTRACE();
@@ -457,6 +509,8 @@ BufferMapper* OverlayPlaneBase::getTTMMapper(BufferMapper& grallocMapper, struct
             if (!ret) {
                 ETRACE("failed to map");
                 invalidateTTMBuffers();
+                // release the space of the cached buffers right now
+                Hwcomposer::getInstance().getDeferredWorkQueue()->flush();
                 ret = mapper->map();
                 if (!ret) {
                     ETRACE("failed to remap");
@@ -509,12 +563,24 @@ void OverlayPlaneBase::putTTMMapper(BufferMapper* mapper)
     if (!mapper)
         return;
 
-    if (!mapper->decRef()) {
-        // unmap it
-        mapper->unmap();
+    // no one else holds the mapper once its last reference is dropped
+    class PutWork : public DeferredWork {
+    public:
+        PutWork(BufferMapper *mapper) : mMapper(mapper) {}
+        virtual void run() {
+            // unmap it
+            mMapper->unmap();
+
+            // destroy this mapper
+            delete mMapper;
+        }
+    private:
+        BufferMapper *mMapper;
+    };
 
-        // destroy this mapper
-        delete mapper;
+    if (!mapper->decRef()) {
+        DeferredWorkQueue *dwq = Hwcomposer::getInstance().getDeferredWorkQueue();
+        dwq->queue(new PutWork(mapper));
     }
 }
 
@@ -677,6 +743,46 @@ void OverlayPlaneBase::checkCrop(int& srcX, int& srcY, int& srcW, int& srcH,
     }
 }
 
+void OverlayPlaneBase::updateLineSkip(BufferMapper& mapper)
+{
+    uint32_t format = mapper.getFormat();
+    int srcWidth = mapper.getCrop().w;
+    int srcHeight = mapper.getCrop().h;
+    int dstHeight = mPosition.h;
+
+    // only progressive video without rotation can be fetched by field
+    if (!mLineSkipEnabled || mBobDeinterlace || mTransform ||
+        (format != OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar &&
+         format != OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar_Tiled) ||
+        !LineSkipPolicy::isEligible(srcHeight, dstHeight)) {
+        mLineSkip = false;
+        return;
+    }
+
+    // what the pipe would fetch with all lines of this plane
+    DisplayPlaneManager *pm = Hwcomposer::getInstance().getPlaneManager();
+    uint32_t own = getFetchBandwidth();
+    uint32_t others = pm->getBandwidth() > own ? pm->getBandwidth() - own : 0;
+    uint32_t total = others + BandwidthEstimator::getPlaneBandwidth(format,
+                     srcWidth, srcHeight, dstHeight,
+                     mModeInfo.vdisplay, mModeInfo.vrefresh);
+    uint32_t budget = pm->getBandwidthBudget();
+
+    bool lineSkip = LineSkipPolicy::update(mLineSkip, total, budget);
+    if (lineSkip != mLineSkip) {
+        DTRACE("overlay %d %s lines, %u MB/s, budget %u MB/s", mIndex,
+               lineSkip ? "skips" : "fetches all", total, budget);
+        mLineSkip = lineSkip;
+    }
+}
+
+uint32_t OverlayPlaneBase::getFetchBandwidth() const
+{
+    uint32_t bandwidth = DisplayPlane::getFetchBandwidth();
+
+    // a field is every other line of the frame
+    return isFieldFetch() ? bandwidth / 2 : bandwidth;
+}
 
 bool OverlayPlaneBase::bufferOffsetSetup(BufferMapper& mapper)
 {
@@ -1033,7 +1139,7 @@ bool OverlayPlaneBase::scalingSetup(BufferMapper& mapper)
     uint32_t dstWidth = w;
     uint32_t dstHeight = h;
 
-    if (mBobDeinterlace && !mTransform)
+    if (isFieldFetch())
         deinterlace_factor = 2;
 
     VTRACE("src (%dx%d), dst (%dx%d)",
@@ -1193,6 +1299,125 @@ bool OverlayPlaneBase::colorSetup(BufferMapper& mapper)
     return true;
 }
 
+bool OverlayPlaneBase::readVideoStamp(BufferMapper *mapper, VideoStamp *stamp)
+{
+    uint32_t format = mapper->getFormat();
+    if (format != OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar &&
+        format != OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar_Tiled) {
+        return false;
+    }
+
+    VideoPayloadBuffer *payload =
+        (VideoPayloadBuffer *)mapper->getCpuAddress(SUB_BUFFER1);
+    if (!payload) {
+        return false;
+    }
+
+    stamp->khandle = payload->khandle;
+    stamp->rotatedHandle = payload->rotated_buffer_handle;
+    stamp->scalingHandle = payload->scaling_khandle;
+    stamp->timestamp = payload->timestamp;
+    stamp->renderStatus = payload->renderStatus;
+    return true;
+}
+
+bool OverlayPlaneBase::isContentUpdated()
+{
+    if (!mVideoStampValid || mActiveBuffers.size() == 0) {
+        return true;
+    }
+
+    // the last active mapper is the one of the current data buffer
+    BufferMapper *mapper = mActiveBuffers.itemAt(mActiveBuffers.size() - 1);
+    VideoStamp stamp;
+    if (!readVideoStamp(mapper, &stamp)) {
+        return true;
+    }
+
+    return stamp.khandle != mVideoStamp.khandle ||
+           stamp.rotatedHandle != mVideoStamp.rotatedHandle ||
+           stamp.scalingHandle != mVideoStamp.scalingHandle ||
+           stamp.timestamp != mVideoStamp.timestamp ||
+           stamp.renderStatus != mVideoStamp.renderStatus;
+}
+
+bool OverlayPlaneBase::latchVideoFrame()
+{
+    if (!mVideoStampValid || mActiveBuffers.size() == 0) {
+        return false;
+    }
+
+    // rotated and downscaled frames are produced from the decoded one
+    // after prepare and may not be ready yet
+    if (mTransform || mUseScaledBuffer ||
+        mVideoStamp.rotatedHandle || mVideoStamp.scalingHandle) {
+        return false;
+    }
+
+    BufferMapper *mapper = mActiveBuffers.itemAt(mActiveBuffers.size() - 1);
+    VideoStamp stamp;
+    if (!readVideoStamp(mapper, &stamp)) {
+        return false;
+    }
+
+    // never go back to an older frame
+    if (stamp.khandle != mVideoStamp.khandle ||
+        stamp.scalingHandle || stamp.timestamp <= mVideoStamp.timestamp) {
+        return false;
+    }
+
+    OverlayBackBufferBlk *backBuffer = mBackBuffer[mCurrent]->buf;
+    if (!backBuffer) {
+        return false;
+    }
+
+    // setDataBuffer writes the cached image in place and may fail half
+    // way, keep what prepare programmed to put it back
+    OverlayBackBufferBlk image;
+    memcpy(&image, backBuffer, sizeof(image));
+    int bobDeinterlace = mBobDeinterlace;
+    bool lineSkip = mLineSkip;
+
+    if (!setDataBuffer(*mapper)) {
+        WTRACE("failed to latch frame %lld, keep frame %lld",
+               stamp.timestamp, mVideoStamp.timestamp);
+        memcpy(backBuffer, &image, sizeof(image));
+        mBobDeinterlace = bobDeinterlace;
+        mLineSkip = lineSkip;
+        mUseScaledBuffer = 0;
+        return false;
+    }
+
+    VTRACE("latched frame %lld", stamp.timestamp);
+    return true;
+}
+
+bool OverlayPlaneBase::setDataBuffer(buffer_handle_t handle)
+{
+    // same buffer with a new decoded frame still needs reprogramming
+    if (handle && handle == mCurrentDataBuffer && isContentUpdated()) {
+        mUpdateMasks |= PLANE_BUFFER_CHANGED;
+    }
+
+    return DisplayPlane::setDataBuffer(handle);
+}
+
+void OverlayPlaneBase::alphaSetup()
+{
+    OverlayBackBufferBlk *backBuffer = mBackBuffer[mCurrent]->buf;
+
+    // overlay formats carry no per-pixel alpha, so plane alpha of a
+    // fading video maps directly onto the constant alpha blender.
+    // both registers are rewritten from their initial values so no
+    // color key state is carried over between frames
+    backBuffer->DCLRKV = OVERLAY_INIT_COLORKEY;
+    backBuffer->DCLRKM = OVERLAY_INIT_COLORKEYMASK;
+    if (mPlaneAlpha < 0xff) {
+        backBuffer->DCLRKV |= (uint32_t)mPlaneAlpha << OVERLAY_CONST_ALPHA_SHIFT;
+        backBuffer->DCLRKM |= OVERLAY_CONST_ALPHA_ENABLE;
+    }
+}
+
 bool OverlayPlaneBase::setDataBuffer(BufferMapper& grallocMapper)
 {
     BufferMapper *mapper;
@@ -1275,6 +1500,8 @@ bool OverlayPlaneBase::setDataBuffer(BufferMapper& grallocMapper)
         return false;
     }
 
+    updateLineSkip(*mapper);
+
     ret = scalingSetup(*mapper);
     if (ret == false) {
         ETRACE("failed to set up scaling parameters");
@@ -1288,12 +1515,17 @@ bool OverlayPlaneBase::setDataBuffer(BufferMapper& grallocMapper)
         ETRACE("failed to set up color parameters");
         return false;
     }
-    if (mBobDeinterlace && !mTransform) {
+
+    alphaSetup();
+
+    if (isFieldFetch()) {
         backBuffer->OCMD |= BUF_TYPE_FIELD;
         backBuffer->OCMD &= ~FIELD_SELECT;
         backBuffer->OCMD |= FIELD0;
         backBuffer->OCMD &= ~(BUFFER_SELECT);
         backBuffer->OCMD |= BUFFER0;
+    } else {
+        backBuffer->OCMD &= ~BUF_TYPE_FIELD;
     }
 
     // add to active ttm buffers if it's a rotated buffer
@@ -1301,6 +1533,8 @@ bool OverlayPlaneBase::setDataBuffer(BufferMapper& grallocMapper)
         updateActiveTTMBuffers(mapper);
     }
 
+    mVideoStampValid = readVideoStamp(&grallocMapper, &mVideoStamp);
+
     mUseScaledBuffer = 0;
     return true;
 }
@@ -28,7 +28,12 @@ namespace android {
 namespace intel {
 
 typedef struct {
+    // cacheable register image, written to the TTM buffer on flip
     OverlayBackBufferBlk *buf;
+    // TTM buffer read by the display and what was written to it last
+    OverlayBackBufferBlk *ttmBuf;
+    OverlayBackBufferBlk *ttmCopy;
+    bool ttmStale;
     uint32_t gttOffsetInPage;
     void* bufObject;
 } OverlayBackBuffer;
@@ -55,6 +60,10 @@ public:
     virtual bool initialize(uint32_t bufferCount);
     virtual void deinitialize();
 
+    virtual bool setDataBuffer(buffer_handle_t handle);
+    virtual bool isContentUpdated();
+    virtual uint32_t getFetchBandwidth() const;
+
 protected:
     // generic overlay register flush
     virtual bool flush(uint32_t flags) = 0;
@@ -69,15 +78,23 @@ protected:
                                 coeffPtr pCoeff);
     virtual bool scalingSetup(BufferMapper& mapper);
     virtual bool colorSetup(BufferMapper& mapper);
+    virtual void alphaSetup();
     virtual void checkPosition(int& x, int& y, int& w, int& h);
     virtual void checkCrop(int& x, int& y, int& w, int& h, int coded_width, int coded_height);
-
+    // fetch a single field, for bob deinterlace or to skip lines
+    bool isFieldFetch() const { return (mBobDeinterlace || mLineSkip) && !mTransform; }
+    void updateLineSkip(BufferMapper& mapper);
+    // reprogram the current back buffer if a newer frame landed since
+    // prepare, the back buffer is left untouched on failure
+    bool latchVideoFrame();
 
 protected:
     // back buffer operations
     virtual OverlayBackBuffer* createBackBuffer();
     virtual void deleteBackBuffer(int buf);
     virtual void resetBackBuffer(int buf);
+    void writeBackBuffer(int buf);
+    void writeBackBuffers();
 
     virtual BufferMapper* getTTMMapper(BufferMapper& grallocMapper, struct VideoPayloadBuffer *payload);
     virtual void  putTTMMapper(BufferMapper* mapper);
@@ -86,7 +103,18 @@ protected:
     virtual bool scaledBufferReady(BufferMapper& mapper, BufferMapper* &scaledMapper, VideoPayloadBuffer *payload);
 
 private:
+    // payload of a video frame, a decoder may render a new frame
+    // into the same gralloc buffer
+    struct VideoStamp {
+        buffer_handle_t khandle;
+        buffer_handle_t rotatedHandle;
+        buffer_handle_t scalingHandle;
+        int64_t timestamp;
+        uint32_t renderStatus;
+    };
+
     inline bool isActiveTTMBuffer(BufferMapper *mapper);
+    bool readVideoStamp(BufferMapper *mapper, VideoStamp *stamp);
     void updateActiveTTMBuffers(BufferMapper *mapper);
     void invalidateActiveTTMBuffers();
     void invalidateTTMBuffers();
@@ -120,6 +148,14 @@ protected:
 
     int mBobDeinterlace;
     int mUseScaledBuffer;
+    // progressive video fetched by field to save bandwidth
+    bool mLineSkip;
+    bool mLineSkipEnabled;
+
+private:
+    // payload of the last programmed video frame
+    VideoStamp mVideoStamp;
+    bool mVideoStampValid;
 };
 
 } // namespace intel
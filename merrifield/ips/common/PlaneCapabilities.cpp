@@ -57,7 +57,7 @@ bool PlaneCapabilities::isFormatSupported(int planeType, HwcLayer *hwcLayer)
         case HAL_PIXEL_FORMAT_UYVY:
             // TODO: overlay supports 180 degree rotation
             if (trans == HAL_TRANSFORM_ROT_180) {
-                WTRACE("180 degree rotation is not supported yet");
+                WTRACE_LIMITED("180 degree rotation is not supported yet");
             }
             return trans ? false : true;
         case HAL_PIXEL_FORMAT_YV12:
@@ -93,7 +93,27 @@ bool PlaneCapabilities::isSizeSupported(int planeType, HwcLayer *hwcLayer)
         case HAL_PIXEL_FORMAT_RGBA_8888:
         case HAL_PIXEL_FORMAT_RGBX_8888:
         case HAL_PIXEL_FORMAT_RGB_565:
-            if (stride.rgb.stride > SPRITE_PLANE_MAX_STRIDE_LINEAR) {
+            if (hwcLayer->isCompressed()) {
+                // compressed surfaces are fetched in 32-pixel wide tiles
+                // of 32-bit pixels only
+                if (!hwcLayer->isScanoutCompressed()) {
+                    VTRACE("compression layout is not supported");
+                    return false;
+                }
+                if (format == HAL_PIXEL_FORMAT_RGB_565) {
+                    VTRACE("compressed RGB565 is not supported");
+                    return false;
+                }
+#ifdef ENABLE_ROTATION_180
+                // tiled start of a backwards fetch is not known
+                VTRACE("compression on a 180 degree panel is not supported");
+                return false;
+#endif
+                maxStride = SPRITE_PLANE_MAX_STRIDE_TILED;
+            } else {
+                maxStride = SPRITE_PLANE_MAX_STRIDE_LINEAR;
+            }
+            if (stride.rgb.stride > maxStride) {
                 VTRACE("too large stride %d", stride.rgb.stride);
                 return false;
             }
@@ -159,8 +179,16 @@ bool PlaneCapabilities::isBlendingSupported(int planeType, HwcLayer *hwcLayer)
             return false;
         }
     } else if (planeType == DisplayPlane::PLANE_OVERLAY) {
-        // overlay doesn't support blending
-        return (blending == HWC_BLENDING_NONE) ? true : false;
+        // overlay formats have no per-pixel alpha, only constant alpha
+        switch (blending) {
+        case HWC_BLENDING_NONE:
+        case HWC_BLENDING_PREMULT:
+        case HWC_BLENDING_COVERAGE:
+            return true;
+        default:
+            VTRACE("unsupported blending %#x, plane alpha %d", blending, planeAlpha);
+            return false;
+        }
     } else {
         ETRACE("invalid plane type %d", planeType);
         return false;
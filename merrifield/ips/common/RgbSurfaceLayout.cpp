@@ -0,0 +1,62 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <HwcTrace.h>
+#include <common/RgbSurfaceLayout.h>
+
+namespace android {
+namespace intel {
+
+bool RgbSurfaceLayout::getLinear(const crop_t& crop, uint32_t height, uint32_t stride,
+                                 int bpp, bool rotated, Offsets& offsets)
+{
+    uint32_t linoff = crop.y * stride + crop.x * bpp;
+    if (rotated) {
+        linoff += (crop.h - 1) * stride + (crop.w - 1) * bpp;
+    }
+
+    // unlikely happen, but still we need make sure linoff is valid
+    if (linoff > stride * height) {
+        ETRACE("invalid source crop");
+        return false;
+    }
+
+    offsets.stride = stride;
+    offsets.linoff = linoff;
+    offsets.tileoff = 0;
+    return true;
+}
+
+bool RgbSurfaceLayout::getTiled(const crop_t& crop, uint32_t width, uint32_t height,
+                                bool rotated, Offsets& offsets)
+{
+    if (rotated) {
+        WTRACE("rotated compressed surface is not supported");
+        return false;
+    }
+
+    if (crop.x + crop.w > (int)width || crop.y + crop.h > (int)height) {
+        ETRACE("invalid source crop");
+        return false;
+    }
+
+    offsets.stride = align_to(width, 32) * 4;
+    offsets.linoff = (align_to(width, 32) * height / 64) - 1;
+    offsets.tileoff = (crop.y & 0xfff) << 16 | (crop.x & 0xfff);
+    return true;
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,49 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef RGB_SURFACE_LAYOUT_H
+#define RGB_SURFACE_LAYOUT_H
+
+#include <DataBuffer.h>
+
+namespace android {
+namespace intel {
+
+// stride and start offsets a sprite or primary plane fetches a RGB
+// surface with. A 180 degree panel fetches backwards from the last pixel
+// of the crop.
+class RgbSurfaceLayout
+{
+public:
+    struct Offsets {
+        uint32_t stride;
+        uint32_t linoff;
+        uint32_t tileoff;
+    };
+
+    // linear surface, stride in bytes
+    static bool getLinear(const crop_t& crop, uint32_t height, uint32_t stride,
+                          int bpp, bool rotated, Offsets& offsets);
+    // compressed surface, fetched in 32-pixel wide tiles of 32-bit pixels.
+    // the tiled start of a backwards fetch is not known, rotated surfaces
+    // are not supported
+    static bool getTiled(const crop_t& crop, uint32_t width, uint32_t height,
+                         bool rotated, Offsets& offsets);
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /*RGB_SURFACE_LAYOUT_H*/
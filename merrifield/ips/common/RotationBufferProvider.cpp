@@ -16,6 +16,7 @@
 
 #include <HwcTrace.h>
 #include <common/RotationBufferProvider.h>
+#include <VaRotation.h>
 #include <system/graphics-base.h>
 
 namespace android {
@@ -43,6 +44,7 @@ RotationBufferProvider::RotationBufferProvider(Wsbm* wsbm)
       mVaCfg(0),
       mVaCtx(0),
       mVaBufFilter(0),
+      mRotationFlags(0),
       mSourceSurface(0),
       mDisplay(DISPLAYVALUE),
       mWidth(0),
@@ -52,6 +54,12 @@ RotationBufferProvider::RotationBufferProvider(Wsbm* wsbm)
       mRotatedHeight(0),
       mRotatedStride(0),
       mTargetIndex(0),
+      mSourceSurfaces(),
+      mSourceCropWidth(0),
+      mSourceCropHeight(0),
+      mSourceStride(0),
+      mSourceTiling(0),
+      mSourceBob(0),
       mTTMWrappers(),
       mBobDeinterlace(0)
 {
@@ -92,6 +100,10 @@ void RotationBufferProvider::reset()
     if (mTTMWrappers.size()) {
         invalidateCaches();
     }
+
+    // khandles are recycled once the decoder frees its buffers, a cached
+    // source surface must not outlive the session that allocated them
+    freeSourceSurfaces();
 }
 
 void RotationBufferProvider::invalidateCaches()
@@ -106,17 +118,6 @@ void RotationBufferProvider::invalidateCaches()
     mTTMWrappers.clear();
 }
 
-int RotationBufferProvider::transFromHalToVa(int transform)
-{
-    if (transform == HAL_TRANSFORM_ROT_90)
-        return VA_ROTATION_90;
-    if (transform == HAL_TRANSFORM_ROT_180)
-        return VA_ROTATION_180;
-    if (transform == HAL_TRANSFORM_ROT_270)
-        return VA_ROTATION_270;
-    return 0;
-}
-
 int RotationBufferProvider::getStride(bool isTarget, int width)
 {
     int stride = 0;
@@ -162,7 +163,7 @@ bool RotationBufferProvider::createVaSurface(VideoPayloadBuffer *payload, int tr
     int width = 0, height = 0, bufferHeight = 0;
 
     if (isTarget) {
-        if (transFromHalToVa(transform) == VA_ROTATION_180) {
+        if (VaRotation::fromHalTransform(transform) == VA_ROTATION_180) {
             width = payload->width;
             height = payload->height;
         } else {
@@ -364,9 +365,10 @@ bool RotationBufferProvider::startVA(VideoPayloadBuffer *payload, int transform)
                                             &pipelineCaps);
     CHECK_VA_STATUS_RETURN("vaQueryVideoProcPipelineCaps");
 
-    if (!(pipelineCaps.rotation_flags & (1 << transFromHalToVa(transform)))) {
+    mRotationFlags = pipelineCaps.rotation_flags;
+    if (!VaRotation::isSupported(mRotationFlags, VaRotation::fromHalTransform(transform))) {
         ETRACE("VA_ROTATION_xxx: 0x%08x is not supported by the filter",
-             transFromHalToVa(transform));
+             VaRotation::fromHalTransform(transform));
         return false;
     }
 
@@ -395,15 +397,22 @@ bool RotationBufferProvider::setupRotationBuffer(VideoPayloadBuffer *payload, in
     }
 
     do {
-        if (isContextChanged(payload->width, payload->height, transform)) {
-            DTRACE("VA is restarted as rotation context changes");
+        if (isContextChanged(payload->width, payload->height)) {
+            DTRACE("VA is restarted as video size changes");
 
             if (mVaInitialized) {
-                stopVA(); // need to re-initialize VA for new rotation config
+                stopVA(); // need to re-initialize VA for new video size
             }
             mTransform = transform;
             mWidth = payload->width;
             mHeight = payload->height;
+        } else if (transform != mTransform) {
+            // the context is kept, only the rotation parameter changes
+            if (mVaInitialized && !updateTransform(transform)) {
+                vaStatus = VA_STATUS_ERROR_OPERATION_FAILED;
+                break;
+            }
+            mTransform = transform;
         }
 
         if (!mVaInitialized) {
@@ -424,12 +433,27 @@ bool RotationBufferProvider::setupRotationBuffer(VideoPayloadBuffer *payload, in
             }
         }
 
-        // create source surface
-        ret = createVaSurface(payload, transform, false);
-        if (ret == false) {
-            ETRACE("failed to create source surface with attribute");
-            vaStatus = VA_STATUS_ERROR_OPERATION_FAILED;
-            break;
+        // source surfaces live as long as the decoder buffers they wrap
+        if (isSourceChanged(payload)) {
+            freeSourceSurfaces();
+        }
+
+        ssize_t index = mSourceSurfaces.indexOfKey(payload->khandle);
+        if (index >= 0) {
+            mSourceSurface = mSourceSurfaces.valueAt(index);
+        } else {
+            ret = createVaSurface(payload, transform, false);
+            if (ret == false) {
+                ETRACE("failed to create source surface with attribute");
+                vaStatus = VA_STATUS_ERROR_OPERATION_FAILED;
+                break;
+            }
+
+            if (mSourceSurfaces.size() >= SOURCE_SURFACE_COUNT) {
+                WTRACE("mSourceSurfaces is unexpectedly full. Invalidate caches");
+                freeSourceSurfaces();
+            }
+            mSourceSurfaces.add(payload->khandle, mSourceSurface);
         }
 
 #ifdef DEBUG_ROTATION_PERFROMANCE
@@ -455,7 +479,7 @@ bool RotationBufferProvider::setupRotationBuffer(VideoPayloadBuffer *payload, in
 
         pipelineParam = (VAProcPipelineParameterBuffer*)p;
         pipelineParam->surface = mSourceSurface;
-        pipelineParam->rotation_state = transFromHalToVa(transform);
+        pipelineParam->rotation_state = VaRotation::fromHalTransform(transform);
         pipelineParam->filters = &mVaBufFilter;
         pipelineParam->num_filters = 1;
         pipelineParam->surface_region = NULL;
@@ -496,12 +520,8 @@ bool RotationBufferProvider::setupRotationBuffer(VideoPayloadBuffer *payload, in
          getMilliseconds() - setup_Begin);
 #endif
 
-    if (mSourceSurface > 0) {
-        vaStatus = vaDestroySurfaces(mVaDpy, &mSourceSurface, 1);
-        if (vaStatus != VA_STATUS_SUCCESS)
-            WTRACE("vaDestroySurfaces failed, vaStatus = %d", vaStatus);
-        mSourceSurface = 0;
-    }
+    // kept in mSourceSurfaces
+    mSourceSurface = 0;
 
     if (vaStatus != VA_STATUS_SUCCESS) {
         stopVA();
@@ -586,8 +606,22 @@ void RotationBufferProvider::freeVaSurfaces()
     }
 }
 
+void RotationBufferProvider::freeSourceSurfaces()
+{
+    VAStatus vaStatus;
+
+    for (size_t i = 0; i < mSourceSurfaces.size(); i++) {
+        VASurfaceID surface = mSourceSurfaces.valueAt(i);
+        vaStatus = vaDestroySurfaces(mVaDpy, &surface, 1);
+        if (vaStatus != VA_STATUS_SUCCESS)
+            WTRACE("vaDestroySurfaces failed, vaStatus = %d", vaStatus);
+    }
+    mSourceSurfaces.clear();
+}
+
 void RotationBufferProvider::stopVA()
 {
+    freeSourceSurfaces();
     freeVaSurfaces();
 
     if (0 != mVaBufFilter)
@@ -611,6 +645,7 @@ void RotationBufferProvider::stopVA()
     mVaCfg = 0;
     mVaCtx = 0;
     mVaBufFilter = 0;
+    mRotationFlags = 0;
     mSourceSurface = 0;
 
     mWidth = 0;
@@ -622,15 +657,55 @@ void RotationBufferProvider::stopVA()
     mBobDeinterlace = 0;
 }
 
-bool RotationBufferProvider::isContextChanged(int width, int height, int transform)
+bool RotationBufferProvider::isContextChanged(int width, int height)
 {
-    // check rotation config
+    // context is created for the video size, transform is per picture
     if (height == mHeight &&
-        width == mWidth &&
-        transform == mTransform) {
+        width == mWidth) {
+        return false;
+    }
+
+    return true;
+}
+
+bool RotationBufferProvider::updateTransform(int transform)
+{
+    int rotation = VaRotation::fromHalTransform(transform);
+    if (!VaRotation::isSupported(mRotationFlags, rotation)) {
+        ETRACE("VA_ROTATION_xxx: 0x%08x is not supported by the filter", rotation);
+        return false;
+    }
+
+    // targets of a 90 or 270 degree rotation have width and height swapped
+    bool swapped = (rotation != VA_ROTATION_180);
+    bool wasSwapped = (VaRotation::fromHalTransform(mTransform) != VA_ROTATION_180);
+    if (swapped != wasSwapped) {
+        DTRACE("target surfaces are resized for transform %d", transform);
+        freeVaSurfaces();
+        for (int i = 0; i < MAX_SURFACE_NUM; i++) {
+            mKhandles[i] = 0;
+        }
+        mTargetIndex = 0;
+    }
+
+    return true;
+}
+
+bool RotationBufferProvider::isSourceChanged(VideoPayloadBuffer *payload)
+{
+    if (payload->crop_width == mSourceCropWidth &&
+        payload->crop_height == mSourceCropHeight &&
+        payload->luma_stride == mSourceStride &&
+        payload->tiling == mSourceTiling &&
+        payload->bob_deinterlace == mSourceBob) {
         return false;
     }
 
+    mSourceCropWidth = payload->crop_width;
+    mSourceCropHeight = payload->crop_height;
+    mSourceStride = payload->luma_stride;
+    mSourceTiling = payload->tiling;
+    mSourceBob = payload->bob_deinterlace;
     return true;
 }
 
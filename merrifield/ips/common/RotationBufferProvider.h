@@ -50,17 +50,21 @@ private:
     void invalidateCaches();
     bool startVA(VideoPayloadBuffer *payload, int transform);
     void stopVA();
-    bool isContextChanged(int width, int height, int transform);
-    int transFromHalToVa(int transform);
+    bool isContextChanged(int width, int height);
+    bool updateTransform(int transform);
+    bool isSourceChanged(VideoPayloadBuffer *payload);
     buffer_handle_t createWsbmBuffer(int width, int height, void **buf);
     int getStride(bool isTarget, int width);
     bool createVaSurface(VideoPayloadBuffer *payload, int transform, bool isTarget);
     void freeVaSurfaces();
+    void freeSourceSurfaces();
     inline uint32_t getMilliseconds();
 
 private:
     enum {
-        MAX_SURFACE_NUM = 4
+        MAX_SURFACE_NUM = 4,
+        // larger than a decoder's buffer pool
+        SOURCE_SURFACE_COUNT = 24,
     };
 
     Wsbm* mWsbm;
@@ -70,6 +74,7 @@ private:
     VAConfigID mVaCfg;
     VAContextID mVaCtx;
     VABufferID mVaBufFilter;
+    uint32_t mRotationFlags;
     VASurfaceID mSourceSurface;
     Display mDisplay;
 
@@ -87,6 +92,14 @@ private:
     VASurfaceID mRotatedSurfaces[MAX_SURFACE_NUM];
     void *mDrmBuf[MAX_SURFACE_NUM];
 
+    // decoder buffers wrapped as VA surfaces, and the layout they share
+    KeyedVector<buffer_handle_t, VASurfaceID> mSourceSurfaces;
+    uint32_t mSourceCropWidth;
+    uint32_t mSourceCropHeight;
+    uint32_t mSourceStride;
+    int mSourceTiling;
+    int mSourceBob;
+
     enum {
         TTM_WRAPPER_COUNT = 10,
     };
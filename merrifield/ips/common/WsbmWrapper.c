@@ -15,6 +15,7 @@
 */
 
 #include <string.h>
+#include <pthread.h>
 #include <wsbm_pool.h>
 #include <wsbm_driver.h>
 #include <wsbm_manager.h>
@@ -26,6 +27,11 @@
 
 struct _WsbmBufferPool * mainPool = NULL;
 
+/* wsbm is initialized without thread funcs, so its own locks are no-ops.
+ * Buffers are released from the deferred work thread, serialize all
+ * calls into wsbm here. */
+static pthread_mutex_t wsbmLock = PTHREAD_MUTEX_INITIALIZER;
+
 struct PsbWsbmValidateNode
 {
     struct  _ValidateNode base;
@@ -94,6 +100,7 @@ void psbWsbmTakedown()
 {
     CTRACE();
 
+    pthread_mutex_lock(&wsbmLock);
     if (mainPool) {
         wsbmPoolTakeDown(mainPool);
         mainPool = NULL;
@@ -102,6 +109,7 @@ void psbWsbmTakedown()
     if (wsbmIsInitialized()) {
         wsbmTakedown();
     }
+    pthread_mutex_unlock(&wsbmLock);
 }
 
 int psbWsbmInitialize(int drmFD)
@@ -118,7 +126,9 @@ int psbWsbmInitialize(int drmFD)
     }
 
     /*init wsbm*/
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmInit(wsbmNullThreadFuncs(), &vNodeFuncs);
+    pthread_mutex_unlock(&wsbmLock);
     if (ret) {
         ETRACE("failed to initialize Wsbm, error code %d", ret);
         return ret;
@@ -137,7 +147,9 @@ int psbWsbmInitialize(int drmFD)
 
     VTRACE("ioctl offset %#x", arg.rep.driver_ioctl_offset);
 
+    pthread_mutex_lock(&wsbmLock);
     mainPool = wsbmTTMPoolInit(drmFD, arg.rep.driver_ioctl_offset);
+    pthread_mutex_unlock(&wsbmLock);
     if(!mainPool) {
         ETRACE("failed to initialize TTM Pool");
         ret = -EINVAL;
@@ -168,10 +180,12 @@ int psbWsbmAllocateFromUB(uint32_t size, uint32_t align, void ** buf, void *user
 
     VTRACE("mainPool %p", mainPool);
 
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmGenBuffers(mainPool, 1, &wsbmBuf, align,
                         DRM_PSB_FLAG_MEM_MMU | WSBM_PL_FLAG_CACHED |
                         WSBM_PL_FLAG_NO_EVICT | WSBM_PL_FLAG_SHARED);
     if(ret) {
+        pthread_mutex_unlock(&wsbmLock);
         ETRACE("wsbmGenBuffers failed with error code %d", ret);
         return ret;
     }
@@ -179,6 +193,7 @@ int psbWsbmAllocateFromUB(uint32_t size, uint32_t align, void ** buf, void *user
     ret = wsbmBODataUB(wsbmBuf,
                        align_to(size, 4096), NULL, NULL, 0,
                        user_pt, -1);
+    pthread_mutex_unlock(&wsbmLock);
 
     if(ret) {
         ETRACE("wsbmBOData failed with error code %d", ret);
@@ -207,15 +222,18 @@ int psbWsbmAllocateTTMBuffer(uint32_t size, uint32_t align, void ** buf)
 
     VTRACE("mainPool %p", mainPool);
 
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmGenBuffers(mainPool, 1, &wsbmBuf, align,
                         (WSBM_PL_FLAG_VRAM | WSBM_PL_FLAG_TT |
                          WSBM_PL_FLAG_SHARED | WSBM_PL_FLAG_NO_EVICT));
     if(ret) {
+        pthread_mutex_unlock(&wsbmLock);
         ETRACE("wsbmGenBuffers failed with error code %d", ret);
         return ret;
     }
 
     ret = wsbmBOData(wsbmBuf, align_to(size, 4096), NULL, NULL, 0);
+    pthread_mutex_unlock(&wsbmLock);
     if(ret) {
         ETRACE("wsbmBOData failed with error code %d", ret);
         /*FIXME: should I unreference this buffer here?*/
@@ -240,16 +258,19 @@ int psbWsbmWrapTTMBuffer(uint64_t handle, void **buf)
         return -EINVAL;
     }
 
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmGenBuffers(mainPool, 1, &wsbmBuf, 0,
                         (WSBM_PL_FLAG_VRAM | WSBM_PL_FLAG_TT |
                         /*WSBM_PL_FLAG_NO_EVICT |*/ WSBM_PL_FLAG_SHARED));
 
     if (ret) {
+        pthread_mutex_unlock(&wsbmLock);
         ETRACE("wsbmGenBuffers failed with error code %d", ret);
         return ret;
     }
 
     ret = wsbmBOSetReferenced(wsbmBuf, handle);
+    pthread_mutex_unlock(&wsbmLock);
     if (ret) {
         ETRACE("wsbmBOSetReferenced failed with error code %d", ret);
         return ret;
@@ -271,8 +292,10 @@ int psbWsbmWrapTTMBuffer2(uint64_t handle, void **buf)
         return -EINVAL;
     }
 
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmGenBuffers(mainPool, 1, &wsbmBuf, 4096,
             (WSBM_PL_FLAG_SHARED | DRM_PSB_FLAG_MEM_MMU | WSBM_PL_FLAG_UNCACHED));
+    pthread_mutex_unlock(&wsbmLock);
 
     if (ret) {
         ETRACE("wsbmGenBuffers failed with error code %d", ret);
@@ -297,7 +320,9 @@ int psbWsbmCreateFromUB(void *buf, uint32_t size, void *vaddr)
     }
 
     wsbmBuf = (struct _WsbmBufferObject *)buf;
+    pthread_mutex_lock(&wsbmLock);
     ret = wsbmBODataUB(wsbmBuf, size, NULL, NULL, 0, vaddr, -1);
+    pthread_mutex_unlock(&wsbmLock);
     if (ret) {
         ETRACE("wsbmBODataUB failed with error code %d", ret);
         return ret;
@@ -317,7 +342,9 @@ int psbWsbmUnReference(void *buf)
 
     wsbmBuf = (struct _WsbmBufferObject *)buf;
 
+    pthread_mutex_lock(&wsbmLock);
     wsbmBOUnreference(&wsbmBuf);
+    pthread_mutex_unlock(&wsbmLock);
 
     return 0;
 }
@@ -332,9 +359,11 @@ int psbWsbmDestroyTTMBuffer(void * buf)
     }
 
     /*FIXME: should I unmap this buffer object first?*/
+    pthread_mutex_lock(&wsbmLock);
     wsbmBOUnmap((struct _WsbmBufferObject *)buf);
 
     wsbmBOUnreference((struct _WsbmBufferObject **)&buf);
+    pthread_mutex_unlock(&wsbmLock);
 
     XTRACE();
 
@@ -350,8 +379,10 @@ void * psbWsbmGetCPUAddress(void * buf)
 
     VTRACE("buffer object %p", buf);
 
+    pthread_mutex_lock(&wsbmLock);
     void * address = wsbmBOMap((struct _WsbmBufferObject *)buf,
                                 WSBM_ACCESS_READ | WSBM_ACCESS_WRITE);
+    pthread_mutex_unlock(&wsbmLock);
     if(!address) {
         ETRACE("failed to map buffer object");
         return NULL;
@@ -372,8 +403,10 @@ uint32_t psbWsbmGetGttOffset(void * buf)
 
     VTRACE("buffer object %p", buf);
 
+    pthread_mutex_lock(&wsbmLock);
     uint32_t offset =
         wsbmBOOffsetHint((struct _WsbmBufferObject *)buf) - 0x10000000;
+    pthread_mutex_unlock(&wsbmLock);
 
     VTRACE("offset %#x", offset >> 12);
 
@@ -387,7 +420,11 @@ uint32_t psbWsbmGetKBufHandle(void *buf)
         return 0;
     }
 
-    return (wsbmKBufHandle(wsbmKBuf((struct _WsbmBufferObject *)buf)));
+    pthread_mutex_lock(&wsbmLock);
+    uint32_t handle = wsbmKBufHandle(wsbmKBuf((struct _WsbmBufferObject *)buf));
+    pthread_mutex_unlock(&wsbmLock);
+
+    return handle;
 }
 
 uint32_t psbWsbmWaitIdle(void *buf)
@@ -397,6 +434,9 @@ uint32_t psbWsbmWaitIdle(void *buf)
         return -EINVAL;
     }
 
+    /* waiting blocks until the GPU is done with the buffer, don't hold
+     * wsbmLock meanwhile. The caller owns a reference to buf, the
+     * deferred work thread only releases buffers nobody references. */
     wsbmBOWaitIdle(buf, 0);
     return 0;
 }
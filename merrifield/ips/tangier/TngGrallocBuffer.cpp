@@ -46,7 +46,10 @@ void TngGrallocBuffer::initBuffer(buffer_handle_t handle)
         return;
     }
 
-    mFormat = grallocHandle->iFormat;
+    // planes are programmed from the base format, compression is
+    // reported separately through isCompressionBuffer
+    mGrallocFormat = grallocHandle->iFormat;
+    mFormat = getBaseFormat(grallocHandle->iFormat);
     mWidth = grallocHandle->iWidth;
     mHeight = grallocHandle->iHeight;
     mUsage = grallocHandle->usage;
@@ -54,71 +54,11 @@ TngGrallocBufferMapper::~TngGrallocBufferMapper()
 	native_handle_delete(mClonedHandle);
 }
 
-bool TngGrallocBufferMapper::gttMap(void *vaddr,
-                                      uint32_t size,
-                                      uint32_t gttAlign,
-                                      int *offset)
-{
-    struct psb_gtt_mapping_arg arg;
-    bool ret;
-
-    ATRACE("vaddr = %p, size = %d", vaddr, size);
-
-    if (!vaddr || !size || !offset) {
-        VTRACE("invalid parameters");
-        return false;
-    }
-
-    arg.type = PSB_GTT_MAP_TYPE_VIRTUAL;
-    arg.page_align = gttAlign;
-    arg.vaddr = (unsigned long)vaddr;
-    arg.size = size;
-
-    Drm *drm = Hwcomposer::getInstance().getDrm();
-    ret = drm->writeReadIoctl(DRM_PSB_GTT_MAP, &arg, sizeof(arg));
-    if (ret == false) {
-        ETRACE("gtt mapping failed");
-        return false;
-    }
-
-    VTRACE("offset = %#x", arg.offset_pages);
-    *offset =  arg.offset_pages;
-    return true;
-}
-
-bool TngGrallocBufferMapper::gttUnmap(void *vaddr)
-{
-    struct psb_gtt_mapping_arg arg;
-    bool ret;
-
-    ATRACE("vaddr = %p", vaddr);
-
-    if (!vaddr) {
-        ETRACE("invalid parameter");
-        return false;
-    }
-
-    arg.type = PSB_GTT_MAP_TYPE_VIRTUAL;
-    arg.vaddr = (unsigned long)vaddr;
-
-    Drm *drm = Hwcomposer::getInstance().getDrm();
-    ret = drm->writeIoctl(DRM_PSB_GTT_UNMAP, &arg, sizeof(arg));
-    if (ret == false) {
-        ETRACE("gtt unmapping failed");
-        return false;
-    }
-
-    return true;
-}
-
 bool TngGrallocBufferMapper::map()
 {
     void *vaddr[SUB_BUFFER_MAX];
     uint32_t size[SUB_BUFFER_MAX];
-    int gttOffsetInPage = 0;
-    bool ret;
     int err;
-    int i;
 
     CTRACE();
     // get virtual address
@@ -131,36 +71,11 @@ bool TngGrallocBufferMapper::map()
         return false;
     }
 
-    for (i = 0; i < SUB_BUFFER_MAX; i++) {
-        // skip gtt mapping for empty sub buffers
-        if (!vaddr[i] || !size[i])
-            continue;
-
-        // map to gtt
-        ret = gttMap(vaddr[i], size[i], 0, &gttOffsetInPage);
-        if (!ret) {
-            VTRACE("failed to map %d into gtt", i);
-            break;
-        }
-
-        mCpuAddress[i] = vaddr[i];
-        mSize[i] = size[i];
-        mGttOffsetInPage[i] = gttOffsetInPage;
-        // TODO:  set kernel handle
-        mKHandle[i] = 0;
-    }
-
-    if (i == SUB_BUFFER_MAX) {
+    if (gttMap(vaddr, size)) {
         return true;
     }
 
     // error handling
-    for (i = 0; i < SUB_BUFFER_MAX; i++) {
-        if (mCpuAddress[i]) {
-            gttUnmap(mCpuAddress[i]);
-        }
-    }
-
     err = gralloc_put_buffer_cpu_addresses_img(&mGralloc,
                                   (buffer_handle_t)mClonedHandle);
     return false;
@@ -168,19 +83,11 @@ bool TngGrallocBufferMapper::map()
 
 bool TngGrallocBufferMapper::unmap()
 {
-    int i;
     int err;
 
     CTRACE();
 
-    for (i = 0; i < SUB_BUFFER_MAX; i++) {
-        if (mCpuAddress[i])
-            gttUnmap(mCpuAddress[i]);
-
-        mGttOffsetInPage[i] = 0;
-        mCpuAddress[i] = 0;
-        mSize[i] = 0;
-    }
+    gttUnmap();
 
     err = gralloc_put_buffer_cpu_addresses_img(&mGralloc,
                                   (buffer_handle_t)mClonedHandle);
@@ -35,8 +35,6 @@ public:
     buffer_handle_t getFbHandle(int subIndex);
     void putFbHandle();
 private:
-    bool gttMap(void *vaddr, uint32_t size, uint32_t gttAlign, int *offset);
-    bool gttUnmap(void *vaddr);
     bool mapKhandle();
 
 private:
@@ -44,6 +44,8 @@ bool TngOverlayPlane::flip(void *ctx)
     if (!DisplayPlane::flip(ctx))
         return false;
 
+    writeBackBuffer(mCurrent);
+
     mContext.type = DC_OVERLAY_PLANE;
     mContext.ctx.ov_ctx.ovadd = 0x0;
     mContext.ctx.ov_ctx.ovadd = (mBackBuffer[mCurrent]->gttOffsetInPage << 12);
@@ -193,6 +195,9 @@ bool TngOverlayPlane::flush(uint32_t flags)
     else if (flags & PLANE_ENABLE)
         arg.plane_enable_mask = 1;
 
+    // enable, disable and z order change every back buffer
+    writeBackBuffers();
+
     arg.plane.type = DC_OVERLAY_PLANE;
     arg.plane.index = mIndex;
     arg.plane.ctx = (mBackBuffer[mCurrent]->gttOffsetInPage << 12);
@@ -18,6 +18,7 @@
 #include <tangier/TngPrimaryPlane.h>
 #include <tangier/TngGrallocBuffer.h>
 #include <common/PixelFormat.h>
+#include <common/RgbSurfaceLayout.h>
 
 namespace android {
 namespace intel {
@@ -36,8 +37,14 @@ TngPrimaryPlane::~TngPrimaryPlane()
     CTRACE();
 }
 
-void TngPrimaryPlane::setFramebufferTarget(buffer_handle_t handle)
+bool TngPrimaryPlane::setFramebufferTarget(buffer_handle_t handle)
 {
+    bool isCompression = false;
+    bool rotated = false;
+    crop_t crop;
+    RgbSurfaceLayout::Offsets offsets;
+    bool ret;
+
     CTRACE();
 
     // do not need to update the buffer handle
@@ -48,19 +55,43 @@ void TngPrimaryPlane::setFramebufferTarget(buffer_handle_t handle)
 
     // if no update then do Not need set data buffer
     if (!mUpdateMasks)
-        return;
+        return true;
+
+    // compressed framebuffer target is fetched in tiles
+    if (handle) {
+        TngGrallocBuffer tmpBuf(handle);
+        isCompression = GraphicBuffer::isCompressionBuffer(&tmpBuf);
+        if (isCompression && !GraphicBuffer::isScanoutCompressionBuffer(&tmpBuf)) {
+            WTRACE_LIMITED("compression layout of framebuffer target is not supported");
+            return false;
+        }
+    }
+
+#ifdef ENABLE_ROTATION_180
+    rotated = true;
+#endif
+    crop.x = 0;
+    crop.y = 0;
+    crop.w = mPosition.w;
+    crop.h = mPosition.h;
+    if (isCompression) {
+        ret = RgbSurfaceLayout::getTiled(crop, mPosition.w, mPosition.h, rotated, offsets);
+    } else {
+        ret = RgbSurfaceLayout::getLinear(crop, mPosition.h,
+                align_to((4 * align_to(mPosition.w, 32)), 64), 4, rotated, offsets);
+    }
+    if (ret == false) {
+        return false;
+    }
 
     // don't need to map data buffer for primary plane
     mContext.type = DC_PRIMARY_PLANE;
     mContext.ctx.prim_ctx.update_mask = SPRITE_UPDATE_ALL;
     mContext.ctx.prim_ctx.index = mIndex;
     mContext.ctx.prim_ctx.pipe = mDevice;
-    mContext.ctx.prim_ctx.stride = align_to((4 * align_to(mPosition.w, 32)), 64);
-#ifdef ENABLE_ROTATION_180
-    mContext.ctx.prim_ctx.linoff = (mPosition.h - 1) * mContext.ctx.prim_ctx.stride + (mPosition.w  - 1)* 4;
-#else
-    mContext.ctx.prim_ctx.linoff = 0;
-#endif
+    mContext.ctx.prim_ctx.stride = offsets.stride;
+    mContext.ctx.prim_ctx.linoff = offsets.linoff;
+    mContext.ctx.prim_ctx.tileoff = offsets.tileoff;
     mContext.ctx.prim_ctx.pos = 0;
     mContext.ctx.prim_ctx.size =
         ((mPosition.h - 1) & 0xfff) << 16 | ((mPosition.w - 1) & 0xfff);
@@ -73,7 +104,11 @@ void TngPrimaryPlane::setFramebufferTarget(buffer_handle_t handle)
 #else
     mContext.ctx.prim_ctx.cntr |= 0x80000000;
 #endif
+    if (isCompression)
+        mContext.ctx.prim_ctx.cntr |= 1 << 11;
+
     mCurrentDataBuffer = handle;
+    return true;
 }
 
 bool TngPrimaryPlane::enablePlane(bool enabled)
@@ -106,8 +141,7 @@ bool TngPrimaryPlane::enablePlane(bool enabled)
 bool TngPrimaryPlane::setDataBuffer(buffer_handle_t handle)
 {
     if (!handle) {
-        setFramebufferTarget(handle);
-        return true;
+        return setFramebufferTarget(handle);
     }
 
     TngGrallocBuffer tmpBuf(handle);
@@ -118,8 +152,7 @@ bool TngPrimaryPlane::setDataBuffer(buffer_handle_t handle)
 
     usage = tmpBuf.getUsage();
     if (GRALLOC_USAGE_HW_FB & usage) {
-        setFramebufferTarget(handle);
-        return true;
+        return setFramebufferTarget(handle);
     }
 
     // use primary as a sprite
@@ -30,7 +30,7 @@ public:
     void setZOrderConfig(ZOrderConfig& config, void *nativeConfig);
     bool assignToDevice(int disp);
 private:
-    void setFramebufferTarget(buffer_handle_t handle);
+    bool setFramebufferTarget(buffer_handle_t handle);
     bool enablePlane(bool enabled);
 };
 
@@ -18,6 +18,7 @@
 #include <BufferManager.h>
 #include <tangier/TngSpritePlane.h>
 #include <common/PixelFormat.h>
+#include <common/RgbSurfaceLayout.h>
 
 namespace android {
 namespace intel {
@@ -37,12 +38,12 @@ TngSpritePlane::~TngSpritePlane()
 bool TngSpritePlane::setDataBuffer(BufferMapper& mapper)
 {
     int bpp;
-    int srcX, srcY;
     int dstX, dstY, dstW, dstH;
     uint32_t spriteFormat;
-    uint32_t stride;
-    uint32_t linoff;
     uint32_t planeAlpha;
+    RgbSurfaceLayout::Offsets offsets;
+    bool rotated = false;
+    bool ret;
 
     CTRACE();
 
@@ -61,29 +62,28 @@ bool TngSpritePlane::setDataBuffer(BufferMapper& mapper)
     }
 
     // setup stride and source buffer crop
-    srcX = mapper.getCrop().x;
-    srcY = mapper.getCrop().y;
-    stride = mapper.getStride().rgb.stride;
 #ifdef ENABLE_ROTATION_180
-    linoff = (mapper.getCrop().h + srcY - 1) * stride + (srcX + mapper.getCrop().w - 1) * bpp;
-#else
-    linoff = srcY * stride + srcX * bpp;
+    rotated = true;
 #endif
+    if (mapper.isCompression()) {
+        ret = RgbSurfaceLayout::getTiled(mapper.getCrop(),
+                mapper.getWidth(), mapper.getHeight(), rotated, offsets);
+    } else {
+        ret = RgbSurfaceLayout::getLinear(mapper.getCrop(), mapper.getHeight(),
+                mapper.getStride().rgb.stride, bpp, rotated, offsets);
+    }
+    if (ret == false) {
+        return false;
+    }
 
-    // setup plane alpha
-    if ((mBlending == HWC_BLENDING_PREMULT) && (mPlaneAlpha == 0)) {
+    // setup plane alpha, constant alpha also covers fading layers
+    if (mPlaneAlpha < 0xff) {
        planeAlpha = mPlaneAlpha | 0x80000000;
     } else {
        // disable plane alpha to offload HW
        planeAlpha = 0;
     }
 
-    // unlikely happen, but still we need make sure linoff is valid
-    if (linoff > (stride * mapper.getHeight())) {
-        ETRACE("invalid source crop");
-        return false;
-    }
-
     // update context
     mContext.type = DC_SPRITE_PLANE;
     mContext.ctx.sp_ctx.index = mIndex;
@@ -94,8 +94,9 @@ bool TngSpritePlane::setDataBuffer(BufferMapper& mapper)
 					| 0x80000000;
     else
 	mContext.ctx.sp_ctx.cntr = spriteFormat | 0x80000000;
-    mContext.ctx.sp_ctx.linoff = linoff;
-    mContext.ctx.sp_ctx.stride = stride;
+    mContext.ctx.sp_ctx.linoff = offsets.linoff;
+    mContext.ctx.sp_ctx.stride = offsets.stride;
+    mContext.ctx.sp_ctx.tileoff = offsets.tileoff;
     mContext.ctx.sp_ctx.surf = mapper.getGttOffsetInPage(0) << 12;
     mContext.ctx.sp_ctx.pos = (dstY & 0xfff) << 16 | (dstX & 0xfff);
     mContext.ctx.sp_ctx.size =
@@ -106,6 +107,8 @@ bool TngSpritePlane::setDataBuffer(BufferMapper& mapper)
 #ifdef ENABLE_ROTATION_180
     mContext.ctx.sp_ctx.cntr |= 1 << 15;
 #endif
+    if (mapper.isCompression())
+        mContext.ctx.sp_ctx.cntr |= 1 << 11;
     VTRACE("cntr = %#x, linoff = %#x, stride = %#x,"
           "surf = %#x, pos = %#x, size = %#x, contalpa = %#x",
           mContext.ctx.sp_ctx.cntr,
@@ -34,6 +34,8 @@ LOCAL_SRC_FILES := \
     ../../common/base/HwcModule.cpp \
     ../../common/base/DisplayAnalyzer.cpp \
     ../../common/base/VsyncManager.cpp \
+    ../../common/base/DeferredWorkQueue.cpp \
+    ../../common/base/GpuBoostManager.cpp \
     ../../common/buffers/BufferCache.cpp \
     ../../common/buffers/GraphicBuffer.cpp \
     ../../common/buffers/BufferManager.cpp \
@@ -47,18 +49,29 @@ LOCAL_SRC_FILES := \
     ../../common/observers/MultiDisplayObserver.cpp \
     ../../common/planes/DisplayPlane.cpp \
     ../../common/planes/DisplayPlaneManager.cpp \
-    ../../common/utils/Dump.cpp
+    ../../common/utils/Dump.cpp \
+    ../../common/utils/HwcTrace.cpp \
+    ../../common/utils/FrameRateEstimator.cpp \
+    ../../common/utils/BandwidthEstimator.cpp \
+    ../../common/utils/PipeGeometry.cpp \
+    ../../common/utils/UnderrunBlacklist.cpp \
+    ../../common/utils/VaRotation.cpp \
+    ../../common/utils/AnimationDetector.cpp
 
 
 LOCAL_SRC_FILES += \
     ../../ips/common/BlankControl.cpp \
+    ../../ips/common/GpuBoostControl.cpp \
     ../../ips/common/HdcpControl.cpp \
     ../../ips/common/DrmControl.cpp \
     ../../ips/common/VsyncControl.cpp \
     ../../ips/common/PrepareListener.cpp \
     ../../ips/common/OverlayPlaneBase.cpp \
+    ../../ips/common/DirtyLineWriter.cpp \
+    ../../ips/common/LineSkipPolicy.cpp \
     ../../ips/common/SpritePlaneBase.cpp \
     ../../ips/common/PixelFormat.cpp \
+    ../../ips/common/RgbSurfaceLayout.cpp \
     ../../ips/common/PlaneCapabilities.cpp \
     ../../ips/common/GrallocBufferBase.cpp \
     ../../ips/common/GrallocBufferMapperBase.cpp \
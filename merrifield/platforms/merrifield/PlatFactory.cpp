@@ -29,6 +29,7 @@
 #include <common/BlankControl.h>
 #include <common/PrepareListener.h>
 #include <common/VideoPayloadManager.h>
+#include <common/GpuBoostControl.h>
 
 
 namespace android {
@@ -93,6 +94,11 @@ IVideoPayloadManager *PlatFactory::createVideoPayloadManager()
     return new VideoPayloadManager();
 }
 
+IGpuBoostControl *PlatFactory::createGpuBoostControl()
+{
+    return new GpuBoostControl();
+}
+
 Hwcomposer* Hwcomposer::createHwcomposer()
 {
     CTRACE();
@@ -33,6 +33,7 @@ public:
     virtual IDisplayDevice* createDisplayDevice(int disp);
     virtual IDisplayContext* createDisplayContext();
     virtual IVideoPayloadManager *createVideoPayloadManager();
+    virtual IGpuBoostControl *createGpuBoostControl();
 
 };
 
@@ -24,3 +24,88 @@ LOCAL_C_INCLUDES := \
 # Build the binary to $(TARGET_OUT_DATA_NATIVE_TESTS)/$(LOCAL_MODULE)
 # to integrate with auto-test framework.
 include $(BUILD_EXECUTABLE)
+
+# Unit tests of the common utilities
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := hwc_utils_test
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+    animation_detector_test.cpp \
+    bandwidth_estimator_test.cpp \
+    clone_fence_test.cpp \
+    dirty_line_writer_test.cpp \
+    display_analyzer_test.cpp \
+    fade_replay_test.cpp \
+    fake_drm.cpp \
+    fake_hwcomposer.cpp \
+    fake_va.cpp \
+    frame_rate_estimator_test.cpp \
+    gpu_boost_manager_test.cpp \
+    gralloc_buffer_mapper_test.cpp \
+    hwc_layer_list_test.cpp \
+    hwc_trace_test.cpp \
+    line_skip_policy_test.cpp \
+    pipe_geometry_test.cpp \
+    rgb_surface_layout_test.cpp \
+    rotation_buffer_provider_test.cpp \
+    underrun_blacklist_test.cpp \
+    va_rotation_test.cpp \
+    ../common/base/DeferredWorkQueue.cpp \
+    ../common/base/DisplayAnalyzer.cpp \
+    ../common/base/GpuBoostManager.cpp \
+    ../common/base/HwcLayer.cpp \
+    ../common/base/HwcLayerList.cpp \
+    ../common/buffers/BufferCache.cpp \
+    ../common/buffers/BufferManager.cpp \
+    ../common/buffers/GraphicBuffer.cpp \
+    ../common/planes/DisplayPlane.cpp \
+    ../common/planes/DisplayPlaneManager.cpp \
+    ../common/utils/AnimationDetector.cpp \
+    ../common/utils/BandwidthEstimator.cpp \
+    ../common/utils/Dump.cpp \
+    ../common/utils/FrameRateEstimator.cpp \
+    ../common/utils/HwcTrace.cpp \
+    ../common/utils/PipeGeometry.cpp \
+    ../common/utils/UnderrunBlacklist.cpp \
+    ../common/utils/VaRotation.cpp \
+    ../ips/common/DirtyLineWriter.cpp \
+    ../ips/common/GrallocBufferMapperBase.cpp \
+    ../ips/common/LineSkipPolicy.cpp \
+    ../ips/common/PlaneCapabilities.cpp \
+    ../ips/common/RgbSurfaceLayout.cpp \
+    ../ips/common/RotationBufferProvider.cpp \
+    ../ips/tangier/TngDisplayQuery.cpp \
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libhardware \
+	libsync \
+	libutils \
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/../include \
+    $(LOCAL_PATH)/../include/pvr/hal \
+    $(LOCAL_PATH)/../common/base \
+    $(LOCAL_PATH)/../common/buffers \
+    $(LOCAL_PATH)/../common/devices \
+    $(LOCAL_PATH)/../common/observers \
+    $(LOCAL_PATH)/../common/planes \
+    $(LOCAL_PATH)/../common/utils \
+    $(LOCAL_PATH)/../ips \
+    $(call include-path-for, frameworks-native)/media/openmax \
+    $(TARGET_OUT_HEADERS)/khronos/openmax \
+    $(TARGET_OUT_HEADERS)/drm \
+    $(TARGET_OUT_HEADERS)/libdrm \
+    $(TARGET_OUT_HEADERS)/libdrm/shared-core \
+    $(TARGET_OUT_HEADERS)/libttm \
+    $(TARGET_OUT_HEADERS)/libva \
+
+ifeq ($(TARGET_HAS_MULTIPLE_DISPLAY),true)
+   LOCAL_SHARED_LIBRARIES += libmultidisplay libbinder
+   LOCAL_CFLAGS += -DTARGET_HAS_MULTIPLE_DISPLAY
+endif
+
+include $(BUILD_NATIVE_TEST)
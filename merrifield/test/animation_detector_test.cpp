@@ -0,0 +1,225 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <hal_public.h>
+#include <AnimationDetector.h>
+#include <HwcLayerList.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// an app window sliding in over the wallpaper below the status bar, as
+// recorded from surface flinger at 60 fps
+class AnimationDetectorTest : public ::testing::Test {
+protected:
+    enum {
+        LAYER_COUNT = 4,
+        WALLPAPER_LAYER = 0,
+        APP_LAYER = 1,
+        STATUS_BAR_LAYER = 2,
+        TARGET_LAYER = 3,
+        // frame interval in microseconds
+        FRAME_US = 16667,
+    };
+
+    virtual void SetUp() {
+        FakeHwcomposer& hwc = FakeHwcomposer::get();
+        hwc.reset();
+        mDisplay = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + LAYER_COUNT * sizeof(hwc_layer_1_t));
+        mDisplay->numHwLayers = LAYER_COUNT;
+
+        const hwc_rect_t full = {0, 0, 1920, 1080};
+        const hwc_rect_t bar = {0, 0, 1920, 48};
+        setLayer(WALLPAPER_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080),
+                1920, 1080, full, HWC_BLENDING_NONE);
+        setLayer(APP_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080),
+                1920, 1080, full, HWC_BLENDING_PREMULT);
+        setLayer(STATUS_BAR_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 48),
+                1920, 48, bar, HWC_BLENDING_PREMULT);
+        setLayer(TARGET_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080),
+                1920, 1080, full, HWC_BLENDING_NONE);
+        mDisplay->hwLayers[TARGET_LAYER].compositionType = HWC_FRAMEBUFFER_TARGET;
+
+        mList = NULL;
+        mNow = 0;
+    }
+
+    virtual void TearDown() {
+        delete mList;
+        free(mDisplay);
+    }
+
+    void setLayer(int index, buffer_handle_t handle, int width, int height,
+                  const hwc_rect_t& frame, int32_t blending) {
+        hwc_layer_1_t& layer = mDisplay->hwLayers[index];
+        layer.compositionType = HWC_FRAMEBUFFER;
+        layer.handle = handle;
+        layer.blending = blending;
+        layer.planeAlpha = 0xff;
+        layer.sourceCropf.right = width;
+        layer.sourceCropf.bottom = height;
+        layer.displayFrame = frame;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+    }
+
+    void nextFrame(bool geometryChanged) {
+        mNow += us2ns(FRAME_US);
+        mDisplay->flags = geometryChanged ? HWC_GEOMETRY_CHANGED : 0;
+        if (geometryChanged) {
+            for (int i = 0; i < TARGET_LAYER; i++) {
+                mDisplay->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+            }
+        }
+    }
+
+    // what PhysicalDevice does for one frame, with or without the detector
+    void prepare(bool detect) {
+        if (detect) {
+            mDetector.update(mDisplay, mNow);
+            if (mList && mList->isAnimating() && !mDetector.isAnimating() &&
+                !(mDisplay->flags & HWC_GEOMETRY_CHANGED)) {
+                mList->resetCompositionTypes(mDisplay);
+                delete mList;
+                mList = NULL;
+                mDisplay->flags |= HWC_GEOMETRY_CHANGED;
+            }
+        }
+        if ((mDisplay->flags & HWC_GEOMETRY_CHANGED) && mList) {
+            if (!detect || !mDetector.isAnimating() || !mList->isReusable(mDisplay)) {
+                delete mList;
+                mList = NULL;
+            }
+        }
+        if (!mList) {
+            mList = new HwcLayerList(mDisplay, IDisplayDevice::DEVICE_PRIMARY,
+                    detect && mDetector.isAnimating());
+        }
+        ASSERT_TRUE(mList->update(mDisplay));
+        mList->postFlip();
+    }
+
+    // 300 ms slide of the app window followed by 200 ms of idle frames,
+    // returns the time spent preparing in microseconds
+    int64_t replayTransition(bool detect) {
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        hwc_layer_1_t& app = mDisplay->hwLayers[APP_LAYER];
+        for (int i = 0; i < 18; i++) {
+            nextFrame(true);
+            app.displayFrame.left = 1920 - (i + 1) * 1920 / 18;
+            app.sourceCropf.right = 1920 - app.displayFrame.left;
+            app.displayFrame.right = 1920;
+            prepare(detect);
+        }
+        for (int i = 0; i < 12; i++) {
+            nextFrame(false);
+            prepare(detect);
+        }
+        return ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+    }
+
+protected:
+    hwc_display_contents_1_t *mDisplay;
+    HwcLayerList *mList;
+    AnimationDetector mDetector;
+    nsecs_t mNow;
+};
+
+TEST_F(AnimationDetectorTest, RepeatedGeometryChangesOnSameBuffers)
+{
+    mDisplay->flags = HWC_GEOMETRY_CHANGED;
+    EXPECT_FALSE(mDetector.update(mDisplay, ms2ns(1000)));
+    EXPECT_FALSE(mDetector.update(mDisplay, ms2ns(1016)));
+    EXPECT_FALSE(mDetector.isAnimating());
+    EXPECT_TRUE(mDetector.update(mDisplay, ms2ns(1033)));
+    EXPECT_TRUE(mDetector.isAnimating());
+
+    // still animating within the settle time
+    mDisplay->flags = 0;
+    EXPECT_FALSE(mDetector.update(mDisplay, ms2ns(1100)));
+    EXPECT_TRUE(mDetector.isAnimating());
+
+    // settled
+    EXPECT_TRUE(mDetector.update(mDisplay, ms2ns(1134)));
+    EXPECT_FALSE(mDetector.isAnimating());
+}
+
+TEST_F(AnimationDetectorTest, SlowGeometryChangesAreNoAnimation)
+{
+    mDisplay->flags = HWC_GEOMETRY_CHANGED;
+    for (int i = 0; i < 10; i++) {
+        mDetector.update(mDisplay, ms2ns(1000 + i * 60));
+        EXPECT_FALSE(mDetector.isAnimating());
+    }
+}
+
+TEST_F(AnimationDetectorTest, NewBuffersRestartDetection)
+{
+    mDisplay->flags = HWC_GEOMETRY_CHANGED;
+    mDetector.update(mDisplay, ms2ns(1000));
+    mDetector.update(mDisplay, ms2ns(1016));
+
+    // a window shows up, the count starts again with the new layers
+    buffer_handle_t handle = mDisplay->hwLayers[APP_LAYER].handle;
+    mDisplay->hwLayers[APP_LAYER].handle =
+            FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080);
+    mDetector.update(mDisplay, ms2ns(1033));
+    EXPECT_FALSE(mDetector.isAnimating());
+    mDetector.update(mDisplay, ms2ns(1050));
+    EXPECT_FALSE(mDetector.isAnimating());
+    mDetector.update(mDisplay, ms2ns(1066));
+    EXPECT_TRUE(mDetector.isAnimating());
+
+    // the old buffer coming back is not the same animation either
+    mDisplay->hwLayers[APP_LAYER].handle = handle;
+    mDetector.update(mDisplay, ms2ns(1083));
+    EXPECT_FALSE(mDetector.isAnimating());
+
+    mDetector.reset();
+    EXPECT_FALSE(mDetector.isAnimating());
+}
+
+TEST_F(AnimationDetectorTest, TransitionReplay)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+
+    int64_t baselineUs = replayTransition(false);
+    FakeHwcCounters baseline = hwc.counters;
+    delete mList;
+    mList = NULL;
+
+    memset(&hwc.counters, 0, sizeof(hwc.counters));
+    int64_t detectUs = replayTransition(true);
+    FakeHwcCounters detect = hwc.counters;
+    RecordProperty("baseline_prepare_us", (int)baselineUs);
+    RecordProperty("detect_prepare_us", (int)detectUs);
+
+    // without the detector planes are assigned and buffers set on every
+    // frame of the slide
+    EXPECT_EQ(18, baseline.assignCount);
+
+    // with it the plan is assigned for the two frames before the slide is
+    // recognised, once for the GLES plan and once after it settled
+    EXPECT_EQ(4, detect.assignCount);
+    EXPECT_LT(detect.setBufferCount, baseline.setBufferCount);
+    EXPECT_LE(detect.mapCount, baseline.mapCount);
+    EXPECT_FALSE(mDetector.isAnimating());
+    EXPECT_FALSE(mList->isAnimating());
+}
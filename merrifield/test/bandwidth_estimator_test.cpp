@@ -0,0 +1,76 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <hardware/hwcomposer.h>
+#include <hal_public.h>
+#include <OMX_IntelVideoExt.h>
+
+#include <BandwidthEstimator.h>
+
+using namespace android::intel;
+
+TEST(BandwidthEstimatorTest, Rgb)
+{
+    // 1920 pixels of 32 bits per line, 1080 lines at 60Hz
+    EXPECT_EQ(497u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080, 1080, 1080, 60));
+    EXPECT_EQ(248u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGB_565, 1920, 1080, 1080, 1080, 60));
+}
+
+TEST(BandwidthEstimatorTest, Video)
+{
+    // 4:2:0 formats fetch 12 bits per pixel
+    EXPECT_EQ(186u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_NV12, 1920, 1080, 1080, 1080, 60));
+    EXPECT_EQ(186u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_YV12, 1920, 1080, 1080, 1080, 60));
+    EXPECT_EQ(186u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_I420, 1920, 1080, 1080, 1080, 60));
+    EXPECT_EQ(186u, BandwidthEstimator::getPlaneBandwidth(
+            OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar, 1920, 1080, 1080, 1080, 60));
+    EXPECT_EQ(248u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_YCbCr_422_I, 1920, 1080, 1080, 1080, 60));
+}
+
+TEST(BandwidthEstimatorTest, Scaling)
+{
+    // a 2x vertical downscale fetches two source lines per output line,
+    // twice the rate of the 1080p case
+    EXPECT_EQ(995u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 2160, 1080, 1080, 60));
+
+    // upscaling repeats lines without fetching more of them
+    EXPECT_EQ(124u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 960, 540, 1080, 1080, 30));
+    EXPECT_EQ(248u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 960, 540, 1080, 1080, 60));
+}
+
+TEST(BandwidthEstimatorTest, InvalidInput)
+{
+    EXPECT_EQ(0u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 0, 1080, 1080, 1080, 60));
+    EXPECT_EQ(0u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 0, 1080, 1080, 60));
+    EXPECT_EQ(0u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080, 0, 1080, 60));
+    EXPECT_EQ(0u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080, 1080, 0, 60));
+    EXPECT_EQ(0u, BandwidthEstimator::getPlaneBandwidth(
+            HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080, 1080, 1080, 0));
+}
@@ -0,0 +1,216 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/sw_sync.h>
+#include <sync/sync.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// software sync timeline standing in for GLES or a display pipe
+class Timeline {
+public:
+    Timeline()
+        : mFd(open("/dev/sw_sync", O_RDWR)),
+          mValue(0)
+    {
+    }
+    ~Timeline() {
+        if (mFd >= 0) {
+            close(mFd);
+        }
+    }
+
+    bool initCheck() const { return mFd >= 0; }
+
+    // fence signaled by the next advance
+    int createFence() {
+        struct sw_sync_create_fence_data data;
+        memset(&data, 0, sizeof(data));
+        data.value = mValue + 1;
+        strcpy(data.name, "hwc_test");
+        if (ioctl(mFd, SW_SYNC_IOC_CREATE_FENCE, &data) < 0) {
+            return -1;
+        }
+        return data.fence;
+    }
+
+    void advance() {
+        __u32 count = 1;
+        ioctl(mFd, SW_SYNC_IOC_INC, &count);
+        mValue++;
+    }
+
+private:
+    int mFd;
+    uint32_t mValue;
+};
+
+static bool isSignaled(int fence)
+{
+    return sync_wait(fence, 0) == 0;
+}
+
+static bool isOpen(int fd)
+{
+    return fcntl(fd, F_GETFD) != -1 || errno != EBADF;
+}
+
+// frame buffer target of the primary and its clone on the external pipe
+class CloneFenceTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ASSERT_TRUE(mGles.initCheck());
+        ASSERT_TRUE(mPrimaryPipe.initCheck());
+        ASSERT_TRUE(mExternalPipe.initCheck());
+        memset(&mSource, 0, sizeof(mSource));
+        memset(&mTarget, 0, sizeof(mTarget));
+        mSource.acquireFenceFd = -1;
+        mSource.releaseFenceFd = -1;
+        mTarget.acquireFenceFd = -1;
+        mTarget.releaseFenceFd = -1;
+    }
+
+    virtual void TearDown() {
+        closeFence(mSource.acquireFenceFd);
+        closeFence(mSource.releaseFenceFd);
+        closeFence(mTarget.acquireFenceFd);
+        closeFence(mTarget.releaseFenceFd);
+    }
+
+    static void closeFence(int& fence) {
+        if (fence != -1) {
+            close(fence);
+            fence = -1;
+        }
+    }
+
+protected:
+    Timeline mGles;
+    Timeline mPrimaryPipe;
+    Timeline mExternalPipe;
+    hwc_layer_1_t mSource;
+    hwc_layer_1_t mTarget;
+};
+
+TEST_F(CloneFenceTest, ExternalWaitsForGles)
+{
+    // fence SF set on the external target for its own, unused composition,
+    // its fd number may be reused by the dup
+    mTarget.acquireFenceFd = mGles.createFence();
+    mSource.acquireFenceFd = mGles.createFence();
+
+    DisplayAnalyzer::shareAcquireFence(mSource, mTarget);
+    ASSERT_NE(-1, mTarget.acquireFenceFd);
+    EXPECT_NE(mSource.acquireFenceFd, mTarget.acquireFenceFd);
+
+    // both pipes wait for the same GLES pass, each owns its fd
+    EXPECT_FALSE(isSignaled(mTarget.acquireFenceFd));
+    mGles.advance();
+    EXPECT_TRUE(isSignaled(mTarget.acquireFenceFd));
+    EXPECT_TRUE(isSignaled(mSource.acquireFenceFd));
+}
+
+TEST_F(CloneFenceTest, NoGlesFenceClearsStaleOne)
+{
+    int stale = mGles.createFence();
+    mTarget.acquireFenceFd = stale;
+
+    DisplayAnalyzer::shareAcquireFence(mSource, mTarget);
+    EXPECT_EQ(-1, mTarget.acquireFenceFd);
+    EXPECT_FALSE(isOpen(stale));
+}
+
+TEST_F(CloneFenceTest, PrimaryTargetWaitsForBothPipes)
+{
+    int primaryFence = mPrimaryPipe.createFence();
+    mSource.releaseFenceFd = primaryFence;
+    mTarget.releaseFenceFd = mExternalPipe.createFence();
+
+    DisplayAnalyzer::mergeReleaseFence(mSource, mTarget);
+    ASSERT_NE(-1, mSource.releaseFenceFd);
+    EXPECT_NE(primaryFence, mSource.releaseFenceFd);
+    EXPECT_NE(-1, mTarget.releaseFenceFd);
+
+    // SF may reuse the buffer once the slower pipe is done, in any order
+    mPrimaryPipe.advance();
+    EXPECT_FALSE(isSignaled(mSource.releaseFenceFd));
+    mExternalPipe.advance();
+    EXPECT_TRUE(isSignaled(mSource.releaseFenceFd));
+}
+
+TEST_F(CloneFenceTest, ExternalPipeOnly)
+{
+    // primary target was not posted, only the external pipe holds it
+    mTarget.releaseFenceFd = mExternalPipe.createFence();
+
+    DisplayAnalyzer::mergeReleaseFence(mSource, mTarget);
+    ASSERT_NE(-1, mSource.releaseFenceFd);
+    EXPECT_NE(mTarget.releaseFenceFd, mSource.releaseFenceFd);
+    EXPECT_FALSE(isSignaled(mSource.releaseFenceFd));
+    mExternalPipe.advance();
+    EXPECT_TRUE(isSignaled(mSource.releaseFenceFd));
+}
+
+TEST_F(CloneFenceTest, NoExternalFence)
+{
+    int primaryFence = mPrimaryPipe.createFence();
+    mSource.releaseFenceFd = primaryFence;
+
+    DisplayAnalyzer::mergeReleaseFence(mSource, mTarget);
+    EXPECT_EQ(primaryFence, mSource.releaseFenceFd);
+}
+
+TEST_F(CloneFenceTest, UntouchedOutsideCloneMode)
+{
+    DisplayAnalyzer *analyzer = FakeHwcomposer::get().getDisplayAnalyzer();
+    analyzer->initialize();
+    ASSERT_FALSE(analyzer->isCloneModeActive());
+
+    hwc_display_contents_1_t *displays[IDisplayDevice::DEVICE_COUNT];
+    memset(displays, 0, sizeof(displays));
+    for (int i = 0; i <= IDisplayDevice::DEVICE_EXTERNAL; i++) {
+        displays[i] = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + sizeof(hwc_layer_1_t));
+        displays[i]->numHwLayers = 1;
+    }
+
+    int acquireFence = mGles.createFence();
+    int releaseFence = mExternalPipe.createFence();
+    displays[IDisplayDevice::DEVICE_PRIMARY]->hwLayers[0].acquireFenceFd = acquireFence;
+    displays[IDisplayDevice::DEVICE_PRIMARY]->hwLayers[0].releaseFenceFd = -1;
+    displays[IDisplayDevice::DEVICE_EXTERNAL]->hwLayers[0].acquireFenceFd = -1;
+    displays[IDisplayDevice::DEVICE_EXTERNAL]->hwLayers[0].releaseFenceFd = releaseFence;
+
+    // each device keeps the fences of its own frame buffer target
+    analyzer->cloneAcquireFence(IDisplayDevice::DEVICE_COUNT, displays);
+    analyzer->mergeCloneReleaseFence(IDisplayDevice::DEVICE_COUNT, displays);
+    EXPECT_EQ(-1, displays[IDisplayDevice::DEVICE_EXTERNAL]->hwLayers[0].acquireFenceFd);
+    EXPECT_EQ(-1, displays[IDisplayDevice::DEVICE_PRIMARY]->hwLayers[0].releaseFenceFd);
+
+    close(acquireFence);
+    close(releaseFence);
+    for (int i = 0; i <= IDisplayDevice::DEVICE_EXTERNAL; i++) {
+        free(displays[i]);
+    }
+    analyzer->deinitialize();
+}
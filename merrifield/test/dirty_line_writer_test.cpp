@@ -0,0 +1,174 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <malloc.h>
+#include <stdint.h>
+#include <string.h>
+#include <utils/Timers.h>
+#include <common/OverlayHardware.h>
+#include <common/DirtyLineWriter.h>
+
+using namespace android;
+using namespace android::intel;
+
+// an overlay register image, its copy and a simulated TTM buffer. lines of
+// the TTM buffer the writer must not touch are poisoned
+class DirtyLineWriterTest : public ::testing::Test {
+protected:
+    enum {
+        SIZE = sizeof(OverlayBackBufferBlk),
+        LINES = SIZE / DirtyLineWriter::LINE_SIZE,
+        POISON = 0xa5,
+    };
+
+    virtual void SetUp() {
+        mImage = (OverlayBackBufferBlk *)memalign(DirtyLineWriter::LINE_SIZE, SIZE);
+        mCopy = memalign(DirtyLineWriter::LINE_SIZE, SIZE);
+        mTtm = (uint8_t *)memalign(4096, SIZE);
+        for (int i = 0; i < SIZE; i++) {
+            ((uint8_t *)mImage)[i] = i * 7;
+        }
+        memset(mCopy, 0, SIZE);
+        memset(mTtm, 0, SIZE);
+    }
+
+    virtual void TearDown() {
+        free(mImage);
+        free(mCopy);
+        free(mTtm);
+    }
+
+    int write(bool stale) {
+        return DirtyLineWriter::write(mImage, mCopy, mTtm, SIZE, stale);
+    }
+
+    void poison() {
+        memset(mTtm, POISON, SIZE);
+    }
+
+    bool isWritten(int line) {
+        int off = line * DirtyLineWriter::LINE_SIZE;
+        return !memcmp(mTtm + off, (uint8_t *)mImage + off, DirtyLineWriter::LINE_SIZE);
+    }
+
+    bool isPoisoned(int line) {
+        uint8_t *p = mTtm + line * DirtyLineWriter::LINE_SIZE;
+        for (int i = 0; i < DirtyLineWriter::LINE_SIZE; i++) {
+            if (p[i] != POISON)
+                return false;
+        }
+        return true;
+    }
+
+    static int lineOf(const void *field, const void *base) {
+        return ((const uint8_t *)field - (const uint8_t *)base) / DirtyLineWriter::LINE_SIZE;
+    }
+
+protected:
+    OverlayBackBufferBlk *mImage;
+    void *mCopy;
+    uint8_t *mTtm;
+};
+
+TEST_F(DirtyLineWriterTest, StaleWritesEverything)
+{
+    EXPECT_EQ(LINES, write(true));
+    EXPECT_EQ(0, memcmp(mTtm, mImage, SIZE));
+    EXPECT_EQ(0, memcmp(mCopy, mImage, SIZE));
+}
+
+TEST_F(DirtyLineWriterTest, UnchangedImageWritesNothing)
+{
+    write(true);
+    poison();
+    EXPECT_EQ(0, write(false));
+    for (int i = 0; i < LINES; i++) {
+        EXPECT_TRUE(isPoisoned(i)) << "line " << i;
+    }
+}
+
+TEST_F(DirtyLineWriterTest, OnlyChangedLinesAreWritten)
+{
+    write(true);
+    poison();
+    mImage->OSTART_0Y += 4096;
+    mImage->Y_HCOEFS[0] ^= 1;
+
+    int first = lineOf(&mImage->OSTART_0Y, mImage);
+    int second = lineOf(&mImage->Y_HCOEFS[0], mImage);
+    EXPECT_EQ(2, write(false));
+    for (int i = 0; i < LINES; i++) {
+        if (i == first || i == second) {
+            EXPECT_TRUE(isWritten(i)) << "line " << i;
+        } else {
+            EXPECT_TRUE(isPoisoned(i)) << "line " << i;
+        }
+    }
+}
+
+TEST_F(DirtyLineWriterTest, WrittenLinesAreComparedAgainstLastWrite)
+{
+    write(true);
+    mImage->DWINPOS = 0x100010;
+    EXPECT_EQ(1, write(false));
+
+    // set back to what the TTM buffer had before
+    mImage->DWINPOS = 0;
+    EXPECT_EQ(1, write(false));
+    EXPECT_EQ(0, memcmp(mTtm, mImage, SIZE));
+}
+
+// 300 frames of video, each flip programs the buffer addresses and start
+// offsets of the next decoded frame
+TEST_F(DirtyLineWriterTest, VideoFlipReplay)
+{
+    enum {
+        FRAME_COUNT = 300,
+    };
+    memset(mImage, 0, SIZE);
+    write(true);
+
+    int lines = 0;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        uint32_t gtt = (i % 20) << 20;
+        mImage->OBUF_0Y = gtt;
+        mImage->OBUF_0U = gtt + 0xe1000;
+        mImage->OBUF_0V = gtt + 0xe1000;
+        mImage->OSTART_0Y = gtt;
+        mImage->OSTART_0U = gtt + 0xe1000;
+        mImage->OSTART_0V = gtt + 0xe1000;
+        mImage->OCMD ^= 1 << 2;
+        lines += write(false);
+    }
+    int64_t dirtyUs = ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+
+    // what the display reads, written out whole on every flip
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        mImage->OCMD ^= 1 << 2;
+        memcpy(mTtm, mImage, SIZE);
+    }
+    int64_t fullUs = ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+
+    RecordProperty("dirty_write_us", (int)dirtyUs);
+    RecordProperty("full_write_us", (int)fullUs);
+    RecordProperty("lines_per_flip", lines / FRAME_COUNT);
+
+    // the buffer registers and start offsets take two lines of the image
+    EXPECT_EQ(2 * FRAME_COUNT, lines);
+}
@@ -0,0 +1,276 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <hal_public.h>
+#include <OMX_IVCommon.h>
+#include <OMX_IntelVideoExt.h>
+#include <HwcLayerList.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// video playback states as sent by the multi display service
+enum {
+    VIDEO_PLAYBACK_STARTING = 1,
+    VIDEO_PLAYBACK_STARTED = 2,
+};
+
+class DisplayAnalyzerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        FakeHwcomposer::get().reset();
+        mAnalyzer = FakeHwcomposer::get().getDisplayAnalyzer();
+        mAnalyzer->initialize();
+        memset(mDisplays, 0, sizeof(mDisplays));
+    }
+
+    virtual void TearDown() {
+        mAnalyzer->deinitialize();
+        for (int i = 0; i < IDisplayDevice::DEVICE_COUNT; i++) {
+            free(mDisplays[i]);
+        }
+    }
+
+    hwc_display_contents_1_t* createDisplay(int disp, size_t count) {
+        hwc_display_contents_1_t *display = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + count * sizeof(hwc_layer_1_t));
+        display->numHwLayers = count;
+        display->flags = HWC_GEOMETRY_CHANGED;
+        display->retireFenceFd = -1;
+        mDisplays[disp] = display;
+        return display;
+    }
+
+    static void setLayer(hwc_layer_1_t& layer, buffer_handle_t handle,
+                         int width, int height, const hwc_rect_t& frame) {
+        layer.compositionType = HWC_FRAMEBUFFER;
+        layer.handle = handle;
+        layer.blending = HWC_BLENDING_NONE;
+        layer.planeAlpha = 0xff;
+        layer.sourceCropf.right = width;
+        layer.sourceCropf.bottom = height;
+        layer.displayFrame = frame;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+    }
+
+    void analyze() {
+        mAnalyzer->analyzeContents(IDisplayDevice::DEVICE_COUNT, mDisplays);
+    }
+
+protected:
+    DisplayAnalyzer *mAnalyzer;
+    hwc_display_contents_1_t *mDisplays[IDisplayDevice::DEVICE_COUNT];
+};
+
+// video playing on the primary panel while HDMI shows something else
+class VideoCheckTest : public DisplayAnalyzerTest {
+protected:
+    virtual void SetUp() {
+        DisplayAnalyzerTest::SetUp();
+        FakeHwcomposer& hwc = FakeHwcomposer::get();
+        mVideo = hwc.addBuffer(OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+                1280, 720);
+        mUi = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080);
+        mTarget = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080);
+
+        const hwc_rect_t full = {0, 0, 1920, 1080};
+        for (int disp = 0; disp <= IDisplayDevice::DEVICE_EXTERNAL; disp++) {
+            hwc_display_contents_1_t *display = createDisplay(disp, 2);
+            setLayer(display->hwLayers[0], mUi, 1920, 1080, full);
+            setLayer(display->hwLayers[1], mTarget, 1920, 1080, full);
+            display->hwLayers[1].compositionType = HWC_FRAMEBUFFER_TARGET;
+        }
+    }
+
+protected:
+    buffer_handle_t mVideo;
+    buffer_handle_t mUi;
+    buffer_handle_t mTarget;
+};
+
+TEST_F(VideoCheckTest, RetriesWithoutInvalidate)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+    mAnalyzer->postVideoEvent(1, VIDEO_PLAYBACK_STARTED);
+    analyze();
+
+    // the video is not on HDMI yet, checks are retried by the deadline
+    // thread while video frames keep composition going
+    hwc_display_contents_1_t *external = mDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+    external->hwLayers[0].handle = mVideo;
+    external->flags = 0;
+    usleep(350 * 1000);
+    EXPECT_EQ(0, hwc.counters.invalidateCount);
+
+    // the next frame picks up the posted check
+    analyze();
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[0]));
+
+    // no more checks once the video is found
+    usleep(250 * 1000);
+    analyze();
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[0]));
+    EXPECT_EQ(0, hwc.counters.invalidateCount);
+}
+
+TEST_F(VideoCheckTest, DeinitializeDoesNotWaitForDeadline)
+{
+    mAnalyzer->postVideoEvent(1, VIDEO_PLAYBACK_STARTED);
+    analyze();
+
+    // the pending check is dropped, the thread is woken up to exit
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    mAnalyzer->deinitialize();
+    EXPECT_LT(systemTime(SYSTEM_TIME_MONOTONIC) - start, ms2ns(50));
+    EXPECT_EQ(0, FakeHwcomposer::get().counters.invalidateCount);
+    mAnalyzer->initialize();
+}
+
+#ifdef TARGET_HAS_MULTIPLE_DISPLAY
+
+// picture in picture: a full screen movie with a second video on top of
+// it, mirrored to HDMI
+class TwoVideoSessionsTest : public DisplayAnalyzerTest {
+protected:
+    enum {
+        MOVIE_LAYER = 0,
+        PIP_LAYER = 1,
+        UI_LAYER = 2,
+        TARGET_LAYER = 3,
+        LAYER_COUNT = 4,
+    };
+
+    virtual void SetUp() {
+        DisplayAnalyzerTest::SetUp();
+        FakeHwcomposer& hwc = FakeHwcomposer::get();
+        mMovie = hwc.addBuffer(OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+                1280, 720);
+        mPip = hwc.addBuffer(OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+                640, 360);
+        mUi = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080);
+        mTarget = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080);
+
+        const hwc_rect_t full = {0, 0, 1920, 1080};
+        const hwc_rect_t corner = {1280, 720, 1760, 990};
+        for (int disp = 0; disp <= IDisplayDevice::DEVICE_EXTERNAL; disp++) {
+            hwc_display_contents_1_t *display = createDisplay(disp, LAYER_COUNT);
+            setLayer(display->hwLayers[MOVIE_LAYER], mMovie, 1280, 720, full);
+            setLayer(display->hwLayers[PIP_LAYER], mPip, 640, 360, corner);
+            setLayer(display->hwLayers[UI_LAYER], mUi, 1920, 1080, full);
+            display->hwLayers[UI_LAYER].blending = HWC_BLENDING_PREMULT;
+            setLayer(display->hwLayers[TARGET_LAYER], mTarget, 1920, 1080, full);
+            display->hwLayers[TARGET_LAYER].compositionType = HWC_FRAMEBUFFER_TARGET;
+        }
+    }
+
+    void startSession(int instanceID) {
+        VideoSourceInfo info;
+        memset(&info, 0, sizeof(info));
+        info.width = 1280;
+        info.height = 720;
+        info.frameRate = 30;
+        FakeHwcomposer::get().videoSessions.add(instanceID, info);
+
+        // one event is handled per frame
+        mAnalyzer->postVideoEvent(instanceID, VIDEO_PLAYBACK_STARTING);
+        analyze();
+        mAnalyzer->postVideoEvent(instanceID, VIDEO_PLAYBACK_STARTED);
+        analyze();
+    }
+
+    void startSessions() {
+        startSession(1);
+        startSession(2);
+    }
+
+protected:
+    buffer_handle_t mMovie;
+    buffer_handle_t mPip;
+    buffer_handle_t mUi;
+    buffer_handle_t mTarget;
+};
+
+TEST_F(TwoVideoSessionsTest, EachSessionGetsAnOverlay)
+{
+    startSessions();
+    ASSERT_EQ(2, mAnalyzer->getVideoInstances());
+    ASSERT_TRUE(mAnalyzer->isOverlayAllowed());
+
+    hwc_display_contents_1_t *primary = mDisplays[IDisplayDevice::DEVICE_PRIMARY];
+    HwcLayerList *list = new HwcLayerList(primary, IDisplayDevice::DEVICE_PRIMARY, false);
+    ASSERT_TRUE(list->update(primary));
+
+    DisplayPlane *movie = list->getPlane(MOVIE_LAYER);
+    DisplayPlane *pip = list->getPlane(PIP_LAYER);
+    ASSERT_TRUE(movie != NULL);
+    ASSERT_TRUE(pip != NULL);
+    EXPECT_EQ(DisplayPlane::PLANE_OVERLAY, movie->getType());
+    EXPECT_EQ(DisplayPlane::PLANE_OVERLAY, pip->getType());
+    EXPECT_NE(movie, pip);
+    EXPECT_EQ(HWC_OVERLAY, primary->hwLayers[MOVIE_LAYER].compositionType);
+    EXPECT_EQ(HWC_OVERLAY, primary->hwLayers[PIP_LAYER].compositionType);
+    delete list;
+}
+
+TEST_F(TwoVideoSessionsTest, SkipFlagIsTrackedPerSession)
+{
+    // the picture in picture video is composed by surface flinger on
+    // HDMI when it shows up there
+    hwc_display_contents_1_t *external = mDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+    external->hwLayers[PIP_LAYER].flags |= HWC_SKIP_LAYER;
+    startSessions();
+
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[MOVIE_LAYER]));
+    EXPECT_FALSE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[PIP_LAYER]));
+
+    // rotation marks the movie skipped as well, its flag is still ignored
+    external->hwLayers[MOVIE_LAYER].flags |= HWC_SKIP_LAYER;
+    external->flags = 0;
+    analyze();
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[MOVIE_LAYER]));
+    EXPECT_FALSE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[PIP_LAYER]));
+
+    // layers of the primary device are never skipped by this workaround
+    hwc_display_contents_1_t *primary = mDisplays[IDisplayDevice::DEVICE_PRIMARY];
+    EXPECT_FALSE(mAnalyzer->ignoreVideoSkipFlag(primary->hwLayers[MOVIE_LAYER]));
+}
+
+TEST_F(TwoVideoSessionsTest, LateSessionIsCheckedWhenItShowsUp)
+{
+    // only the movie is mirrored yet
+    hwc_display_contents_1_t *external = mDisplays[IDisplayDevice::DEVICE_EXTERNAL];
+    hwc_layer_1_t pip = external->hwLayers[PIP_LAYER];
+    external->hwLayers[PIP_LAYER].handle = mUi;
+    startSessions();
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[MOVIE_LAYER]));
+    EXPECT_FALSE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[PIP_LAYER]));
+
+    // the check is run again, by the deadline thread on the device and by
+    // the next video event here
+    external->hwLayers[PIP_LAYER] = pip;
+    external->flags = 0;
+    mAnalyzer->postVideoEvent(2, VIDEO_PLAYBACK_STARTED);
+    analyze();
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[MOVIE_LAYER]));
+    EXPECT_TRUE(mAnalyzer->ignoreVideoSkipFlag(external->hwLayers[PIP_LAYER]));
+}
+
+#endif // TARGET_HAS_MULTIPLE_DISPLAY
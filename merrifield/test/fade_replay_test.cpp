@@ -0,0 +1,151 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <hal_public.h>
+#include <HwcLayerList.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// fade in and out of the video controls over a playing video, the video
+// itself fading in at start of playback
+class FadeReplayTest : public ::testing::Test {
+protected:
+    enum {
+        LAYER_COUNT = 3,
+        VIDEO_LAYER = 0,
+        CONTROLS_LAYER = 1,
+        TARGET_LAYER = 2,
+    };
+
+    virtual void SetUp() {
+        FakeHwcomposer& hwc = FakeHwcomposer::get();
+        hwc.reset();
+        mDisplay = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + LAYER_COUNT * sizeof(hwc_layer_1_t));
+        mDisplay->numHwLayers = LAYER_COUNT;
+        mVideo = hwc.addBuffer(HAL_PIXEL_FORMAT_NV12, 1280, 720);
+        mControls = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 200);
+        mTarget = hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080);
+
+        const hwc_rect_t full = {0, 0, 1920, 1080};
+        const hwc_rect_t bottom = {0, 880, 1920, 1080};
+        setLayer(VIDEO_LAYER, mVideo, 1280, 720, full, HWC_BLENDING_NONE);
+        setLayer(CONTROLS_LAYER, mControls, 1920, 200, bottom, HWC_BLENDING_PREMULT);
+        setLayer(TARGET_LAYER, mTarget, 1920, 1080, full, HWC_BLENDING_NONE);
+        mDisplay->hwLayers[TARGET_LAYER].compositionType = HWC_FRAMEBUFFER_TARGET;
+        mList = NULL;
+        memset(mFallbacks, 0, sizeof(mFallbacks));
+    }
+
+    virtual void TearDown() {
+        delete mList;
+        free(mDisplay);
+    }
+
+    void setLayer(int index, buffer_handle_t handle, int width, int height,
+                  const hwc_rect_t& frame, int32_t blending) {
+        hwc_layer_1_t& layer = mDisplay->hwLayers[index];
+        layer.compositionType = HWC_FRAMEBUFFER;
+        layer.handle = handle;
+        layer.blending = blending;
+        layer.planeAlpha = 0xff;
+        layer.sourceCropf.right = width;
+        layer.sourceCropf.bottom = height;
+        layer.displayFrame = frame;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+    }
+
+    // one frame as surface flinger and PhysicalDevice run it, layers left
+    // to GLES are counted
+    void frame(int index, uint8_t planeAlpha, bool geometryChanged) {
+        mDisplay->hwLayers[index].planeAlpha = planeAlpha;
+        mDisplay->flags = geometryChanged ? HWC_GEOMETRY_CHANGED : 0;
+        if (geometryChanged || !mList) {
+            for (int i = 0; i < TARGET_LAYER; i++) {
+                mDisplay->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+            }
+            delete mList;
+            mList = new HwcLayerList(mDisplay, IDisplayDevice::DEVICE_PRIMARY, false);
+        }
+        ASSERT_TRUE(mList->update(mDisplay));
+        mList->postFlip();
+
+        for (int i = 0; i < TARGET_LAYER; i++) {
+            if (mDisplay->hwLayers[i].compositionType == HWC_FRAMEBUFFER) {
+                mFallbacks[i]++;
+            }
+        }
+    }
+
+    // 0 to 255 in eight steps and back, 17 frames
+    void fade(int index, bool geometryChanged) {
+        for (int alpha = 0; alpha < 0xff; alpha += 32) {
+            frame(index, alpha, geometryChanged);
+        }
+        frame(index, 0xff, geometryChanged);
+        for (int alpha = 224; alpha >= 0; alpha -= 32) {
+            frame(index, alpha, geometryChanged);
+        }
+    }
+
+protected:
+    hwc_display_contents_1_t *mDisplay;
+    HwcLayerList *mList;
+    buffer_handle_t mVideo;
+    buffer_handle_t mControls;
+    buffer_handle_t mTarget;
+    int mFallbacks[TARGET_LAYER];
+};
+
+TEST_F(FadeReplayTest, VideoFadeStaysOnOverlay)
+{
+    fade(VIDEO_LAYER, true);
+    EXPECT_EQ(0, mFallbacks[VIDEO_LAYER]);
+    EXPECT_EQ(HWC_OVERLAY, mDisplay->hwLayers[VIDEO_LAYER].compositionType);
+}
+
+TEST_F(FadeReplayTest, ControlsFadeKeepsPlan)
+{
+    // the controls show up fully transparent and fade without a geometry
+    // change, the plane set up for them is kept for the whole fade
+    frame(CONTROLS_LAYER, 0, true);
+    fade(CONTROLS_LAYER, false);
+    EXPECT_EQ(0, mFallbacks[VIDEO_LAYER]);
+    EXPECT_EQ(0, mFallbacks[CONTROLS_LAYER]);
+}
+
+TEST_F(FadeReplayTest, ControlsFadeWithGeometryChanges)
+{
+    // animated controls change geometry every frame. a premultiplied
+    // sprite needs a plane alpha of 0 or 255 on Tangier, the 14 frames in
+    // between are composed by GLES
+    fade(CONTROLS_LAYER, true);
+    EXPECT_EQ(0, mFallbacks[VIDEO_LAYER]);
+    EXPECT_EQ(14, mFallbacks[CONTROLS_LAYER]);
+}
+
+TEST_F(FadeReplayTest, OpaqueControlsFadeStaysOnSprite)
+{
+    mDisplay->hwLayers[CONTROLS_LAYER].blending = HWC_BLENDING_NONE;
+    fade(CONTROLS_LAYER, true);
+    EXPECT_EQ(0, mFallbacks[VIDEO_LAYER]);
+    EXPECT_EQ(0, mFallbacks[CONTROLS_LAYER]);
+}
@@ -0,0 +1,194 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <string.h>
+#include <hal_public.h>
+#include <Drm.h>
+#include <DrmConfig.h>
+#include <IDisplayDevice.h>
+#include "fake_hwcomposer.h"
+
+namespace android {
+namespace intel {
+
+// a connected 1080p panel on the primary pipe and nothing else, requests
+// to the kernel all succeed. gtt mappings are counted and get pages from
+// a linear allocator
+
+static uint32_t sNextGttPage = 0;
+
+Drm::Drm()
+    : mDrmFd(-1),
+      mLock(),
+      mInitialized(false)
+{
+    memset(mOutputs, 0, sizeof(mOutputs));
+    mOutputs[OUTPUT_PRIMARY].connected = 1;
+    mOutputs[OUTPUT_PRIMARY].mode.hdisplay = 1920;
+    mOutputs[OUTPUT_PRIMARY].mode.vdisplay = 1080;
+    mOutputs[OUTPUT_PRIMARY].mode.vrefresh = 60;
+}
+
+Drm::~Drm()
+{
+}
+
+bool Drm::initialize()
+{
+    mInitialized = true;
+    return true;
+}
+
+void Drm::deinitialize()
+{
+    mInitialized = false;
+}
+
+bool Drm::detect(int device)
+{
+    return isConnected(device);
+}
+
+bool Drm::isSameDrmMode(drmModeModeInfoPtr value, drmModeModeInfoPtr base) const
+{
+    return value->hdisplay == base->hdisplay &&
+           value->vdisplay == base->vdisplay &&
+           value->vrefresh == base->vrefresh;
+}
+
+bool Drm::setDrmMode(int device, drmModeModeInfo& value)
+{
+    int output = getOutputIndex(device);
+    if (output < 0) {
+        return false;
+    }
+    mOutputs[output].mode = value;
+    return true;
+}
+
+bool Drm::setRefreshRate(int device, int hz)
+{
+    int output = getOutputIndex(device);
+    if (output < 0) {
+        return false;
+    }
+    mOutputs[output].mode.vrefresh = hz;
+    return true;
+}
+
+bool Drm::writeReadIoctl(unsigned long cmd, void *data, unsigned long size)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+
+    if (cmd == DRM_PSB_GTT_MAP) {
+        struct psb_gtt_mapping_arg *arg = (struct psb_gtt_mapping_arg *)data;
+        hwc.counters.gttMapCount++;
+        if (hwc.gttMapLimit && arg->size > hwc.gttMapLimit) {
+            return false;
+        }
+        uint32_t first = arg->vaddr >> 12;
+        uint32_t last = (arg->vaddr + arg->size - 1) >> 12;
+        arg->offset_pages = sNextGttPage;
+        sNextGttPage += last - first + 1;
+    }
+    return true;
+}
+
+bool Drm::writeIoctl(unsigned long cmd, void *data, unsigned long size)
+{
+    if (cmd == DRM_PSB_GTT_UNMAP) {
+        FakeHwcomposer::get().counters.gttUnmapCount++;
+    }
+    return true;
+}
+
+bool Drm::readIoctl(unsigned long cmd, void *data, unsigned long size)
+{
+    return true;
+}
+
+int Drm::getDrmFd() const
+{
+    return mDrmFd;
+}
+
+bool Drm::getModeInfo(int device, drmModeModeInfo& mode)
+{
+    int output = getOutputIndex(device);
+    if (output < 0 || !mOutputs[output].connected) {
+        return false;
+    }
+    mode = mOutputs[output].mode;
+    return true;
+}
+
+bool Drm::getPhysicalSize(int device, uint32_t& width, uint32_t& height)
+{
+    width = 0;
+    height = 0;
+    return false;
+}
+
+bool Drm::isConnected(int device)
+{
+    int output = getOutputIndex(device);
+    return output >= 0 && mOutputs[output].connected;
+}
+
+bool Drm::setDpmsMode(int device, int mode)
+{
+    return true;
+}
+
+int Drm::getOutputIndex(int device)
+{
+    switch (device) {
+    case IDisplayDevice::DEVICE_PRIMARY:
+        return OUTPUT_PRIMARY;
+    case IDisplayDevice::DEVICE_EXTERNAL:
+        return OUTPUT_EXTERNAL;
+    default:
+        return -1;
+    }
+}
+
+int Drm::getPanelOrientation(int device)
+{
+    return PANEL_ORIENTATION_0;
+}
+
+bool Drm::setPipeSource(int device, int width, int height, bool keepAspect)
+{
+    return true;
+}
+
+bool Drm::checkPipeUnderrun(int device)
+{
+    return false;
+}
+
+drmModeModeInfoPtr Drm::detectAllConfigs(int device, int *modeCount)
+{
+    *modeCount = 0;
+    return NULL;
+}
+
+uint32_t DrmConfig::getFrameBufferFormat()
+{
+    return HAL_PIXEL_FORMAT_RGBX_8888;
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,584 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <HwcTrace.h>
+#include <hal_public.h>
+#include "fake_hwcomposer.h"
+#include <ExternalDevice.h>
+#include <VirtualDevice.h>
+
+namespace android {
+namespace intel {
+
+FakeBuffer::FakeBuffer(buffer_handle_t handle)
+    : GraphicBuffer(handle)
+{
+    initBuffer(handle);
+}
+
+void FakeBuffer::resetBuffer(buffer_handle_t handle)
+{
+    GraphicBuffer::resetBuffer(handle);
+    initBuffer(handle);
+}
+
+void FakeBuffer::initBuffer(buffer_handle_t handle)
+{
+    const FakeBufferInfo *info = FakeHwcomposer::get().getBuffer(handle);
+    if (!info) {
+        return;
+    }
+
+    mFormat = GraphicBuffer::getBaseFormat(info->format);
+    mGrallocFormat = info->format;
+    mWidth = info->width;
+    mHeight = info->height;
+    mUsage = info->usage;
+    mBpp = 32;
+    mStride.rgb.stride = align_to(mWidth * 4, 64);
+    mCrop.w = mWidth;
+    mCrop.h = mHeight;
+}
+
+bool FakeBufferMapper::map()
+{
+    FakeHwcomposer::get().counters.mapCount++;
+    return true;
+}
+
+bool FakeBufferMapper::unmap()
+{
+    FakeHwcomposer::get().counters.unmapCount++;
+    return true;
+}
+
+bool FakeBufferManager::blit(buffer_handle_t srcHandle, buffer_handle_t destHandle,
+                             const crop_t& destRect, bool filter, bool async)
+{
+    return true;
+}
+
+DataBuffer* FakeBufferManager::createDataBuffer(buffer_handle_t handle)
+{
+    return new FakeBuffer(handle);
+}
+
+BufferMapper* FakeBufferManager::createBufferMapper(DataBuffer& buffer)
+{
+    return new FakeBufferMapper(buffer);
+}
+
+FakePlane::FakePlane(int index, int type, int disp)
+    : DisplayPlane(index, type, disp),
+      mEnabled(false)
+{
+}
+
+bool FakePlane::enable()
+{
+    mEnabled = true;
+    return true;
+}
+
+bool FakePlane::disable()
+{
+    mEnabled = false;
+    return true;
+}
+
+bool FakePlane::isDisabled()
+{
+    return !mEnabled;
+}
+
+bool FakePlane::setDataBuffer(BufferMapper& mapper)
+{
+    FakeHwcomposer::get().counters.setBufferCount++;
+    return true;
+}
+
+bool FakePlaneManager::initialize()
+{
+    mSpritePlaneCount = 1;
+    mOverlayPlaneCount = 2;
+    mPrimaryPlaneCount = 3;
+    mCursorPlaneCount = 0;
+
+    return DisplayPlaneManager::initialize();
+}
+
+bool FakePlaneManager::assignPlanes(int dsp, ZOrderConfig& config)
+{
+    FakeHwcomposer::get().counters.assignCount++;
+
+    for (size_t i = 0; i < config.size(); i++) {
+        if (!getFreePlanes(dsp, config[i]->planeType)) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < config.size(); i++) {
+        ZOrderLayer *layer = config.itemAt(i);
+        int index = dsp == IDisplayDevice::DEVICE_PRIMARY ? 0 : 1;
+        if (layer->planeType == DisplayPlane::PLANE_PRIMARY) {
+            layer->plane = getPlane(layer->planeType, index);
+        } else {
+            layer->plane = getAnyPlane(layer->planeType);
+        }
+        if (!layer->plane) {
+            return false;
+        }
+        layer->plane->enable();
+    }
+    return true;
+}
+
+DisplayPlane* FakePlaneManager::allocPlane(int index, int type)
+{
+    DisplayPlane *plane = new FakePlane(index, type, index);
+    plane->initialize(DisplayPlane::MIN_DATA_BUFFER_COUNT);
+    return plane;
+}
+
+DisplayPlaneManager* FakePlatFactory::createDisplayPlaneManager()
+{
+    return new FakePlaneManager();
+}
+
+BufferManager* FakePlatFactory::createBufferManager()
+{
+    return new FakeBufferManager();
+}
+
+FakeHwcomposer::FakeHwcomposer()
+    : Hwcomposer(new FakePlatFactory()),
+      gttMapLimit(0),
+      mNextHandle(0x1000)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+void FakeHwcomposer::reset()
+{
+    // planes reclaimed by the previous test are freed as a commit does
+    getPlaneManager()->disableReclaimedPlanes();
+    mBuffers.clear();
+    videoSessions.clear();
+    gttMapLimit = 0;
+    memset(&counters, 0, sizeof(counters));
+}
+
+buffer_handle_t FakeHwcomposer::addBuffer(uint32_t format, uint32_t width,
+                                          uint32_t height, uint32_t usage)
+{
+    FakeBufferInfo info;
+    info.format = format;
+    info.width = width;
+    info.height = height;
+    info.usage = usage;
+
+    buffer_handle_t handle = (buffer_handle_t)mNextHandle;
+    mNextHandle += 0x10;
+    mBuffers.add(handle, info);
+    return handle;
+}
+
+const FakeBufferInfo* FakeHwcomposer::getBuffer(buffer_handle_t handle) const
+{
+    ssize_t index = mBuffers.indexOfKey(handle);
+    if (index < 0) {
+        return NULL;
+    }
+    return &mBuffers.valueAt(index);
+}
+
+// Hwcomposer with the objects the common code reaches through it, nothing
+// is connected to a display
+
+Hwcomposer* Hwcomposer::sInstance(0);
+
+Hwcomposer* Hwcomposer::createHwcomposer()
+{
+    FakeHwcomposer *hwc = new FakeHwcomposer();
+    sInstance = hwc;
+    if (!hwc->initialize()) {
+        ETRACE("failed to initialize fake hwcomposer");
+    }
+    return hwc;
+}
+
+Hwcomposer::Hwcomposer(IPlatFactory *factory)
+    : mProcs(0),
+      mDrm(0),
+      mPlatFactory(factory),
+      mVsyncManager(0),
+      mDisplayAnalyzer(0),
+      mMultiDisplayObserver(0),
+      mUeventObserver(0),
+      mPlaneManager(0),
+      mBufferManager(0),
+      mDisplayContext(0),
+      mGpuBoostManager(0),
+      mDeferredWorkQueue(0),
+      mInitialized(false)
+{
+    mDisplayDevices.setCapacity(IDisplayDevice::DEVICE_COUNT);
+    mDisplayDevices.clear();
+}
+
+Hwcomposer::~Hwcomposer()
+{
+    deinitialize();
+}
+
+bool Hwcomposer::initCheck() const
+{
+    return mInitialized;
+}
+
+bool Hwcomposer::initialize()
+{
+    // deferred work runs inline as the queue is not started
+    mDeferredWorkQueue = new DeferredWorkQueue();
+    mDrm = new Drm();
+
+    mBufferManager = mPlatFactory->createBufferManager();
+    if (!mBufferManager->initialize()) {
+        DEINIT_AND_RETURN_FALSE("failed to create buffer manager");
+    }
+
+    mPlaneManager = mPlatFactory->createDisplayPlaneManager();
+    if (!mPlaneManager->initialize()) {
+        DEINIT_AND_RETURN_FALSE("failed to create display plane manager");
+    }
+
+    mGpuBoostManager = new GpuBoostManager(mPlatFactory->createGpuBoostControl());
+    mGpuBoostManager->initialize();
+
+    for (int i = 0; i < IDisplayDevice::DEVICE_COUNT; i++) {
+        mDisplayDevices.push_back(mPlatFactory->createDisplayDevice(i));
+    }
+
+    mVsyncManager = new VsyncManager(*this);
+    mDisplayAnalyzer = new DisplayAnalyzer();
+    mMultiDisplayObserver = new MultiDisplayObserver();
+
+    mInitialized = true;
+    return true;
+}
+
+void Hwcomposer::deinitialize()
+{
+    if (mDisplayAnalyzer) {
+        mDisplayAnalyzer->deinitialize();
+        delete mDisplayAnalyzer;
+        mDisplayAnalyzer = 0;
+    }
+    if (mMultiDisplayObserver) {
+        delete mMultiDisplayObserver;
+        mMultiDisplayObserver = 0;
+    }
+    if (mVsyncManager) {
+        delete mVsyncManager;
+        mVsyncManager = 0;
+    }
+    for (size_t i = 0; i < mDisplayDevices.size(); i++) {
+        IDisplayDevice *device = mDisplayDevices.itemAt(i);
+        DEINIT_AND_DELETE_OBJ(device);
+    }
+    mDisplayDevices.clear();
+
+    DEINIT_AND_DELETE_OBJ(mGpuBoostManager);
+    DEINIT_AND_DELETE_OBJ(mPlaneManager);
+    DEINIT_AND_DELETE_OBJ(mBufferManager);
+    if (mDrm) {
+        delete mDrm;
+        mDrm = 0;
+    }
+    if (mDeferredWorkQueue) {
+        delete mDeferredWorkQueue;
+        mDeferredWorkQueue = 0;
+    }
+    if (mPlatFactory) {
+        delete mPlatFactory;
+        mPlatFactory = 0;
+    }
+    mInitialized = false;
+}
+
+bool Hwcomposer::prepare(size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    return true;
+}
+
+bool Hwcomposer::commit(size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    return true;
+}
+
+bool Hwcomposer::vsyncControl(int disp, int enabled)
+{
+    return true;
+}
+
+bool Hwcomposer::release()
+{
+    return true;
+}
+
+bool Hwcomposer::dump(char *buff, int buff_len, int *cur_len)
+{
+    return true;
+}
+
+void Hwcomposer::registerProcs(hwc_procs_t const *procs)
+{
+    mProcs = procs;
+}
+
+bool Hwcomposer::blank(int disp, int blank)
+{
+    return true;
+}
+
+bool Hwcomposer::getDisplayConfigs(int disp, uint32_t *configs, size_t *numConfigs)
+{
+    return false;
+}
+
+bool Hwcomposer::getDisplayAttributes(int disp, uint32_t config,
+                                      const uint32_t *attributes, int32_t *values)
+{
+    return false;
+}
+
+bool Hwcomposer::compositionComplete(int disp)
+{
+    return true;
+}
+
+bool Hwcomposer::setPowerMode(int disp, int mode)
+{
+    return true;
+}
+
+int Hwcomposer::getActiveConfig(int disp)
+{
+    return 0;
+}
+
+bool Hwcomposer::setActiveConfig(int disp, int index)
+{
+    return true;
+}
+
+bool Hwcomposer::setCursorPositionAsync(int disp, int x, int y)
+{
+    return true;
+}
+
+void Hwcomposer::vsync(int disp, int64_t timestamp)
+{
+}
+
+void Hwcomposer::hotplug(int disp, bool connected)
+{
+}
+
+void Hwcomposer::invalidate()
+{
+    static_cast<FakeHwcomposer*>(this)->counters.invalidateCount++;
+}
+
+Drm* Hwcomposer::getDrm()
+{
+    return mDrm;
+}
+
+DisplayPlaneManager* Hwcomposer::getPlaneManager()
+{
+    return mPlaneManager;
+}
+
+BufferManager* Hwcomposer::getBufferManager()
+{
+    return mBufferManager;
+}
+
+IDisplayContext* Hwcomposer::getDisplayContext()
+{
+    return mDisplayContext;
+}
+
+DisplayAnalyzer* Hwcomposer::getDisplayAnalyzer()
+{
+    return mDisplayAnalyzer;
+}
+
+VsyncManager* Hwcomposer::getVsyncManager()
+{
+    return mVsyncManager;
+}
+
+GpuBoostManager* Hwcomposer::getGpuBoostManager()
+{
+    return mGpuBoostManager;
+}
+
+DeferredWorkQueue* Hwcomposer::getDeferredWorkQueue()
+{
+    return mDeferredWorkQueue;
+}
+
+MultiDisplayObserver* Hwcomposer::getMultiDisplayObserver()
+{
+    return mMultiDisplayObserver;
+}
+
+IDisplayDevice* Hwcomposer::getDisplayDevice(int disp)
+{
+    if (disp < 0 || disp >= (int)mDisplayDevices.size()) {
+        return 0;
+    }
+    return mDisplayDevices.itemAt(disp);
+}
+
+UeventObserver* Hwcomposer::getUeventObserver()
+{
+    return mUeventObserver;
+}
+
+// vsync is not controlled by the tests
+
+VsyncManager::VsyncManager(Hwcomposer& hwc)
+    : mHwc(hwc)
+{
+}
+
+VsyncManager::~VsyncManager()
+{
+}
+
+bool VsyncManager::initialize()
+{
+    return true;
+}
+
+void VsyncManager::deinitialize()
+{
+}
+
+bool VsyncManager::handleVsyncControl(int disp, bool enabled)
+{
+    return true;
+}
+
+void VsyncManager::resetVsyncSource()
+{
+}
+
+int VsyncManager::getVsyncSource()
+{
+    return IDisplayDevice::DEVICE_PRIMARY;
+}
+
+void VsyncManager::enableDynamicVsync(bool enable)
+{
+}
+
+#ifdef TARGET_HAS_MULTIPLE_DISPLAY
+
+// multi display service as far as the analyzer asks it
+
+MultiDisplayObserver::MultiDisplayObserver()
+    : mThreadLoopCount(0),
+      mDeviceConnected(false),
+      mExternalHdmiTiming(false),
+      mInitialized(false)
+{
+}
+
+MultiDisplayObserver::~MultiDisplayObserver()
+{
+}
+
+bool MultiDisplayObserver::initialize()
+{
+    mInitialized = true;
+    return true;
+}
+
+void MultiDisplayObserver::deinitialize()
+{
+    mInitialized = false;
+}
+
+status_t MultiDisplayObserver::notifyHotPlug(bool connected)
+{
+    mDeviceConnected = connected;
+    return NO_ERROR;
+}
+
+status_t MultiDisplayObserver::getVideoSourceInfo(int sessionID, VideoSourceInfo* info)
+{
+    const KeyedVector<int, VideoSourceInfo>& sessions =
+        FakeHwcomposer::get().videoSessions;
+    ssize_t index = sessions.indexOfKey(sessionID);
+    if (index < 0) {
+        return NAME_NOT_FOUND;
+    }
+    *info = sessions.valueAt(index);
+    return NO_ERROR;
+}
+
+int MultiDisplayObserver::getVideoSessionNumber()
+{
+    return (int)FakeHwcomposer::get().videoSessions.size();
+}
+
+bool MultiDisplayObserver::isExternalDeviceTimingFixed() const
+{
+    return mExternalHdmiTiming;
+}
+
+status_t MultiDisplayObserver::notifyWidiConnectionStatus(bool connected)
+{
+    return NO_ERROR;
+}
+
+status_t MultiDisplayObserver::setDecoderOutputResolution(int sessionID,
+        int32_t width, int32_t height,
+        int32_t offX, int32_t offY,
+        int32_t bufWidth, int32_t bufHeight)
+{
+    return NO_ERROR;
+}
+
+#endif // TARGET_HAS_MULTIPLE_DISPLAY
+
+// display devices are not created, these are only reached through them
+
+bool VirtualDevice::isFrameServerActive() const
+{
+    return false;
+}
+
+int ExternalDevice::getRefreshRate()
+{
+    return 60;
+}
+
+} // namespace intel
+} // namespace android
@@ -0,0 +1,148 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef FAKE_HWCOMPOSER_H
+#define FAKE_HWCOMPOSER_H
+
+#include <utils/KeyedVector.h>
+#include <Hwcomposer.h>
+#include <BufferMapper.h>
+#include <GraphicBuffer.h>
+
+namespace android {
+namespace intel {
+
+// the fakes stand in for the platform below the common code. Hwcomposer,
+// Drm and VsyncManager are provided at link time by the test, the rest
+// through FakePlatFactory
+
+// gralloc buffer as described by the test
+struct FakeBufferInfo {
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t usage;
+};
+
+class FakeBuffer : public GraphicBuffer {
+public:
+    FakeBuffer(buffer_handle_t handle);
+    virtual ~FakeBuffer() {}
+public:
+    virtual void resetBuffer(buffer_handle_t handle);
+private:
+    void initBuffer(buffer_handle_t handle);
+};
+
+class FakeBufferMapper : public BufferMapper {
+public:
+    FakeBufferMapper(DataBuffer& buffer) : BufferMapper(buffer) {}
+    virtual ~FakeBufferMapper() {}
+public:
+    virtual bool map();
+    virtual bool unmap();
+    virtual uint32_t getGttOffsetInPage(int subIndex) const { return 0; }
+    virtual void* getCpuAddress(int subIndex) const { return 0; }
+    virtual uint32_t getSize(int subIndex) const { return 0; }
+    virtual buffer_handle_t getKHandle(int subIndex) { return mHandle; }
+    virtual buffer_handle_t getFbHandle(int subIndex) { return 0; }
+    virtual void putFbHandle() {}
+};
+
+class FakeBufferManager : public BufferManager {
+public:
+    virtual bool blit(buffer_handle_t srcHandle, buffer_handle_t destHandle,
+                      const crop_t& destRect, bool filter, bool async);
+protected:
+    virtual DataBuffer* createDataBuffer(buffer_handle_t handle);
+    virtual BufferMapper* createBufferMapper(DataBuffer& buffer);
+};
+
+class FakePlane : public DisplayPlane {
+public:
+    FakePlane(int index, int type, int disp);
+    virtual ~FakePlane() {}
+public:
+    virtual bool enable();
+    virtual bool disable();
+    virtual bool isDisabled();
+    virtual void setZOrderConfig(ZOrderConfig& config, void *nativeConfig) {}
+    virtual void* getContext() const { return 0; }
+protected:
+    virtual bool setDataBuffer(BufferMapper& mapper);
+private:
+    bool mEnabled;
+};
+
+// tangier plane counts with overlays, every z order is valid
+class FakePlaneManager : public DisplayPlaneManager {
+public:
+    virtual bool initialize();
+    virtual bool isValidZOrder(int dsp, ZOrderConfig& config) { return true; }
+    virtual bool assignPlanes(int dsp, ZOrderConfig& config);
+    virtual void* getZOrderConfig() const { return 0; }
+protected:
+    virtual DisplayPlane* allocPlane(int index, int type);
+};
+
+class FakePlatFactory : public IPlatFactory {
+public:
+    virtual DisplayPlaneManager* createDisplayPlaneManager();
+    virtual BufferManager* createBufferManager();
+    virtual IDisplayDevice* createDisplayDevice(int disp) { return 0; }
+    virtual IDisplayContext* createDisplayContext() { return 0; }
+    virtual IVideoPayloadManager* createVideoPayloadManager() { return 0; }
+    virtual IGpuBoostControl* createGpuBoostControl() { return 0; }
+};
+
+// what the platform was asked to do, reset with FakeHwcomposer::reset
+struct FakeHwcCounters {
+    int mapCount;
+    int unmapCount;
+    int assignCount;
+    int setBufferCount;
+    int invalidateCount;
+    int gttMapCount;
+    int gttUnmapCount;
+};
+
+class FakeHwcomposer : public Hwcomposer {
+public:
+    FakeHwcomposer();
+    virtual ~FakeHwcomposer() {}
+public:
+    static FakeHwcomposer& get() {
+        return static_cast<FakeHwcomposer&>(getInstance());
+    }
+    // drops all buffers and counters
+    void reset();
+    buffer_handle_t addBuffer(uint32_t format, uint32_t width, uint32_t height,
+                              uint32_t usage = 0);
+    const FakeBufferInfo* getBuffer(buffer_handle_t handle) const;
+public:
+    FakeHwcCounters counters;
+    // video sessions reported by the multi display service
+    KeyedVector<int, VideoSourceInfo> videoSessions;
+    // gtt mappings larger than this many bytes fail, 0 for no limit
+    uint32_t gttMapLimit;
+private:
+    KeyedVector<buffer_handle_t, FakeBufferInfo> mBuffers;
+    uintptr_t mNextHandle;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* FAKE_HWCOMPOSER_H */
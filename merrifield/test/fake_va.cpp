@@ -0,0 +1,261 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <va/va.h>
+#include <va/va_tpi.h>
+#include <va/va_vpp.h>
+#include <va/va_android.h>
+#include <common/Wsbm.h>
+#include "fake_va.h"
+
+namespace android {
+namespace intel {
+
+enum {
+    // kernel handles of TTM buffers, decoder buffers are given lower ones
+    TTM_KHANDLE_BASE = 0x10000,
+};
+
+FakeVa::FakeVa()
+    : nextSurface(1),
+      mNextKHandle(TTM_KHANDLE_BASE)
+{
+    reset();
+}
+
+FakeVa& FakeVa::get()
+{
+    static FakeVa sInstance;
+    return sInstance;
+}
+
+void FakeVa::reset()
+{
+    rotationFlags = (1 << VA_ROTATION_90) |
+                    (1 << VA_ROTATION_180) |
+                    (1 << VA_ROTATION_270);
+    memset(&counters, 0, sizeof(counters));
+    memset(&pipeline, 0, sizeof(pipeline));
+    surfaces.clear();
+}
+
+uint64_t FakeVa::allocTTMBuffer(void **buf)
+{
+    uint64_t *khandle = (uint64_t *)malloc(sizeof(uint64_t));
+    *khandle = mNextKHandle++;
+    *buf = khandle;
+    counters.ttmAllocCount++;
+    return *khandle;
+}
+
+bool FakeVa::isTTMBuffer(unsigned long khandle) const
+{
+    return khandle >= TTM_KHANDLE_BASE;
+}
+
+} // namespace intel
+} // namespace android
+
+using namespace android::intel;
+
+Wsbm::Wsbm(int drmFD)
+    : mDrmFD(drmFD),
+      mInitialized(false)
+{
+}
+
+Wsbm::~Wsbm()
+{
+}
+
+bool Wsbm::allocateTTMBuffer(uint32_t size, uint32_t align, void **buf)
+{
+    FakeVa::get().allocTTMBuffer(buf);
+    return true;
+}
+
+bool Wsbm::allocateTTMBufferUB(uint32_t size, uint32_t align, void **buf, void *user_pt)
+{
+    FakeVa::get().allocTTMBuffer(buf);
+    return true;
+}
+
+bool Wsbm::destroyTTMBuffer(void *buf)
+{
+    FakeVa::get().counters.ttmFreeCount++;
+    free(buf);
+    return true;
+}
+
+uint64_t Wsbm::getKBufHandle(void *buf)
+{
+    return *(uint64_t *)buf;
+}
+
+static int sDisplay;
+
+VADisplay vaGetDisplay(void *native)
+{
+    return &sDisplay;
+}
+
+VAStatus vaInitialize(VADisplay dpy, int *major, int *minor)
+{
+    FakeVa::get().counters.initializeCount++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaTerminate(VADisplay dpy)
+{
+    FakeVa::get().counters.terminateCount++;
+    return VA_STATUS_SUCCESS;
+}
+
+int vaMaxNumEntrypoints(VADisplay dpy)
+{
+    return 1;
+}
+
+VAStatus vaQueryConfigEntrypoints(VADisplay dpy, VAProfile profile,
+                                  VAEntrypoint *entrypoints, int *count)
+{
+    entrypoints[0] = VAEntrypointVideoProc;
+    *count = 1;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateConfig(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint,
+                        VAConfigAttrib *attribs, int count, VAConfigID *config)
+{
+    *config = 1;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyConfig(VADisplay dpy, VAConfigID config)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateContext(VADisplay dpy, VAConfigID config, int width, int height,
+                         int flags, VASurfaceID *targets, int count, VAContextID *context)
+{
+    FakeVa::get().counters.contextCount++;
+    *context = 1;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyContext(VADisplay dpy, VAContextID context)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateSurfacesWithAttribute(VADisplay dpy, int width, int height,
+                                       int format, int count, VASurfaceID *surfaces,
+                                       VASurfaceAttributeTPI *attribs)
+{
+    FakeVa& va = FakeVa::get();
+    for (int i = 0; i < count; i++) {
+        unsigned long khandle = attribs->buffers[i];
+        if (va.isTTMBuffer(khandle)) {
+            va.counters.targetSurfaceCount++;
+        } else {
+            va.counters.sourceSurfaceCount++;
+        }
+        surfaces[i] = va.nextSurface++;
+        va.surfaces.add(surfaces[i], khandle);
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroySurfaces(VADisplay dpy, VASurfaceID *surfaces, int count)
+{
+    FakeVa& va = FakeVa::get();
+    for (int i = 0; i < count; i++) {
+        if (va.surfaces.removeItem(surfaces[i]) < 0) {
+            va.counters.badDestroyCount++;
+        } else {
+            va.counters.destroySurfaceCount++;
+        }
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+static VAProcPipelineParameterBuffer sMappedPipeline;
+
+VAStatus vaCreateBuffer(VADisplay dpy, VAContextID context, VABufferType type,
+                        unsigned int size, unsigned int count, void *data, VABufferID *buf)
+{
+    *buf = type;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyBuffer(VADisplay dpy, VABufferID buf)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaMapBuffer(VADisplay dpy, VABufferID buf, void **data)
+{
+    *data = &sMappedPipeline;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaUnmapBuffer(VADisplay dpy, VABufferID buf)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaBeginPicture(VADisplay dpy, VAContextID context, VASurfaceID target)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaRenderPicture(VADisplay dpy, VAContextID context, VABufferID *bufs, int count)
+{
+    FakeVa& va = FakeVa::get();
+    va.counters.renderCount++;
+    va.pipeline = sMappedPipeline;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaEndPicture(VADisplay dpy, VAContextID context)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaSyncSurface(VADisplay dpy, VASurfaceID surface)
+{
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryVideoProcFilters(VADisplay dpy, VAContextID context,
+                                 VAProcFilterType *filters, unsigned int *count)
+{
+    filters[0] = VAProcFilterNone;
+    *count = 1;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryVideoProcPipelineCaps(VADisplay dpy, VAContextID context,
+                                      VABufferID *filters, unsigned int count,
+                                      VAProcPipelineCaps *caps)
+{
+    memset(caps, 0, sizeof(*caps));
+    caps->rotation_flags = FakeVa::get().rotationFlags;
+    return VA_STATUS_SUCCESS;
+}
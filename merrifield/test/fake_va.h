@@ -0,0 +1,71 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef FAKE_VA_H
+#define FAKE_VA_H
+
+#include <va/va.h>
+#include <va/va_vpp.h>
+#include <utils/KeyedVector.h>
+
+namespace android {
+namespace intel {
+
+// the VA driver behind RotationBufferProvider and the TTM buffers it
+// allocates through Wsbm, provided at link time by the test. every call
+// succeeds, surfaces wrapping a TTM buffer count as rotation targets and
+// any other buffer as a decoder buffer
+
+// what the driver was asked to do, reset with FakeVa::reset
+struct FakeVaCounters {
+    int initializeCount;
+    int terminateCount;
+    int contextCount;
+    int sourceSurfaceCount;
+    int targetSurfaceCount;
+    int destroySurfaceCount;
+    // surfaces destroyed that were not alive
+    int badDestroyCount;
+    int renderCount;
+    int ttmAllocCount;
+    int ttmFreeCount;
+};
+
+class FakeVa {
+public:
+    static FakeVa& get();
+    // drops all surfaces and counters, every rotation is supported
+    void reset();
+    // wraps a buffer, returns its kernel handle
+    uint64_t allocTTMBuffer(void **buf);
+    bool isTTMBuffer(unsigned long khandle) const;
+public:
+    FakeVaCounters counters;
+    // VA_ROTATION_xxx bits of the pipeline caps
+    uint32_t rotationFlags;
+    // live surfaces and the buffer they wrap
+    KeyedVector<VASurfaceID, unsigned long> surfaces;
+    VASurfaceID nextSurface;
+    // parameters of the last picture rendered
+    VAProcPipelineParameterBuffer pipeline;
+private:
+    FakeVa();
+    uint64_t mNextKHandle;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* FAKE_VA_H */
@@ -0,0 +1,177 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <FrameRateEstimator.h>
+
+using namespace android::intel;
+
+// feeds timestamps in microseconds, one per frame, given as intervals
+static void feed(FrameRateEstimator& estimator, int64_t& timestamp,
+                 const int64_t *intervals, int count, int repeat)
+{
+    for (int r = 0; r < repeat; r++) {
+        for (int i = 0; i < count; i++) {
+            timestamp += intervals[i];
+            estimator.addTimestamp(timestamp);
+        }
+    }
+}
+
+static void expectRate(const FrameRateEstimator& estimator, int32_t num, int32_t den)
+{
+    int32_t n = 0, d = 0;
+    ASSERT_TRUE(estimator.getFrameRate(&n, &d));
+    EXPECT_EQ(num, n);
+    EXPECT_EQ(den, d);
+}
+
+TEST(FrameRateEstimatorTest, NoEstimateUntilWindowFilled)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t interval[] = {40000};
+    int32_t n, d;
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, interval, 1, 7);
+    EXPECT_FALSE(estimator.getFrameRate(&n, &d));
+
+    feed(estimator, timestamp, interval, 1, 1);
+    expectRate(estimator, 25, 1);
+}
+
+TEST(FrameRateEstimatorTest, RepeatedTimestampIgnored)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t interval[] = {40000};
+
+    estimator.addTimestamp(timestamp);
+    for (int i = 0; i < 16; i++) {
+        timestamp += interval[0];
+        // the same frame is composed twice
+        estimator.addTimestamp(timestamp);
+        estimator.addTimestamp(timestamp);
+    }
+    expectRate(estimator, 25, 1);
+}
+
+TEST(FrameRateEstimatorTest, NtscFilm)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    // 1001/24 ms rounded to microseconds
+    const int64_t intervals[] = {41708, 41709, 41708};
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, intervals, 3, 10);
+    expectRate(estimator, 24000, 1001);
+}
+
+TEST(FrameRateEstimatorTest, PulldownCadence)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    // 3:2 cadence at 59.94 Hz averages to 23.976 fps
+    const int64_t intervals[] = {50050, 33367};
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, intervals, 2, 16);
+    expectRate(estimator, 24000, 1001);
+}
+
+TEST(FrameRateEstimatorTest, JitterAndDroppedFrames)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    // 30 fps with +-2 ms of jitter and one frame dropped per window
+    const int64_t intervals[] = {
+        33333, 35333, 31333, 33333, 34333, 32333, 66667, 33333,
+        31333, 35333, 33333, 33333, 32333, 34333, 33333, 33333,
+    };
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, intervals, 16, 4);
+    expectRate(estimator, 30, 1);
+}
+
+TEST(FrameRateEstimatorTest, SeekKeepsEstimate)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t interval[] = {20000};
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, interval, 1, 16);
+    expectRate(estimator, 50, 1);
+
+    // seek backwards, then pause
+    timestamp = 1000000;
+    estimator.addTimestamp(timestamp);
+    expectRate(estimator, 50, 1);
+    timestamp += 2000000;
+    estimator.addTimestamp(timestamp);
+    expectRate(estimator, 50, 1);
+
+    feed(estimator, timestamp, interval, 1, 16);
+    expectRate(estimator, 50, 1);
+}
+
+TEST(FrameRateEstimatorTest, RateChangeNeedsStableEstimate)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t slow[] = {40000};
+    const int64_t fast[] = {16667, 16667, 16666};
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, slow, 1, 16);
+    expectRate(estimator, 25, 1);
+
+    // a short burst at another rate does not change the estimate
+    feed(estimator, timestamp, fast, 3, 2);
+    expectRate(estimator, 25, 1);
+
+    feed(estimator, timestamp, fast, 3, 10);
+    expectRate(estimator, 60, 1);
+}
+
+TEST(FrameRateEstimatorTest, NonStandardRate)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t interval[] = {66667};
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, interval, 1, 16);
+    expectRate(estimator, 15, 1);
+}
+
+TEST(FrameRateEstimatorTest, Reset)
+{
+    FrameRateEstimator estimator;
+    int64_t timestamp = 0;
+    const int64_t interval[] = {40000};
+    int32_t n, d;
+
+    estimator.addTimestamp(timestamp);
+    feed(estimator, timestamp, interval, 1, 16);
+    expectRate(estimator, 25, 1);
+
+    estimator.reset();
+    EXPECT_FALSE(estimator.getFrameRate(&n, &d));
+}
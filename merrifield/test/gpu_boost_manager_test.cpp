@@ -0,0 +1,171 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <utils/Vector.h>
+#include <GpuBoostManager.h>
+
+using namespace android;
+using namespace android::intel;
+
+// what the sink was asked to do, outlives the control the manager deletes
+struct BoostLog {
+    bool initialized;
+    // frame of every hint, negative for a release
+    Vector<int> hints;
+    int frame;
+};
+
+class FakeGpuBoostControl : public IGpuBoostControl {
+public:
+    FakeGpuBoostControl(BoostLog& log) : mLog(log) {}
+    virtual ~FakeGpuBoostControl() {}
+public:
+    virtual bool initialize() {
+        mLog.initialized = true;
+        return true;
+    }
+    virtual void deinitialize() {
+        mLog.initialized = false;
+    }
+    virtual bool boost(bool enable) {
+        mLog.hints.add(enable ? mLog.frame : -mLog.frame);
+        return true;
+    }
+private:
+    BoostLog& mLog;
+};
+
+class GpuBoostManagerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mLog.initialized = false;
+        mLog.frame = 0;
+        mManager = new GpuBoostManager(new FakeGpuBoostControl(mLog));
+        ASSERT_TRUE(mManager->initialize());
+    }
+
+    virtual void TearDown() {
+        mManager->deinitialize();
+        delete mManager;
+    }
+
+    // one composition cycle, GLES work in percent of a screen
+    void frame(uint32_t primary, uint32_t external = 0) {
+        mLog.frame++;
+        mManager->beginFrame();
+        mManager->addWork(IDisplayDevice::DEVICE_PRIMARY, primary);
+        if (external) {
+            mManager->addWork(IDisplayDevice::DEVICE_EXTERNAL, external);
+        }
+        mManager->endFrame();
+    }
+
+    void frames(int count, uint32_t primary) {
+        for (int i = 0; i < count; i++) {
+            frame(primary);
+        }
+    }
+
+protected:
+    BoostLog mLog;
+    GpuBoostManager *mManager;
+};
+
+TEST_F(GpuBoostManagerTest, BoostsOnFirstHeavyFrame)
+{
+    EXPECT_TRUE(mLog.initialized);
+    frames(10, 299);
+    EXPECT_FALSE(mManager->isBoosted());
+    EXPECT_EQ(0u, mLog.hints.size());
+
+    frame(300);
+    EXPECT_TRUE(mManager->isBoosted());
+    ASSERT_EQ(1u, mLog.hints.size());
+    EXPECT_EQ(11, mLog.hints[0]);
+
+    // no repeated hints while boosted
+    frames(10, 400);
+    EXPECT_EQ(1u, mLog.hints.size());
+}
+
+TEST_F(GpuBoostManagerTest, ReleasesWithHysteresis)
+{
+    frame(300);
+
+    // work within the release margin keeps the boost
+    frames(100, 210);
+    EXPECT_TRUE(mManager->isBoosted());
+
+    // low work has to last 30 frames, a busier frame starts over
+    frames(29, 209);
+    frame(250);
+    frames(29, 100);
+    EXPECT_TRUE(mManager->isBoosted());
+    frame(100);
+    EXPECT_FALSE(mManager->isBoosted());
+    ASSERT_EQ(2u, mLog.hints.size());
+    EXPECT_EQ(-mLog.frame, mLog.hints[1]);
+}
+
+TEST_F(GpuBoostManagerTest, WorkOfAllDisplaysAddsUp)
+{
+    frame(200, 100);
+    EXPECT_TRUE(mManager->isBoosted());
+
+    // an external display that skipped prepare no longer counts
+    frames(30, 200);
+    EXPECT_FALSE(mManager->isBoosted());
+    EXPECT_EQ(2u, mLog.hints.size());
+}
+
+TEST_F(GpuBoostManagerTest, DeinitializeDropsBoost)
+{
+    frame(500);
+    mManager->deinitialize();
+    ASSERT_EQ(2u, mLog.hints.size());
+    EXPECT_EQ(-1, mLog.hints[1]);
+    EXPECT_FALSE(mLog.initialized);
+    EXPECT_FALSE(mManager->isBoosted());
+}
+
+// home screen, app launch zoom, app, recents swipe with a short pause in
+// the middle and back to the home screen
+TEST_F(GpuBoostManagerTest, TransitionReplay)
+{
+    frames(60, 40);
+    frames(18, 320);
+    frames(60, 60);
+    frames(10, 350);
+    frames(3, 150);
+    frames(10, 350);
+    frames(60, 40);
+
+    // boost on the first frame of each transition, release 30 frames
+    // after it ended, the pause in the swipe does not flap the hint
+    ASSERT_EQ(4u, mLog.hints.size());
+    EXPECT_EQ(61, mLog.hints[0]);
+    EXPECT_EQ(-108, mLog.hints[1]);
+    EXPECT_EQ(139, mLog.hints[2]);
+    EXPECT_EQ(-191, mLog.hints[3]);
+}
+
+TEST(GpuBoostManagerInitTest, NeedsControl)
+{
+    GpuBoostManager manager(NULL);
+    EXPECT_FALSE(manager.initialize());
+    EXPECT_FALSE(manager.isBoosted());
+}
@@ -0,0 +1,258 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <common/GrallocBufferMapperBase.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// sub buffers at fixed addresses, mapped through the fake drm
+class TestGrallocMapper : public GrallocBufferMapperBase {
+public:
+    TestGrallocMapper(DataBuffer& buffer, void *vaddr[], uint32_t size[])
+        : GrallocBufferMapperBase(buffer)
+    {
+        for (int i = 0; i < SUB_BUFFER_MAX; i++) {
+            mVaddr[i] = vaddr[i];
+            mSizes[i] = size[i];
+        }
+    }
+    virtual ~TestGrallocMapper() {}
+public:
+    virtual bool map() { return gttMap(mVaddr, mSizes); }
+    virtual bool unmap() { gttUnmap(); return true; }
+    virtual buffer_handle_t getFbHandle(int subIndex) { return 0; }
+    virtual void putFbHandle() {}
+
+    using GrallocBufferMapperBase::GttRange;
+    using GrallocBufferMapperBase::getGttRanges;
+private:
+    void *mVaddr[SUB_BUFFER_MAX];
+    uint32_t mSizes[SUB_BUFFER_MAX];
+};
+
+typedef TestGrallocMapper::GttRange GttRange;
+
+// a decoded NV12 1920x1088 frame: image data and the payload page right
+// behind it, metadata in a separate allocation
+class GrallocBufferMapperTest : public ::testing::Test {
+protected:
+    enum {
+        FRAME_SIZE = 1920 * 1088 * 3 / 2,
+        PAGE_SIZE = 4096,
+        BUFFER_STRIDE = 0x400000,
+        POOL_SIZE = 8,
+    };
+
+    virtual void SetUp() {
+        FakeHwcomposer::get().reset();
+        mBuffer = new DataBuffer((buffer_handle_t)0x1000);
+    }
+
+    virtual void TearDown() {
+        delete mBuffer;
+    }
+
+    static void setVideoBuffer(int index, void *vaddr[], uint32_t size[]) {
+        memset(vaddr, 0, sizeof(void*) * SUB_BUFFER_MAX);
+        memset(size, 0, sizeof(uint32_t) * SUB_BUFFER_MAX);
+        uintptr_t base = 0x40000000 + index * BUFFER_STRIDE;
+        vaddr[0] = (void*)base;
+        size[0] = FRAME_SIZE;
+        vaddr[1] = (void*)(base + FRAME_SIZE);
+        size[1] = PAGE_SIZE;
+        vaddr[2] = (void*)(0x60000000 + index * PAGE_SIZE);
+        size[2] = 256;
+    }
+
+protected:
+    DataBuffer *mBuffer;
+};
+
+TEST_F(GrallocBufferMapperTest, RangesMergePageContiguousSubBuffers)
+{
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    GttRange ranges[SUB_BUFFER_MAX];
+    setVideoBuffer(0, vaddr, size);
+
+    ASSERT_EQ(2, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+    EXPECT_EQ(vaddr[0], ranges[0].vaddr);
+    EXPECT_EQ((uint32_t)FRAME_SIZE + PAGE_SIZE, ranges[0].size);
+    EXPECT_EQ(0, ranges[0].first);
+    EXPECT_EQ(2, ranges[0].count);
+    EXPECT_EQ(vaddr[2], ranges[1].vaddr);
+    EXPECT_EQ(256u, ranges[1].size);
+    EXPECT_EQ(2, ranges[1].first);
+    EXPECT_EQ(1, ranges[1].count);
+}
+
+TEST_F(GrallocBufferMapperTest, RangesSkipEmptyAndSplitUnaligned)
+{
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    GttRange ranges[SUB_BUFFER_MAX];
+    setVideoBuffer(0, vaddr, size);
+
+    // an empty sub buffer does not break the range around it
+    vaddr[2] = vaddr[1];
+    size[2] = size[1];
+    vaddr[1] = 0;
+    size[1] = 0;
+    ASSERT_EQ(1, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+    EXPECT_EQ(0, ranges[0].first);
+    EXPECT_EQ(3, ranges[0].count);
+
+    // a sub buffer starting inside a page gets its own mapping
+    vaddr[2] = (char*)vaddr[2] + 64;
+    EXPECT_EQ(2, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+
+    // as does one behind a gap
+    vaddr[2] = (char*)vaddr[2] - 64 + PAGE_SIZE;
+    EXPECT_EQ(2, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+
+    memset(vaddr, 0, sizeof(vaddr));
+    EXPECT_EQ(0, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+}
+
+TEST_F(GrallocBufferMapperTest, RangeStartingInsidePage)
+{
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    GttRange ranges[SUB_BUFFER_MAX];
+    memset(vaddr, 0, sizeof(vaddr));
+    memset(size, 0, sizeof(size));
+    vaddr[0] = (void*)0x40000800;
+    size[0] = 0x800;
+    vaddr[1] = (void*)0x40001000;
+    size[1] = 0x10;
+
+    ASSERT_EQ(1, TestGrallocMapper::getGttRanges(vaddr, size, ranges));
+    EXPECT_EQ(0x810u, ranges[0].size);
+
+    // the second sub buffer is one page into the mapping
+    TestGrallocMapper mapper(*mBuffer, vaddr, size);
+    ASSERT_TRUE(mapper.map());
+    EXPECT_EQ(1, FakeHwcomposer::get().counters.gttMapCount);
+    EXPECT_EQ(mapper.getGttOffsetInPage(0) + 1, mapper.getGttOffsetInPage(1));
+    mapper.unmap();
+}
+
+TEST_F(GrallocBufferMapperTest, OneIoctlPerRange)
+{
+    FakeHwcCounters& counters = FakeHwcomposer::get().counters;
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    setVideoBuffer(0, vaddr, size);
+
+    TestGrallocMapper mapper(*mBuffer, vaddr, size);
+    ASSERT_TRUE(mapper.map());
+    EXPECT_EQ(2, counters.gttMapCount);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(vaddr[i], mapper.getCpuAddress(i));
+        EXPECT_EQ(size[i], mapper.getSize(i));
+    }
+    EXPECT_EQ(mapper.getGttOffsetInPage(0) + FRAME_SIZE / PAGE_SIZE,
+              mapper.getGttOffsetInPage(1));
+
+    mapper.unmap();
+    EXPECT_EQ(2, counters.gttUnmapCount);
+    EXPECT_EQ(0, mapper.getCpuAddress(0));
+    EXPECT_EQ(0, mapper.getCpuAddress(1));
+}
+
+TEST_F(GrallocBufferMapperTest, FallbackMapsSubBuffersOneByOne)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    setVideoBuffer(0, vaddr, size);
+
+    // the merged range is refused, its sub buffers are not
+    hwc.gttMapLimit = FRAME_SIZE;
+    TestGrallocMapper mapper(*mBuffer, vaddr, size);
+    ASSERT_TRUE(mapper.map());
+    EXPECT_EQ(4, hwc.counters.gttMapCount);
+    EXPECT_EQ(vaddr[1], mapper.getCpuAddress(1));
+
+    mapper.unmap();
+    EXPECT_EQ(3, hwc.counters.gttUnmapCount);
+}
+
+TEST_F(GrallocBufferMapperTest, FailureLeavesNothingMapped)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+    setVideoBuffer(0, vaddr, size);
+
+    // the frame maps, the metadata does not
+    size[2] = FRAME_SIZE + PAGE_SIZE + 1;
+    hwc.gttMapLimit = FRAME_SIZE + PAGE_SIZE;
+    TestGrallocMapper mapper(*mBuffer, vaddr, size);
+    EXPECT_FALSE(mapper.map());
+    EXPECT_EQ(2, hwc.counters.gttMapCount);
+    EXPECT_EQ(1, hwc.counters.gttUnmapCount);
+    for (int i = 0; i < SUB_BUFFER_MAX; i++) {
+        EXPECT_EQ(0, mapper.getCpuAddress(i));
+    }
+}
+
+TEST_F(GrallocBufferMapperTest, DecoderPool)
+{
+    FakeHwcomposer& hwc = FakeHwcomposer::get();
+    DataBuffer *buffers[POOL_SIZE];
+    TestGrallocMapper *mappers[POOL_SIZE];
+    void *vaddr[SUB_BUFFER_MAX];
+    uint32_t size[SUB_BUFFER_MAX];
+
+    for (int i = 0; i < POOL_SIZE; i++) {
+        buffers[i] = new DataBuffer((buffer_handle_t)(0x2000 + i));
+        setVideoBuffer(i, vaddr, size);
+        mappers[i] = new TestGrallocMapper(*buffers[i], vaddr, size);
+    }
+
+    // two ioctls per buffer instead of one per sub buffer
+    ASSERT_TRUE(GrallocBufferMapperBase::mapBuffers(
+            (GrallocBufferMapperBase**)mappers, POOL_SIZE));
+    EXPECT_EQ(2 * POOL_SIZE, hwc.counters.gttMapCount);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        mappers[i]->unmap();
+    }
+    EXPECT_EQ(2 * POOL_SIZE, hwc.counters.gttUnmapCount);
+
+    // a buffer in the middle fails, every mapping made is undone
+    memset(&hwc.counters, 0, sizeof(hwc.counters));
+    setVideoBuffer(5, vaddr, size);
+    size[2] = FRAME_SIZE + PAGE_SIZE + 1;
+    delete mappers[5];
+    mappers[5] = new TestGrallocMapper(*buffers[5], vaddr, size);
+    hwc.gttMapLimit = FRAME_SIZE + PAGE_SIZE;
+    EXPECT_FALSE(GrallocBufferMapperBase::mapBuffers(
+            (GrallocBufferMapperBase**)mappers, POOL_SIZE));
+    EXPECT_EQ(12, hwc.counters.gttMapCount);
+    EXPECT_EQ(11, hwc.counters.gttUnmapCount);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        EXPECT_EQ(0, mappers[i]->getCpuAddress(0));
+    }
+
+    for (int i = 0; i < POOL_SIZE; i++) {
+        delete mappers[i];
+        delete buffers[i];
+    }
+}
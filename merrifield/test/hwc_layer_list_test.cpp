@@ -0,0 +1,203 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <hal_public.h>
+#include <HwcLayerList.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+// frame as surface flinger sends it: a video layer, a UI layer on top and
+// the frame buffer target
+class HwcLayerListTest : public ::testing::Test {
+protected:
+    enum {
+        LAYER_COUNT = 3,
+        VIDEO_LAYER = 0,
+        UI_LAYER = 1,
+        TARGET_LAYER = 2,
+    };
+
+    virtual void SetUp() {
+        FakeHwcomposer::get().reset();
+        mDisplay = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + LAYER_COUNT * sizeof(hwc_layer_1_t));
+        mDisplay->numHwLayers = LAYER_COUNT;
+        mVideo = FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_NV12, 1280, 720);
+        mUi = FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080);
+        mTarget = FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080);
+        setLayer(VIDEO_LAYER, mVideo, 1280, 720);
+        setLayer(UI_LAYER, mUi, 1920, 1080);
+        setLayer(TARGET_LAYER, mTarget, 1920, 1080);
+        mDisplay->hwLayers[TARGET_LAYER].compositionType = HWC_FRAMEBUFFER_TARGET;
+        mDisplay->flags = HWC_GEOMETRY_CHANGED;
+    }
+
+    virtual void TearDown() {
+        free(mDisplay);
+    }
+
+    void setLayer(int index, buffer_handle_t handle, int width, int height) {
+        hwc_layer_1_t& layer = mDisplay->hwLayers[index];
+        layer.compositionType = HWC_FRAMEBUFFER;
+        layer.handle = handle;
+        layer.blending = index == UI_LAYER ? HWC_BLENDING_PREMULT : HWC_BLENDING_NONE;
+        layer.planeAlpha = 0xff;
+        layer.sourceCropf.right = width;
+        layer.sourceCropf.bottom = height;
+        layer.displayFrame.right = 1920;
+        layer.displayFrame.bottom = 1080;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+    }
+
+    // surface flinger keeps the types set by the plan until the
+    // geometry changes
+    void nextFrame(bool geometryChanged) {
+        mDisplay->flags = geometryChanged ? HWC_GEOMETRY_CHANGED : 0;
+        if (!geometryChanged) {
+            return;
+        }
+        for (int i = 0; i < LAYER_COUNT; i++) {
+            hwc_layer_1_t& layer = mDisplay->hwLayers[i];
+            if (layer.compositionType != HWC_FRAMEBUFFER_TARGET) {
+                layer.compositionType = HWC_FRAMEBUFFER;
+            }
+        }
+    }
+
+    // what PhysicalDevice does for one frame
+    HwcLayerList* prepare(HwcLayerList *list) {
+        if (list && list->isSuspended()) {
+            if (list->restore(mDisplay)) {
+                EXPECT_TRUE(list->update(mDisplay));
+                return list;
+            }
+            list->resetCompositionTypes(mDisplay);
+            delete list;
+            list = NULL;
+            nextFrame(true);
+        }
+        if (!list) {
+            list = new HwcLayerList(mDisplay, IDisplayDevice::DEVICE_PRIMARY, false);
+        }
+        EXPECT_TRUE(list->update(mDisplay));
+        return list;
+    }
+
+protected:
+    hwc_display_contents_1_t *mDisplay;
+    buffer_handle_t mVideo;
+    buffer_handle_t mUi;
+    buffer_handle_t mTarget;
+};
+
+TEST_F(HwcLayerListTest, UnblankReusesPlanesAndMappings)
+{
+    HwcLayerList *list = prepare(NULL);
+    list->postFlip();
+    ASSERT_EQ(HWC_OVERLAY, mDisplay->hwLayers[VIDEO_LAYER].compositionType);
+    ASSERT_TRUE(list->getPlane(VIDEO_LAYER) != NULL);
+    DisplayPlane *videoPlane = list->getPlane(VIDEO_LAYER);
+
+    // blank, then the first frame after unblank
+    list->suspend();
+    FakeHwcCounters before = FakeHwcomposer::get().counters;
+    nextFrame(false);
+    list = prepare(list);
+
+    FakeHwcCounters& after = FakeHwcomposer::get().counters;
+    EXPECT_FALSE(list->isSuspended());
+    EXPECT_EQ(before.assignCount, after.assignCount);
+    EXPECT_EQ(before.mapCount, after.mapCount);
+    EXPECT_EQ(before.unmapCount, after.unmapCount);
+    EXPECT_EQ(videoPlane, list->getPlane(VIDEO_LAYER));
+    EXPECT_EQ(HWC_OVERLAY, mDisplay->hwLayers[VIDEO_LAYER].compositionType);
+    delete list;
+}
+
+TEST_F(HwcLayerListTest, UnblankWithGeometryChangeKeepsPlan)
+{
+    HwcLayerList *list = prepare(NULL);
+    list->postFlip();
+    list->suspend();
+
+    // surface flinger resets the types, the plan sets them again
+    FakeHwcCounters before = FakeHwcomposer::get().counters;
+    nextFrame(true);
+    list = prepare(list);
+
+    EXPECT_EQ(before.assignCount, FakeHwcomposer::get().counters.assignCount);
+    EXPECT_EQ(before.mapCount, FakeHwcomposer::get().counters.mapCount);
+    EXPECT_EQ(HWC_OVERLAY, mDisplay->hwLayers[VIDEO_LAYER].compositionType);
+    delete list;
+}
+
+TEST_F(HwcLayerListTest, UnblankWithNewVideoBufferMapsOnlyIt)
+{
+    HwcLayerList *list = prepare(NULL);
+    list->postFlip();
+    list->suspend();
+
+    // decoder moved on during blank
+    FakeHwcCounters before = FakeHwcomposer::get().counters;
+    mDisplay->hwLayers[VIDEO_LAYER].handle =
+        FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_NV12, 1280, 720);
+    nextFrame(false);
+    list = prepare(list);
+
+    EXPECT_FALSE(list->isSuspended());
+    EXPECT_EQ(before.assignCount, FakeHwcomposer::get().counters.assignCount);
+    EXPECT_EQ(before.mapCount + 1, FakeHwcomposer::get().counters.mapCount);
+    delete list;
+}
+
+TEST_F(HwcLayerListTest, UnblankWithChangedLayersRebuilds)
+{
+    HwcLayerList *list = prepare(NULL);
+    list->postFlip();
+    list->suspend();
+
+    // video got resized while blanked
+    FakeHwcCounters before = FakeHwcomposer::get().counters;
+    nextFrame(false);
+    mDisplay->hwLayers[VIDEO_LAYER].displayFrame.right = 960;
+    list = prepare(list);
+
+    EXPECT_FALSE(list->isSuspended());
+    EXPECT_LT(before.assignCount, FakeHwcomposer::get().counters.assignCount);
+    EXPECT_EQ(HWC_OVERLAY, mDisplay->hwLayers[VIDEO_LAYER].compositionType);
+    delete list;
+}
+
+TEST_F(HwcLayerListTest, UnblankWithNewFormatRebuilds)
+{
+    HwcLayerList *list = prepare(NULL);
+    list->postFlip();
+    list->suspend();
+
+    FakeHwcCounters before = FakeHwcomposer::get().counters;
+    mDisplay->hwLayers[VIDEO_LAYER].handle =
+        FakeHwcomposer::get().addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1280, 720);
+    nextFrame(false);
+    list = prepare(list);
+
+    EXPECT_LT(before.assignCount, FakeHwcomposer::get().counters.assignCount);
+    delete list;
+}
@@ -0,0 +1,235 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <hal_public.h>
+#include <utils/Timers.h>
+#include <HwcLayerList.h>
+#include <HwcTrace.h>
+#include "fake_hwcomposer.h"
+
+using namespace android;
+using namespace android::intel;
+
+static int sFormatted;
+
+// stands in for the arguments of a message, counts their evaluation
+static int format()
+{
+    return ++sFormatted;
+}
+
+static int32_t nowMs()
+{
+    return (int32_t)ns2ms(systemTime(SYSTEM_TIME_MONOTONIC));
+}
+
+class HwcTraceTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mLevel = android_atomic_acquire_load(&gHwcTraceLevel);
+        sFormatted = 0;
+    }
+
+    virtual void TearDown() {
+        android_atomic_release_store(mLevel, &gHwcTraceLevel);
+    }
+
+    void setLevel(int32_t level) {
+        android_atomic_release_store(level, &gHwcTraceLevel);
+    }
+
+protected:
+    int32_t mLevel;
+};
+
+TEST_F(HwcTraceTest, LevelSkipsArguments)
+{
+    setLevel(ANDROID_LOG_WARN);
+    DTRACE("%d", format());
+    ITRACE("%d", format());
+    EXPECT_EQ(0, sFormatted);
+    WTRACE("%d", format());
+    EXPECT_EQ(1, sFormatted);
+
+    setLevel(ANDROID_LOG_SILENT);
+    WTRACE("%d", format());
+    WTRACE_LIMITED("%d", format());
+    EXPECT_EQ(1, sFormatted);
+}
+
+TEST_F(HwcTraceTest, LimitedSiteLogsOncePerInterval)
+{
+    setLevel(ANDROID_LOG_DEBUG);
+    // the site may still be muted from a repeated run of the test
+    for (int i = 0; i < 1000; i++) {
+        DTRACE_LIMITED("%d", format());
+    }
+    EXPECT_GE(1, sFormatted);
+}
+
+TEST_F(HwcTraceTest, RateLimitCountsMuted)
+{
+    volatile int32_t last = 0;
+    volatile int32_t muted = 0;
+
+    EXPECT_EQ(0, hwcTraceRateLimit(&last, &muted));
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(-1, hwcTraceRateLimit(&last, &muted));
+    }
+    EXPECT_EQ(5, muted);
+
+    // a second later the next message reports what was muted
+    last = nowMs() - 1000;
+    EXPECT_EQ(5, hwcTraceRateLimit(&last, &muted));
+    EXPECT_EQ(0, muted);
+    EXPECT_EQ(-1, hwcTraceRateLimit(&last, &muted));
+}
+
+TEST_F(HwcTraceTest, RateLimitAcrossMillisecondWrap)
+{
+    volatile int32_t muted = 0;
+
+    // the millisecond counter wrapped since the site logged
+    volatile int32_t last = (int32_t)((uint32_t)nowMs() - 500u);
+    EXPECT_EQ(-1, hwcTraceRateLimit(&last, &muted));
+    last = (int32_t)((uint32_t)nowMs() - 0x80000000u);
+    EXPECT_EQ(1, hwcTraceRateLimit(&last, &muted));
+}
+
+struct RateLimitRace {
+    volatile int32_t last;
+    volatile int32_t muted;
+    volatile int32_t logged;
+};
+
+static void* raceRateLimit(void *data)
+{
+    RateLimitRace *race = (RateLimitRace*)data;
+    for (int i = 0; i < 1000; i++) {
+        if (hwcTraceRateLimit(&race->last, &race->muted) >= 0) {
+            android_atomic_inc(&race->logged);
+        }
+    }
+    return NULL;
+}
+
+TEST_F(HwcTraceTest, RacingThreadsLogOnce)
+{
+    enum {
+        THREAD_COUNT = 4,
+    };
+    RateLimitRace race = {0, 0, 0};
+    pthread_t threads[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        ASSERT_EQ(0, pthread_create(&threads[i], NULL, raceRateLimit, &race));
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // the threads finish well within the interval
+    EXPECT_EQ(1, race.logged);
+    EXPECT_EQ(THREAD_COUNT * 1000 - 1, race.muted);
+}
+
+// a mouse cursor left below an app window, every frame of the drag warns
+// that the cursor is not on top
+class LogHeavyReplayTest : public HwcTraceTest {
+protected:
+    enum {
+        LAYER_COUNT = 3,
+        CURSOR_LAYER = 0,
+        APP_LAYER = 1,
+        TARGET_LAYER = 2,
+        FRAME_COUNT = 300,
+    };
+
+    virtual void SetUp() {
+        HwcTraceTest::SetUp();
+        FakeHwcomposer& hwc = FakeHwcomposer::get();
+        hwc.reset();
+        mDisplay = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) + LAYER_COUNT * sizeof(hwc_layer_1_t));
+        mDisplay->numHwLayers = LAYER_COUNT;
+        const hwc_rect_t cursor = {0, 0, 64, 64};
+        const hwc_rect_t full = {0, 0, 1920, 1080};
+        setLayer(CURSOR_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 64, 64),
+                 cursor, HWC_BLENDING_PREMULT);
+        setLayer(APP_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBA_8888, 1920, 1080),
+                 full, HWC_BLENDING_PREMULT);
+        setLayer(TARGET_LAYER, hwc.addBuffer(HAL_PIXEL_FORMAT_RGBX_8888, 1920, 1080),
+                 full, HWC_BLENDING_NONE);
+        mDisplay->hwLayers[CURSOR_LAYER].flags = HWC_IS_CURSOR_LAYER;
+        mDisplay->hwLayers[TARGET_LAYER].compositionType = HWC_FRAMEBUFFER_TARGET;
+    }
+
+    virtual void TearDown() {
+        free(mDisplay);
+        HwcTraceTest::TearDown();
+    }
+
+    void setLayer(int index, buffer_handle_t handle, const hwc_rect_t& frame,
+                  int32_t blending) {
+        hwc_layer_1_t& layer = mDisplay->hwLayers[index];
+        layer.compositionType = HWC_FRAMEBUFFER;
+        layer.handle = handle;
+        layer.blending = blending;
+        layer.planeAlpha = 0xff;
+        layer.sourceCropf.right = frame.right - frame.left;
+        layer.sourceCropf.bottom = frame.bottom - frame.top;
+        layer.displayFrame = frame;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+    }
+
+    // the cursor moves on every frame, returns the time spent preparing
+    // in microseconds
+    int64_t replayDrag() {
+        hwc_layer_1_t& cursor = mDisplay->hwLayers[CURSOR_LAYER];
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        for (int i = 0; i < FRAME_COUNT; i++) {
+            cursor.displayFrame.left = i * 6;
+            cursor.displayFrame.right = i * 6 + 64;
+            cursor.compositionType = HWC_FRAMEBUFFER;
+            mDisplay->hwLayers[APP_LAYER].compositionType = HWC_FRAMEBUFFER;
+            mDisplay->flags = HWC_GEOMETRY_CHANGED;
+            HwcLayerList list(mDisplay, IDisplayDevice::DEVICE_PRIMARY, false);
+            EXPECT_TRUE(list.update(mDisplay));
+            list.postFlip();
+        }
+        return ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+    }
+
+protected:
+    hwc_display_contents_1_t *mDisplay;
+};
+
+TEST_F(LogHeavyReplayTest, Drag)
+{
+    setLevel(ANDROID_LOG_SILENT);
+    int64_t silentUs = replayDrag();
+    int32_t silentType = mDisplay->hwLayers[CURSOR_LAYER].compositionType;
+    setLevel(ANDROID_LOG_DEBUG);
+    int64_t limitedUs = replayDrag();
+    RecordProperty("silent_prepare_us", (int)silentUs);
+    RecordProperty("limited_prepare_us", (int)limitedUs);
+
+    // logging doesn't change the plan
+    EXPECT_EQ(silentType, mDisplay->hwLayers[CURSOR_LAYER].compositionType);
+}
@@ -0,0 +1,134 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <hal_public.h>
+#include <OMX_IntelVideoExt.h>
+
+#include <BandwidthEstimator.h>
+#include <common/LineSkipPolicy.h>
+
+using namespace android::intel;
+
+TEST(LineSkipPolicyTest, MinRatio)
+{
+    EXPECT_TRUE(LineSkipPolicy::isEligible(2160, 1080));
+    EXPECT_TRUE(LineSkipPolicy::isEligible(1080, 540));
+    EXPECT_FALSE(LineSkipPolicy::isEligible(1080, 541));
+
+    // 1080p video on a 720p pipe would be upscaled from a field
+    EXPECT_FALSE(LineSkipPolicy::isEligible(1080, 720));
+    EXPECT_FALSE(LineSkipPolicy::isEligible(720, 720));
+    EXPECT_FALSE(LineSkipPolicy::isEligible(1080, 0));
+}
+
+TEST(LineSkipPolicyTest, Hysteresis)
+{
+    // starts skipping only over the budget
+    EXPECT_FALSE(LineSkipPolicy::update(false, 1000, 1000));
+    EXPECT_TRUE(LineSkipPolicy::update(false, 1001, 1000));
+
+    // and keeps skipping until 10% below it
+    EXPECT_TRUE(LineSkipPolicy::update(true, 1001, 1000));
+    EXPECT_TRUE(LineSkipPolicy::update(true, 900, 1000));
+    EXPECT_FALSE(LineSkipPolicy::update(true, 899, 1000));
+
+    // large budgets do not overflow
+    EXPECT_TRUE(LineSkipPolicy::update(true, 0xf0000000, 0xffffffff));
+}
+
+// a video plane under a full screen UI plane on a 1080p60 pipe. The
+// policy is fed what all planes would fetch with every video line,
+// what the pipe fetches is what the overlay does with its decision
+class LineSkipModelTest : public ::testing::Test {
+protected:
+    enum {
+        VDISPLAY = 1080,
+        REFRESH = 60,
+        BUDGET = 1000,
+    };
+
+    virtual void SetUp() {
+        mSkipping = false;
+        mUi = BandwidthEstimator::getPlaneBandwidth(HAL_PIXEL_FORMAT_RGBA_8888,
+                1920, 1080, 1080, VDISPLAY, REFRESH);
+    }
+
+    // fetch bandwidth of the pipe for one frame
+    uint32_t frame(int srcWidth, int srcHeight, int dstHeight) {
+        uint32_t video = BandwidthEstimator::getPlaneBandwidth(
+                OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+                srcWidth, srcHeight, dstHeight, VDISPLAY, REFRESH);
+        if (!LineSkipPolicy::isEligible(srcHeight, dstHeight)) {
+            mSkipping = false;
+        } else {
+            mSkipping = LineSkipPolicy::update(mSkipping, mUi + video, BUDGET);
+        }
+        return mUi + (mSkipping ? video / 2 : video);
+    }
+
+protected:
+    bool mSkipping;
+    uint32_t mUi;
+};
+
+TEST_F(LineSkipModelTest, DownscaledVideoFitsBudget)
+{
+    // 2160p video fullscreen: 497 + 746 MB/s, fetched by field 870 MB/s
+    EXPECT_EQ(870u, frame(3840, 2160, 1080));
+    EXPECT_TRUE(mSkipping);
+
+    // the decision is stable from frame to frame
+    for (int i = 0; i < 60; i++) {
+        EXPECT_EQ(870u, frame(3840, 2160, 1080));
+    }
+
+    // at 4x the field still leaves the scaler two lines per output line,
+    // and costs what 2x costs with every line
+    EXPECT_EQ(1243u, frame(3840, 2160, 540));
+    EXPECT_TRUE(mSkipping);
+}
+
+TEST_F(LineSkipModelTest, NoSkipWithinBudget)
+{
+    // 1080p video fullscreen is no downscale
+    EXPECT_EQ(683u, frame(1920, 1080, 1080));
+    EXPECT_FALSE(mSkipping);
+
+    // 1440p at 2x in a window is within budget and keeps every line
+    EXPECT_EQ(994u, frame(2560, 1440, 720));
+    EXPECT_FALSE(mSkipping);
+}
+
+TEST_F(LineSkipModelTest, LeavesFieldFetchWithMargin)
+{
+    EXPECT_EQ(870u, frame(3840, 2160, 1080));
+
+    // a smaller video needs 994 MB/s with every line, within the margin
+    // below the budget it keeps skipping
+    EXPECT_EQ(745u, frame(2560, 1440, 720));
+    EXPECT_TRUE(mSkipping);
+
+    // 870 MB/s is more than the margin below, all lines are fetched again
+    EXPECT_EQ(870u, frame(1920, 1080, 540));
+    EXPECT_FALSE(mSkipping);
+
+    // video that is not downscaled stops skipping at once
+    frame(3840, 2160, 1080);
+    EXPECT_TRUE(mSkipping);
+    EXPECT_EQ(683u, frame(1920, 1080, 1080));
+    EXPECT_FALSE(mSkipping);
+}
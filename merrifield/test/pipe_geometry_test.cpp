@@ -0,0 +1,112 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <hardware/hwcomposer.h>
+
+#include <PipeGeometry.h>
+
+using namespace android::intel;
+
+static void expectFrame(const hwc_rect_t& frame, int left, int top, int right, int bottom)
+{
+    EXPECT_EQ(left, frame.left);
+    EXPECT_EQ(top, frame.top);
+    EXPECT_EQ(right, frame.right);
+    EXPECT_EQ(bottom, frame.bottom);
+}
+
+TEST(PipeGeometryTest, SourceFillsMode)
+{
+    int width, height;
+    hwc_rect_t frame;
+
+    // the fitter can't shrink an image as large as the mode
+    EXPECT_FALSE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 0, 0,
+            1920, 1080, 1920, 1080, width, height, frame));
+    EXPECT_FALSE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 10, 10,
+            1920, 1080, 1920, 1080, width, height, frame));
+    EXPECT_EQ(1920, width);
+    EXPECT_EQ(1080, height);
+    expectFrame(frame, 0, 0, 1920, 1080);
+
+    // scaling type is identity when the source is the mode
+    EXPECT_FALSE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_FULL, 0, 0,
+            1920, 1080, 1920, 1080, width, height, frame));
+    EXPECT_FALSE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_CENTER, 0, 0,
+            1920, 1080, 1920, 1080, width, height, frame));
+    expectFrame(frame, 0, 0, 1920, 1080);
+}
+
+TEST(PipeGeometryTest, ScaleUp)
+{
+    int width, height;
+    hwc_rect_t frame;
+
+    // the image is the whole pipe source, the fitter scales it to the mode
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 0, 0,
+            1280, 720, 1920, 1080, width, height, frame));
+    EXPECT_EQ(1280, width);
+    EXPECT_EQ(720, height);
+    expectFrame(frame, 0, 0, 1280, 720);
+
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_FULL, 0, 0,
+            720, 576, 1920, 1080, width, height, frame));
+    EXPECT_EQ(720, width);
+    EXPECT_EQ(576, height);
+    expectFrame(frame, 0, 0, 720, 576);
+
+    // an image taller than the mode needs a downscale the fitter can't do,
+    // the pipe source keeps its size and Drm::setPipeSource rejects it
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 0, 0,
+            720, 1280, 1920, 1080, width, height, frame));
+    EXPECT_EQ(720, width);
+    EXPECT_EQ(1280, height);
+    expectFrame(frame, 0, 0, 720, 1280);
+}
+
+TEST(PipeGeometryTest, Center)
+{
+    int width, height;
+    hwc_rect_t frame;
+
+    // pipe source is the mode, the image sits 1:1 in its middle
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_CENTER, 10, 10,
+            1280, 720, 1920, 1080, width, height, frame));
+    EXPECT_EQ(1920, width);
+    EXPECT_EQ(1080, height);
+    expectFrame(frame, 320, 180, 1600, 900);
+}
+
+TEST(PipeGeometryTest, Overscan)
+{
+    int width, height;
+    hwc_rect_t frame;
+
+    // 10% margins around the image, half on each side
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 10, 10,
+            1280, 720, 1920, 1080, width, height, frame));
+    EXPECT_EQ(1422, width);
+    EXPECT_EQ(800, height);
+    expectFrame(frame, 71, 40, 1351, 760);
+
+    // margins are limited by the mode
+    EXPECT_TRUE(PipeGeometry::getPipeSource(PipeGeometry::SCALING_ASPECT, 20, 20,
+            1600, 900, 1920, 1080, width, height, frame));
+    EXPECT_EQ(1920, width);
+    EXPECT_EQ(1080, height);
+    expectFrame(frame, 160, 90, 1760, 990);
+}
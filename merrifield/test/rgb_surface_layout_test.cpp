@@ -0,0 +1,124 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <common/RgbSurfaceLayout.h>
+
+using namespace android::intel;
+
+// register values of a 1080p panel, golden values are worked out by hand
+// from the display controller fetch model
+class RgbSurfaceLayoutTest : public ::testing::Test {
+protected:
+    static crop_t crop(int x, int y, int w, int h) {
+        crop_t c = {x, y, w, h};
+        return c;
+    }
+};
+
+TEST_F(RgbSurfaceLayoutTest, Linear)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    ASSERT_TRUE(RgbSurfaceLayout::getLinear(crop(0, 0, 1920, 1080), 1080, 7680, 4,
+            false, offsets));
+    EXPECT_EQ(7680U, offsets.stride);
+    EXPECT_EQ(0U, offsets.linoff);
+    EXPECT_EQ(0U, offsets.tileoff);
+
+    // 8 lines down, 16 pixels in
+    ASSERT_TRUE(RgbSurfaceLayout::getLinear(crop(16, 8, 100, 50), 1080, 7680, 4,
+            false, offsets));
+    EXPECT_EQ(61504U, offsets.linoff);
+
+    // RGB565
+    ASSERT_TRUE(RgbSurfaceLayout::getLinear(crop(16, 8, 100, 50), 1080, 3840, 2,
+            false, offsets));
+    EXPECT_EQ(3840U, offsets.stride);
+    EXPECT_EQ(30752U, offsets.linoff);
+}
+
+TEST_F(RgbSurfaceLayoutTest, LinearRotated)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    // last pixel of the surface
+    ASSERT_TRUE(RgbSurfaceLayout::getLinear(crop(0, 0, 1920, 1080), 1080, 7680, 4,
+            true, offsets));
+    EXPECT_EQ(7680U, offsets.stride);
+    EXPECT_EQ(1079U * 7680 + 1919 * 4, offsets.linoff);
+    EXPECT_EQ(0U, offsets.tileoff);
+
+    // last pixel of the crop
+    ASSERT_TRUE(RgbSurfaceLayout::getLinear(crop(16, 8, 100, 50), 1080, 7680, 4,
+            true, offsets));
+    EXPECT_EQ(438220U, offsets.linoff);
+}
+
+TEST_F(RgbSurfaceLayoutTest, LinearInvalidCrop)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    EXPECT_FALSE(RgbSurfaceLayout::getLinear(crop(0, 1081, 1920, 1), 1080, 7680, 4,
+            false, offsets));
+    EXPECT_FALSE(RgbSurfaceLayout::getLinear(crop(0, 1000, 1920, 200), 1080, 7680, 4,
+            true, offsets));
+}
+
+TEST_F(RgbSurfaceLayoutTest, Tiled)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    // register stride is the tiled one, not the gralloc stride
+    ASSERT_TRUE(RgbSurfaceLayout::getTiled(crop(0, 0, 1920, 1080), 1920, 1080,
+            false, offsets));
+    EXPECT_EQ(7680U, offsets.stride);
+    EXPECT_EQ(32399U, offsets.linoff);
+    EXPECT_EQ(0U, offsets.tileoff);
+
+    // crop is given in pixels through tileoff
+    ASSERT_TRUE(RgbSurfaceLayout::getTiled(crop(16, 8, 100, 50), 1920, 1080,
+            false, offsets));
+    EXPECT_EQ(7680U, offsets.stride);
+    EXPECT_EQ(32399U, offsets.linoff);
+    EXPECT_EQ(0x80010U, offsets.tileoff);
+
+    // portrait panel, width padded to whole tiles
+    ASSERT_TRUE(RgbSurfaceLayout::getTiled(crop(0, 0, 1080, 1920), 1080, 1920,
+            false, offsets));
+    EXPECT_EQ(4352U, offsets.stride);
+    EXPECT_EQ(32639U, offsets.linoff);
+}
+
+TEST_F(RgbSurfaceLayoutTest, TiledRotatedIsRefused)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    EXPECT_FALSE(RgbSurfaceLayout::getTiled(crop(0, 0, 1920, 1080), 1920, 1080,
+            true, offsets));
+    EXPECT_FALSE(RgbSurfaceLayout::getTiled(crop(16, 8, 100, 50), 1920, 1080,
+            true, offsets));
+}
+
+TEST_F(RgbSurfaceLayoutTest, TiledInvalidCrop)
+{
+    RgbSurfaceLayout::Offsets offsets;
+
+    EXPECT_FALSE(RgbSurfaceLayout::getTiled(crop(1900, 0, 100, 50), 1920, 1080,
+            false, offsets));
+    EXPECT_FALSE(RgbSurfaceLayout::getTiled(crop(0, 1080, 100, 1), 1920, 1080,
+            false, offsets));
+}
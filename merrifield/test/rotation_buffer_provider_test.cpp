@@ -0,0 +1,175 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <hardware/hwcomposer.h>
+#include <utils/Timers.h>
+#include <common/RotationBufferProvider.h>
+#include "fake_va.h"
+
+using namespace android;
+using namespace android::intel;
+
+// 720p video decoded into a pool of eight buffers and rotated for a
+// portrait panel
+class RotationBufferProviderTest : public ::testing::Test {
+protected:
+    enum {
+        POOL_SIZE = 8,
+        TARGET_COUNT = 4,
+    };
+
+    RotationBufferProviderTest()
+        : mWsbm(-1),
+          mProvider(&mWsbm),
+          mFrame(0)
+    {
+    }
+
+    virtual void SetUp() {
+        FakeVa::get().reset();
+        ASSERT_TRUE(mProvider.initialize());
+        memset(&mPayload, 0, sizeof(mPayload));
+        mPayload.format = VA_FOURCC_NV12;
+        mPayload.width = mPayload.crop_width = 1280;
+        mPayload.height = mPayload.crop_height = 720;
+        mPayload.luma_stride = 1280;
+    }
+
+    virtual void TearDown() {
+        mProvider.deinitialize();
+        EXPECT_EQ(0u, FakeVa::get().surfaces.size());
+        EXPECT_EQ(0, FakeVa::get().counters.badDestroyCount);
+    }
+
+    // the next decoded frame, returns the time spent in microseconds
+    int64_t rotate(int transform, int count = 1) {
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        for (int i = 0; i < count; i++) {
+            mPayload.khandle = (buffer_handle_t)(uintptr_t)(0x100 + mFrame++ % POOL_SIZE);
+            EXPECT_TRUE(mProvider.setupRotationBuffer(&mPayload, transform));
+        }
+        return ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+    }
+
+protected:
+    Wsbm mWsbm;
+    RotationBufferProvider mProvider;
+    VideoPayloadBuffer mPayload;
+    int mFrame;
+};
+
+TEST_F(RotationBufferProviderTest, PoolIsWrappedOnce)
+{
+    int64_t us = rotate(HAL_TRANSFORM_ROT_90, 300);
+    RecordProperty("rotate_us", (int)us);
+
+    FakeVaCounters& counters = FakeVa::get().counters;
+    EXPECT_EQ(1, counters.initializeCount);
+    EXPECT_EQ(POOL_SIZE, counters.sourceSurfaceCount);
+    EXPECT_EQ(TARGET_COUNT, counters.targetSurfaceCount);
+    EXPECT_EQ(0, counters.destroySurfaceCount);
+    EXPECT_EQ(300, counters.renderCount);
+    EXPECT_EQ(1280, mPayload.rotated_height);
+}
+
+TEST_F(RotationBufferProviderTest, TransformChangeKeepsVa)
+{
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    FakeVaCounters before = FakeVa::get().counters;
+
+    // same target size, only the rotation of the pictures changes
+    rotate(HAL_TRANSFORM_ROT_270, 30);
+    FakeVaCounters& after = FakeVa::get().counters;
+    EXPECT_EQ(before.initializeCount, after.initializeCount);
+    EXPECT_EQ(before.contextCount, after.contextCount);
+    EXPECT_EQ(before.sourceSurfaceCount, after.sourceSurfaceCount);
+    EXPECT_EQ(before.targetSurfaceCount, after.targetSurfaceCount);
+    EXPECT_EQ((uint32_t)VA_ROTATION_270, FakeVa::get().pipeline.rotation_state);
+}
+
+TEST_F(RotationBufferProviderTest, UnswappedTransformResizesTargets)
+{
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    FakeVaCounters before = FakeVa::get().counters;
+
+    rotate(HAL_TRANSFORM_ROT_180, 30);
+    FakeVaCounters& after = FakeVa::get().counters;
+    EXPECT_EQ(before.initializeCount, after.initializeCount);
+    EXPECT_EQ(0, after.terminateCount);
+    EXPECT_EQ(before.sourceSurfaceCount, after.sourceSurfaceCount);
+    EXPECT_EQ(before.targetSurfaceCount + TARGET_COUNT, after.targetSurfaceCount);
+    EXPECT_EQ(before.destroySurfaceCount + TARGET_COUNT, after.destroySurfaceCount);
+    EXPECT_EQ(after.ttmAllocCount - TARGET_COUNT, after.ttmFreeCount);
+    EXPECT_EQ(720, mPayload.rotated_height);
+    EXPECT_EQ((uint32_t)VA_ROTATION_180, FakeVa::get().pipeline.rotation_state);
+}
+
+TEST_F(RotationBufferProviderTest, UnsupportedTransformStopsVa)
+{
+    FakeVa::get().rotationFlags = (1 << VA_ROTATION_90) | (1 << VA_ROTATION_270);
+    rotate(HAL_TRANSFORM_ROT_90, 10);
+
+    mPayload.khandle = (buffer_handle_t)0x100;
+    EXPECT_FALSE(mProvider.setupRotationBuffer(&mPayload, HAL_TRANSFORM_ROT_180));
+    EXPECT_EQ(1, FakeVa::get().counters.terminateCount);
+    EXPECT_EQ(0u, FakeVa::get().surfaces.size());
+}
+
+TEST_F(RotationBufferProviderTest, SourceLayoutChangeFlushesSources)
+{
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    FakeVaCounters before = FakeVa::get().counters;
+
+    // same pool, the decoder crops differently
+    mPayload.crop_height = 704;
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    FakeVaCounters& after = FakeVa::get().counters;
+    EXPECT_EQ(before.initializeCount, after.initializeCount);
+    EXPECT_EQ(before.sourceSurfaceCount + POOL_SIZE, after.sourceSurfaceCount);
+    EXPECT_EQ(before.destroySurfaceCount + POOL_SIZE, after.destroySurfaceCount);
+}
+
+TEST_F(RotationBufferProviderTest, ResetFlushesSources)
+{
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    mProvider.reset();
+    EXPECT_EQ(POOL_SIZE, FakeVa::get().counters.destroySurfaceCount);
+    EXPECT_EQ((size_t)TARGET_COUNT, FakeVa::get().surfaces.size());
+
+    // the decoder of the next session reuses the khandles
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+    EXPECT_EQ(2 * POOL_SIZE, FakeVa::get().counters.sourceSurfaceCount);
+    EXPECT_EQ(1, FakeVa::get().counters.initializeCount);
+}
+
+TEST_F(RotationBufferProviderTest, SizeChangeRestartsVa)
+{
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+
+    mPayload.width = mPayload.crop_width = 1920;
+    mPayload.height = mPayload.crop_height = 1080;
+    mPayload.luma_stride = 2048;
+    rotate(HAL_TRANSFORM_ROT_90, 30);
+
+    FakeVaCounters& counters = FakeVa::get().counters;
+    EXPECT_EQ(2, counters.initializeCount);
+    EXPECT_EQ(1, counters.terminateCount);
+    EXPECT_EQ(2 * POOL_SIZE, counters.sourceSurfaceCount);
+    EXPECT_EQ((size_t)(POOL_SIZE + TARGET_COUNT), FakeVa::get().surfaces.size());
+    EXPECT_EQ(1920, mPayload.rotated_height);
+}
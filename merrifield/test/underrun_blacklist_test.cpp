@@ -0,0 +1,121 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <hal_public.h>
+#include <DisplayPlane.h>
+#include <UnderrunBlacklist.h>
+
+using namespace android;
+using namespace android::intel;
+
+static PlaneConfig makeConfig(int planeType, int width, int scale)
+{
+    PlaneConfig config;
+    config.planeType = planeType;
+    config.format = HAL_PIXEL_FORMAT_NV12;
+    config.width = width;
+    config.scale = scale;
+    return config;
+}
+
+static const int DISP = IDisplayDevice::DEVICE_PRIMARY;
+static const int OVERLAY = DisplayPlane::PLANE_OVERLAY;
+static const int FULL = UnderrunBlacklist::SCALE_UNIT;
+
+TEST(UnderrunBlacklistTest, NoCandidateIsIgnored)
+{
+    UnderrunBlacklist blacklist;
+    uint32_t version = blacklist.getVersion();
+
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(0)));
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(10)));
+    EXPECT_EQ(version, blacklist.getVersion());
+}
+
+TEST(UnderrunBlacklistTest, RepeatedUnderrunsBlacklist)
+{
+    UnderrunBlacklist blacklist;
+    PlaneConfig config = makeConfig(OVERLAY, 1920, 2 * FULL);
+    blacklist.setCandidate(DISP, config);
+    uint32_t version = blacklist.getVersion();
+
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(100)));
+    EXPECT_FALSE(blacklist.isBlacklisted(config));
+    EXPECT_TRUE(blacklist.addUnderrun(DISP, ms2ns(200)));
+    EXPECT_TRUE(blacklist.isBlacklisted(config));
+    EXPECT_NE(version, blacklist.getVersion());
+
+    // already blacklisted
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(300)));
+}
+
+TEST(UnderrunBlacklistTest, SparseUnderrunsDoNotBlacklist)
+{
+    UnderrunBlacklist blacklist;
+    PlaneConfig config = makeConfig(OVERLAY, 1920, FULL);
+    blacklist.setCandidate(DISP, config);
+
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(0)));
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(1500)));
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(3000)));
+    EXPECT_FALSE(blacklist.isBlacklisted(config));
+
+    // the probation entry decays as well
+    blacklist.expire(ms2ns(5000));
+    EXPECT_FALSE(blacklist.addUnderrun(DISP, ms2ns(5100)));
+}
+
+TEST(UnderrunBlacklistTest, CostlierConfigIsBlacklisted)
+{
+    UnderrunBlacklist blacklist;
+    blacklist.setCandidate(DISP, makeConfig(OVERLAY, 1280, 2 * FULL));
+    blacklist.addUnderrun(DISP, ms2ns(0));
+    ASSERT_TRUE(blacklist.addUnderrun(DISP, ms2ns(16)));
+
+    EXPECT_TRUE(blacklist.isBlacklisted(makeConfig(OVERLAY, 1920, 2 * FULL)));
+    EXPECT_TRUE(blacklist.isBlacklisted(makeConfig(OVERLAY, 1280, 3 * FULL)));
+    EXPECT_FALSE(blacklist.isBlacklisted(makeConfig(OVERLAY, 720, 2 * FULL)));
+    EXPECT_FALSE(blacklist.isBlacklisted(makeConfig(OVERLAY, 1280, FULL)));
+    EXPECT_FALSE(blacklist.isBlacklisted(
+        makeConfig(DisplayPlane::PLANE_SPRITE, 1920, 2 * FULL)));
+}
+
+TEST(UnderrunBlacklistTest, BlacklistExpires)
+{
+    UnderrunBlacklist blacklist;
+    PlaneConfig config = makeConfig(OVERLAY, 1920, 2 * FULL);
+    blacklist.setCandidate(DISP, config);
+    blacklist.addUnderrun(DISP, ms2ns(0));
+    ASSERT_TRUE(blacklist.addUnderrun(DISP, ms2ns(16)));
+    uint32_t version = blacklist.getVersion();
+
+    blacklist.expire(ms2ns(30000));
+    EXPECT_TRUE(blacklist.isBlacklisted(config));
+    EXPECT_EQ(version, blacklist.getVersion());
+
+    // the layer list plans again with the configuration allowed
+    blacklist.expire(ms2ns(61000));
+    EXPECT_FALSE(blacklist.isBlacklisted(config));
+    EXPECT_NE(version, blacklist.getVersion());
+}
+
+TEST(UnderrunBlacklistTest, ScaleOfUpscaledSourceIsUnit)
+{
+    EXPECT_EQ(FULL, UnderrunBlacklist::getScale(720, 1080));
+    EXPECT_EQ(FULL, UnderrunBlacklist::getScale(1080, 1080));
+    EXPECT_EQ(2 * FULL, UnderrunBlacklist::getScale(1080, 540));
+}
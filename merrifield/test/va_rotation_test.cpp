@@ -0,0 +1,109 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <hardware/hwcomposer.h>
+#include <va/va.h>
+#include <va/va_vpp.h>
+
+#include <VaRotation.h>
+
+using namespace android::intel;
+
+TEST(VaRotationTest, FromHalTransform)
+{
+    EXPECT_EQ((uint32_t)VA_ROTATION_NONE, VaRotation::fromHalTransform(0));
+    EXPECT_EQ((uint32_t)VA_ROTATION_90, VaRotation::fromHalTransform(HAL_TRANSFORM_ROT_90));
+    EXPECT_EQ((uint32_t)VA_ROTATION_180, VaRotation::fromHalTransform(HAL_TRANSFORM_ROT_180));
+    EXPECT_EQ((uint32_t)VA_ROTATION_270, VaRotation::fromHalTransform(HAL_TRANSFORM_ROT_270));
+
+    // flips are not rotations
+    EXPECT_EQ((uint32_t)VA_ROTATION_NONE, VaRotation::fromHalTransform(HAL_TRANSFORM_FLIP_H));
+    EXPECT_EQ((uint32_t)VA_ROTATION_NONE, VaRotation::fromHalTransform(HAL_TRANSFORM_FLIP_V));
+}
+
+TEST(VaRotationTest, IsSwapped)
+{
+    EXPECT_FALSE(VaRotation::isSwapped(0));
+    EXPECT_TRUE(VaRotation::isSwapped(HAL_TRANSFORM_ROT_90));
+    EXPECT_FALSE(VaRotation::isSwapped(HAL_TRANSFORM_ROT_180));
+    EXPECT_TRUE(VaRotation::isSwapped(HAL_TRANSFORM_ROT_270));
+}
+
+TEST(VaRotationTest, IsRotation)
+{
+    EXPECT_TRUE(VaRotation::isRotation(0));
+    EXPECT_TRUE(VaRotation::isRotation(HAL_TRANSFORM_ROT_90));
+    EXPECT_TRUE(VaRotation::isRotation(HAL_TRANSFORM_ROT_180));
+    EXPECT_TRUE(VaRotation::isRotation(HAL_TRANSFORM_ROT_270));
+
+    // flips alone or on top of a rotation are rejected
+    EXPECT_FALSE(VaRotation::isRotation(HAL_TRANSFORM_FLIP_H));
+    EXPECT_FALSE(VaRotation::isRotation(HAL_TRANSFORM_FLIP_V));
+    EXPECT_FALSE(VaRotation::isRotation(HAL_TRANSFORM_ROT_90 | HAL_TRANSFORM_FLIP_H));
+    EXPECT_FALSE(VaRotation::isRotation(HAL_TRANSFORM_ROT_90 | HAL_TRANSFORM_FLIP_V));
+}
+
+TEST(VaRotationTest, Regions)
+{
+    VARectangle surface, output;
+
+    // 1080p frame decoded into a 1920x1088 buffer
+    VaRotation::getRegions(0, 0, 0, 1920, 1080, &surface, &output);
+    EXPECT_EQ(0, surface.x);
+    EXPECT_EQ(0, surface.y);
+    EXPECT_EQ(1920, surface.width);
+    EXPECT_EQ(1080, surface.height);
+    EXPECT_EQ(0, output.x);
+    EXPECT_EQ(0, output.y);
+    EXPECT_EQ(1920, output.width);
+    EXPECT_EQ(1080, output.height);
+
+    // cropped portrait video, the crop is read unrotated
+    VaRotation::getRegions(HAL_TRANSFORM_ROT_90, 16, 8, 1280, 720, &surface, &output);
+    EXPECT_EQ(16, surface.x);
+    EXPECT_EQ(8, surface.y);
+    EXPECT_EQ(1280, surface.width);
+    EXPECT_EQ(720, surface.height);
+    EXPECT_EQ(0, output.x);
+    EXPECT_EQ(0, output.y);
+    EXPECT_EQ(720, output.width);
+    EXPECT_EQ(1280, output.height);
+
+    VaRotation::getRegions(HAL_TRANSFORM_ROT_270, 16, 8, 1280, 720, &surface, &output);
+    EXPECT_EQ(720, output.width);
+    EXPECT_EQ(1280, output.height);
+
+    // upside down keeps the size
+    VaRotation::getRegions(HAL_TRANSFORM_ROT_180, 16, 8, 1280, 720, &surface, &output);
+    EXPECT_EQ(16, surface.x);
+    EXPECT_EQ(8, surface.y);
+    EXPECT_EQ(1280, output.width);
+    EXPECT_EQ(720, output.height);
+}
+
+TEST(VaRotationTest, IsSupported)
+{
+    uint32_t flags = (1 << VA_ROTATION_NONE) | (1 << VA_ROTATION_90) | (1 << VA_ROTATION_270);
+
+    EXPECT_TRUE(VaRotation::isSupported(flags, VA_ROTATION_90));
+    EXPECT_FALSE(VaRotation::isSupported(flags, VA_ROTATION_180));
+    EXPECT_TRUE(VaRotation::isSupported(flags, VA_ROTATION_270));
+
+    // no caps still allows the unrotated path
+    EXPECT_TRUE(VaRotation::isSupported(0, VA_ROTATION_NONE));
+    EXPECT_FALSE(VaRotation::isSupported(0, VA_ROTATION_90));
+}
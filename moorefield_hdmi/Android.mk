@@ -62,6 +62,7 @@ LOCAL_SRC_FILES += \
     ips/common/VsyncControl.cpp \
     ips/common/OverlayPlaneBase.cpp \
     ips/common/SpritePlaneBase.cpp \
+    ips/common/FramebufferScaler.cpp \
     ips/common/PixelFormat.cpp \
     ips/common/GrallocBufferBase.cpp \
     ips/common/GrallocBufferMapperBase.cpp \
@@ -28,7 +28,10 @@ ExternalDevice::ExternalDevice(uint32_t disp, Hwcomposer& hwc, DisplayPlaneManag
       mHdcpControl(NULL),
       mAbortModeSettingCond(),
       mPendingDrmMode(),
-      mHotplugEventPending(false)
+      mHotplugEventPending(false),
+      mModeChangePending(false),
+      mSwitchInPlace(false),
+      mModeChanged(false)
 {
     CTRACE();
 }
@@ -82,18 +85,39 @@ void ExternalDevice::deinitialize()
     }
 
     mHotplugEventPending = false;
+    mModeChangePending = false;
+    mModeChanged = false;
     PhysicalDevice::deinitialize();
 }
 
+bool ExternalDevice::prepare(hwc_display_contents_1_t *display)
+{
+    RETURN_FALSE_IF_NOT_INIT();
+
+    // planes are assigned to the new mode when the list is rebuilt
+    bool modeChanged;
+    {
+        Mutex::Autolock lock(mLock);
+        modeChanged = mModeChanged;
+        mModeChanged = false;
+    }
+    if (modeChanged && display) {
+        display->flags |= HWC_GEOMETRY_CHANGED;
+    }
+
+    return PhysicalDevice::prepare(display);
+}
+
 bool ExternalDevice::blank(bool blank)
 {
     if (!PhysicalDevice::blank(blank)) {
         return false;
     }
 
+    // the session outlives a blank, hot unplug stops it
     if (blank) {
-        mHdcpControl->stopHdcp();
-    } else if (mConnected) {
+        mHdcpControl->suspendHdcp();
+    } else if (mConnected && !mHdcpControl->resumeHdcp()) {
         mHdcpControl->startHdcpAsync(HdcpLinkStatusListener, this);
     }
     return true;
@@ -117,9 +141,18 @@ bool ExternalDevice::setDrmMode(drmModeModeInfo& value)
     if (drm->isSameDrmMode(&value, &mode))
         return true;
 
-    // any issue here by faking connection status?
-    mConnected = false;
-    mPendingDrmMode = value;
+    // frame buffer keeps its size, so the mode is switched at a vsync
+    // without SurfaceFlinger recreating the display
+    mSwitchInPlace = value.hdisplay == mode.hdisplay && value.vdisplay == mode.vdisplay;
+    if (mSwitchInPlace) {
+        Mutex::Autolock lock(mLock);
+        mPendingDrmMode = value;
+        mModeChangePending = true;
+    } else {
+        // any issue here by faking connection status?
+        mConnected = false;
+        mPendingDrmMode = value;
+    }
 
     // setting mode in a working thread
     mThread = new ModeSettingThread(this);
@@ -135,10 +168,73 @@ bool ExternalDevice::setDrmMode(drmModeModeInfo& value)
 bool ExternalDevice::threadLoop()
 {
     // one-time execution
-    setDrmMode();
+    if (mSwitchInPlace) {
+        switchDrmMode();
+    } else {
+        setDrmMode();
+    }
     return false;
 }
 
+void ExternalDevice::switchDrmMode()
+{
+    drmModeModeInfo mode;
+    int64_t timestamp;
+
+    {
+        Mutex::Autolock lock(mLock);
+        if (!mModeChangePending) {
+            return;
+        }
+        mode = mPendingDrmMode;
+    }
+
+    ILOGTRACE("switching to %dx%d@%dHz", mode.hdisplay, mode.vdisplay, mode.vrefresh);
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    // keep the HDCP session, its link checks pause while timings change
+    bool hdcpSuspended = mHdcpControl->suspendHdcp();
+
+    // change timings right after a frame has been scanned out
+    IVsyncControl *vsyncControl = createVsyncControl();
+    if (!vsyncControl || !vsyncControl->initialize() ||
+        !vsyncControl->wait(mType, timestamp)) {
+        WLOGTRACE("failed to wait for vsync, switching mode now");
+    }
+    if (vsyncControl) {
+        vsyncControl->deinitialize();
+        delete vsyncControl;
+    }
+
+    {
+        Mutex::Autolock lock(mLock);
+        Drm *drm = Hwcomposer::getInstance().getDrm();
+        if (!mModeChangePending) {
+            ILOGTRACE("mode switch is interrupted");
+        } else if (!drm->setDrmMode(mType, mode)) {
+            ELOGTRACE("failed to set Drm mode");
+        } else if (!updateDisplayConfigs()) {
+            ELOGTRACE("failed to update display configs");
+        } else {
+            mModeChanged = true;
+        }
+        mModeChangePending = false;
+    }
+
+    // the link is checked once on the new timings and authenticated
+    // again only if it was lost. hotplug starts HDCP itself if it changed
+    // the connection, starting it again is a no-op
+    if (!hdcpSuspended || !mHdcpControl->resumeHdcp()) {
+        if (mConnected) {
+            mHdcpControl->startHdcpAsync(HdcpLinkStatusListener, this);
+        }
+    }
+    mHwc.invalidate();
+
+    ILOGTRACE("mode switched in %lld us",
+        ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start));
+}
+
 void ExternalDevice::setDrmMode()
 {
     ILOGTRACE("start mode setting...");
@@ -219,6 +315,10 @@ void ExternalDevice::hotplugListener()
 
     // abort mode settings if it is in the middle
     mAbortModeSettingCond.signal();
+    {
+        Mutex::Autolock lock(mLock);
+        mModeChangePending = false;
+    }
 
     // remember the current connection status before detection
     bool connected = mConnected;
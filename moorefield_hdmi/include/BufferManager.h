@@ -59,8 +59,9 @@ public:
 
     uint32_t allocGrallocBuffer(uint32_t width, uint32_t height, uint32_t format, uint32_t usage);
     void freeGrallocBuffer(uint32_t handle);
+    // the blit is waited for unless fenceFd is given to receive its fence
     virtual bool blitGrallocBuffer(uint32_t srcHandle, uint32_t dstHandle,
-                                  crop_t& srcCrop, uint32_t async) = 0;
+                                  crop_t& srcCrop, int *fenceFd) = 0;
 protected:
     virtual DataBuffer* createDataBuffer(uint32_t handle) = 0;
     virtual BufferMapper* createBufferMapper(DataBuffer& buffer) = 0;
@@ -96,6 +96,9 @@ public:
     // hardware operations
     virtual bool flip(void *ctx);
     virtual void postFlip();
+    // fence the display waits on before showing the flipped buffer,
+    // owned by the caller, -1 if there is none
+    virtual int takeFlipFence() { return -1; }
 
     virtual bool reset();
     virtual bool enable() = 0;
@@ -32,6 +32,7 @@ public:
 public:
     virtual bool initialize();
     virtual void deinitialize();
+    virtual bool prepare(hwc_display_contents_1_t *display);
     virtual bool blank(bool blank);
     virtual bool setDrmMode(drmModeModeInfo& value);
     virtual void setRefreshRate(int hz);
@@ -48,6 +49,7 @@ private:
     static void HdcpLinkStatusListener(bool success, void *userData);
     void HdcpLinkStatusListener(bool success);
     void setDrmMode();
+    void switchDrmMode();
 
 protected:
     virtual IHdcpControl* createHdcpControl() = 0;
@@ -63,6 +65,12 @@ private:
     Condition mAbortModeSettingCond;
     drmModeModeInfo mPendingDrmMode;
     bool mHotplugEventPending;
+    // mode of the same size switched by the thread, hotplug drops it
+    bool mModeChangePending;
+    // thread switches the mode without a hotplug cycle
+    bool mSwitchInPlace;
+    // planes are reassigned to the switched mode by the next prepare
+    bool mModeChanged;
 
 private:
     DECLARE_THREAD(ModeSettingThread, ExternalDevice);
@@ -29,6 +29,11 @@ public:
     virtual bool startHdcp() = 0;
     virtual bool startHdcpAsync(HdcpStatusCallback cb, void *userData) = 0;
     virtual bool stopHdcp() = 0;
+    // keep the session while the display is blanked, link checks pause
+    virtual bool suspendHdcp() = 0;
+    // check the link and authenticate again only if it was lost,
+    // false if HDCP is not running
+    virtual bool resumeHdcp() = 0;
 };
 
 } // namespace intel
@@ -42,33 +42,58 @@ bool AnnRGBPlane::enable()
 
 bool AnnRGBPlane::disable()
 {
+    // the frame buffer shown last may be rendered again while disabled
+    mScaler.invalidate();
     return enablePlane(false);
 }
 
 bool AnnRGBPlane::reset()
 {
-    while (!mScalingBufferMap.isEmpty()) {
-        uint32_t handle = mScalingBufferMap.valueAt(0);
-        Hwcomposer::getInstance().getBufferManager()->freeGrallocBuffer(handle);
-        mScalingBufferMap.removeItemsAt(0);
-    }
-
+    mScaler.reset();
     return DisplayPlane::reset();
 }
 
 bool AnnRGBPlane::flip(void*)
 {
-    if (mForceScaling) {
-        BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
-        if (!bm->blitGrallocBuffer(mScalingSource, mScalingTarget, mDisplayCrop, 0)) {
-            ELOGTRACE("Failed to blit RGB buffer.");
-            return false;
-        }
+    if (!mForceScaling) {
+        mScaler.invalidate();
+        return true;
+    }
+
+    // display waits for the blit, commit doesn't
+    if (!mScaler.flip(mScalingSource, mScalingTarget, mDisplayCrop)) {
+        ELOGTRACE("Failed to blit RGB buffer.");
+        return false;
     }
 
     return true;
 }
 
+int AnnRGBPlane::takeFlipFence()
+{
+    return mScaler.takeFence();
+}
+
+uint32_t AnnRGBPlane::Scaler::allocTarget(uint32_t width, uint32_t height)
+{
+    BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
+    return bm->allocGrallocBuffer(width, height,
+                                  HAL_PIXEL_FORMAT_RGBA_8888,
+                                  GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE);
+}
+
+void AnnRGBPlane::Scaler::freeTarget(uint32_t target)
+{
+    BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
+    bm->freeGrallocBuffer(target);
+}
+
+bool AnnRGBPlane::Scaler::blit(uint32_t source, uint32_t target, crop_t& crop, int *fenceFd)
+{
+    BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
+    return bm->blitGrallocBuffer(source, target, crop, fenceFd);
+}
+
 void* AnnRGBPlane::getContext() const
 {
     CTRACE();
@@ -93,31 +118,11 @@ bool AnnRGBPlane::setDataBuffer(uint32_t handle)
     }
 
     if (mForceScaling) {
-        BufferManager *bm = Hwcomposer::getInstance().getBufferManager();
-        ssize_t index = mScalingBufferMap.indexOfKey(handle);
-        if (index < 0) {
-            mScalingTarget = bm->allocGrallocBuffer(
-                    mDisplayWidth,
-                    mDisplayHeight,
-                    HAL_PIXEL_FORMAT_RGBA_8888,
-                    GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE);
-            if (!mScalingTarget) {
-                ELOGTRACE("Failed to allocate gralloc buffer.");
-                return false;
-            }
-
-            if (mScalingBufferMap.size() >= MAX_SCALING_BUF_COUNT) {
-                while (!mScalingBufferMap.isEmpty()) {
-                    uint32_t handle = mScalingBufferMap.valueAt(0);
-                    bm->freeGrallocBuffer(handle);
-                    mScalingBufferMap.removeItemsAt(0);
-                }
-            }
-
-            mScalingBufferMap.add(handle, mScalingTarget);
-        } else {
-            mScalingTarget = mScalingBufferMap.valueAt(index);
+        uint32_t target = mScaler.getTarget(handle, mDisplayWidth, mDisplayHeight);
+        if (!target) {
+            return false;
         }
+        mScalingTarget = target;
         mScalingSource = handle;
         handle = mScalingTarget;
     }
@@ -20,6 +20,7 @@
 #include <Hwcomposer.h>
 #include <common/buffers/BufferCache.h>
 #include <DisplayPlane.h>
+#include <ips/common/FramebufferScaler.h>
 
 #include <linux/psb_drm.h>
 
@@ -38,6 +39,7 @@ public:
     bool isDisabled();
     bool flip(void *ctx);
     void postFlip();
+    int takeFlipFence();
 
     void* getContext() const;
     void setZOrderConfig(ZOrderConfig& config, void *nativeConfig);
@@ -52,11 +54,14 @@ protected:
     struct intel_dc_plane_ctx mContext;
 
 private:
-    // scaling buffer vector max size
-    enum {
-        MAX_SCALING_BUF_COUNT = 3,
+    // scales frame buffer targets with the buffer manager blitter
+    class Scaler : public FramebufferScaler {
+    protected:
+        uint32_t allocTarget(uint32_t width, uint32_t height);
+        void freeTarget(uint32_t target);
+        bool blit(uint32_t source, uint32_t target, crop_t& crop, int *fenceFd);
     };
-    KeyedVector<uint32_t, uint32_t> mScalingBufferMap;
+    Scaler mScaler;
 };
 
 } // namespace intel
@@ -0,0 +1,151 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <common/utils/HwcTrace.h>
+#include <ips/common/FramebufferScaler.h>
+#include <sync/sync.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+namespace intel {
+
+FramebufferScaler::FramebufferScaler()
+    : mUseCount(0),
+      mFlipSource(0),
+      mFlipTarget(0),
+      mFence(-1),
+      mFenceTaken(false),
+      mBlitCount(0),
+      mSkipCount(0)
+{
+    memset(mTargets, 0, sizeof(mTargets));
+}
+
+FramebufferScaler::~FramebufferScaler()
+{
+    if (mFence >= 0) {
+        close(mFence);
+    }
+}
+
+uint32_t FramebufferScaler::getTarget(uint32_t source, uint32_t width, uint32_t height)
+{
+    Target *victim = NULL;
+
+    mUseCount++;
+    for (int i = 0; i < MAX_TARGET_COUNT; i++) {
+        Target *t = &mTargets[i];
+        if (t->target && t->source == source) {
+            t->lastUse = mUseCount;
+            return t->target;
+        }
+
+        // free slots first, then the least recently used target
+        // other than the one on screen
+        if (!t->target) {
+            if (!victim || victim->target)
+                victim = t;
+        } else if (t->target != mFlipTarget) {
+            if (!victim || (victim->target && t->lastUse < victim->lastUse))
+                victim = t;
+        }
+    }
+
+    if (!victim) {
+        ELOGTRACE("no scaling target available");
+        return 0;
+    }
+
+    if (!victim->target) {
+        victim->target = allocTarget(width, height);
+        if (!victim->target) {
+            ELOGTRACE("failed to allocate scaling target");
+            return 0;
+        }
+    }
+
+    victim->source = source;
+    victim->lastUse = mUseCount;
+    return victim->target;
+}
+
+bool FramebufferScaler::flip(uint32_t source, uint32_t target, crop_t& crop)
+{
+    if (source == mFlipSource && target == mFlipTarget) {
+        mSkipCount++;
+        return true;
+    }
+
+    // blits are done in order, the next one replaces the last fence
+    if (mFence >= 0) {
+        close(mFence);
+        mFence = -1;
+    }
+    mFenceTaken = false;
+
+    if (!blit(source, target, crop, &mFence)) {
+        ELOGTRACE("failed to blit %#x to %#x", source, target);
+        mFence = -1;
+        mFlipSource = 0;
+        mFlipTarget = 0;
+        return false;
+    }
+
+    mFlipSource = source;
+    mFlipTarget = target;
+    mBlitCount++;
+    VLOGTRACE("blits %u, skipped %u", mBlitCount, mSkipCount);
+    return true;
+}
+
+void FramebufferScaler::invalidate()
+{
+    mFlipSource = 0;
+    mFlipTarget = 0;
+}
+
+int FramebufferScaler::takeFence()
+{
+    if (mFence < 0 || mFenceTaken) {
+        return -1;
+    }
+
+    mFenceTaken = true;
+    return dup(mFence);
+}
+
+void FramebufferScaler::reset()
+{
+    // the last blit may still write to its target
+    if (mFence >= 0) {
+        sync_wait(mFence, -1);
+        close(mFence);
+        mFence = -1;
+    }
+    mFenceTaken = false;
+
+    for (int i = 0; i < MAX_TARGET_COUNT; i++) {
+        if (mTargets[i].target) {
+            freeTarget(mTargets[i].target);
+        }
+    }
+    memset(mTargets, 0, sizeof(mTargets));
+
+    invalidate();
+}
+
+} // namespace intel
+} // namespace android
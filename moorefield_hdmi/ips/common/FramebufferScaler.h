@@ -0,0 +1,83 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#ifndef FRAMEBUFFER_SCALER_H
+#define FRAMEBUFFER_SCALER_H
+
+#include <DataBuffer.h>
+
+namespace android {
+namespace intel {
+
+// scales frame buffer targets into display sized targets for a plane
+// that can't scale. SurfaceFlinger renders into a frame buffer target
+// only after it was released, and the one on screen is released only
+// when a different one is posted. A source posted by two flips in a row
+// therefore has the same contents and is not blitted again. Any flip of
+// the plane that doesn't go through flip() must call invalidate().
+class FramebufferScaler {
+public:
+    FramebufferScaler();
+    virtual ~FramebufferScaler();
+public:
+    // target to scale source into, reuses the least recently used target
+    // other than the one on screen. 0 if none is available
+    uint32_t getTarget(uint32_t source, uint32_t width, uint32_t height);
+    // scale source into target for the next flip, the display waits for
+    // the blit through takeFence()
+    bool flip(uint32_t source, uint32_t target, crop_t& crop);
+    // the plane flipped without scaling, the next source is blitted
+    void invalidate();
+    // fence of the blit of the last flip, owned by the caller. -1 if
+    // there is none or it was taken already
+    int takeFence();
+    // wait for the last blit and free all targets
+    void reset();
+
+    uint32_t getBlitCount() const { return mBlitCount; }
+    uint32_t getSkipCount() const { return mSkipCount; }
+
+protected:
+    virtual uint32_t allocTarget(uint32_t width, uint32_t height) = 0;
+    virtual void freeTarget(uint32_t target) = 0;
+    // fenceFd receives the fence of the blit
+    virtual bool blit(uint32_t source, uint32_t target, crop_t& crop, int *fenceFd) = 0;
+
+private:
+    enum {
+        MAX_TARGET_COUNT = 3,
+    };
+    struct Target {
+        uint32_t source;
+        uint32_t target;
+        uint32_t lastUse;
+    };
+    Target mTargets[MAX_TARGET_COUNT];
+    uint32_t mUseCount;
+
+    // last flip, 0 after a flip without scaling
+    uint32_t mFlipSource;
+    uint32_t mFlipTarget;
+    // fence of the last blit, kept to wait for it on reset
+    int mFence;
+    bool mFenceTaken;
+    uint32_t mBlitCount;
+    uint32_t mSkipCount;
+};
+
+} // namespace intel
+} // namespace android
+
+#endif /* FRAMEBUFFER_SCALER_H */
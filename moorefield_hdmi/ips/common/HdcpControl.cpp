@@ -34,6 +34,7 @@ HdcpControl::HdcpControl()
       mCompletedCondition(),
       mWaitForCompletion(false),
       mStopped(true),
+      mSuspended(false),
       mAuthenticated(false),
       mActionDelay(0),
       mAuthRetryCount(0),
@@ -64,6 +65,7 @@ bool HdcpControl::startHdcp()
     }
 
     mStopped = false;
+    mSuspended = false;
     mAuthenticated = false;
     mWaitForCompletion = false;
 
@@ -137,6 +139,7 @@ bool HdcpControl::startHdcpAsync(HdcpStatusCallback cb, void *userData)
     mWaitForCompletion = false;
     mAuthenticated = false;
     mStopped = false;
+    mSuspended = false;
     mActionDelay = HDCP_ASYNC_START_DELAY_MS;
     mThread->run("HdcpControl", PRIORITY_NORMAL);
 
@@ -169,6 +172,45 @@ bool HdcpControl::stopHdcp()
     return true;
 }
 
+bool HdcpControl::suspendHdcp()
+{
+    Mutex::Autolock lock(mMutex);
+    if (mStopped) {
+        return false;
+    }
+
+    // authentication stays enabled, a blanked link is not verified
+    mSuspended = true;
+    return true;
+}
+
+bool HdcpControl::resumeHdcp()
+{
+    Mutex::Autolock lock(mMutex);
+    if (mStopped) {
+        return false;
+    }
+
+    if (!mSuspended) {
+        return true;
+    }
+    mSuspended = false;
+
+    // one link status read, authentication is redone only if it failed
+    if (mAuthenticated && checkAuthenticated()) {
+        ILOGTRACE("HDCP link kept across blank");
+        mActionDelay = HDCP_VERIFICATION_DELAY_MS;
+    } else {
+        mAuthenticated = false;
+        mAuthRetryCount = 0;
+        mActionDelay = 0;
+    }
+
+    // wake the thread to verify or authenticate on the new schedule
+    mStoppedCondition.signal();
+    return true;
+}
+
 bool HdcpControl::enableAuthentication()
 {
     int fd = Hwcomposer::getInstance().getDrm()->getDrmFd();
@@ -341,13 +383,29 @@ void HdcpControl::signalCompletion()
 bool HdcpControl::threadLoop()
 {
     Mutex::Autolock lock(mMutex);
-    status_t err = mStoppedCondition.waitRelative(mMutex, milliseconds(mActionDelay));
-    if (err != -ETIMEDOUT) {
+    while (mSuspended && !mStopped) {
+        mStoppedCondition.wait(mMutex);
+    }
+
+    status_t err = NO_ERROR;
+    if (!mStopped) {
+        err = mStoppedCondition.waitRelative(mMutex, milliseconds(mActionDelay));
+    }
+    if (mStopped) {
         ILOGTRACE("Hdcp is stopped.");
         signalCompletion();
         return false;
     }
 
+    if (mSuspended) {
+        return true;
+    }
+
+    // woken up by resume
+    if (err != -ETIMEDOUT && mAuthenticated) {
+        return true;
+    }
+
     // default is to keep thread active
     bool ret = true;
     if (!mAuthenticated) {
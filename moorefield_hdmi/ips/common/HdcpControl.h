@@ -31,16 +31,18 @@ public:
     virtual bool startHdcp();
     virtual bool startHdcpAsync(HdcpStatusCallback cb, void *userData);
     virtual bool stopHdcp();
+    virtual bool suspendHdcp();
+    virtual bool resumeHdcp();
 
 protected:
-    bool enableAuthentication();
-    bool disableAuthentication();
+    virtual bool enableAuthentication();
+    virtual bool disableAuthentication();
     bool enableOverlay();
     bool disableOverlay();
     bool enableDisplayIED();
     bool disableDisplayIED();
     bool isHdcpSupported();
-    bool checkAuthenticated();
+    virtual bool checkAuthenticated();
     virtual bool preRunHdcp();
     virtual bool postRunHdcp();
     bool runHdcp();
@@ -73,6 +75,7 @@ protected:
     Condition mCompletedCondition;
     bool mWaitForCompletion;
     bool mStopped;
+    bool mSuspended;
     bool mAuthenticated;
     int mActionDelay;  // in milliseconds
     uint32_t mAuthRetryCount;
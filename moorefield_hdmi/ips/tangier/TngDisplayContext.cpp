@@ -20,6 +20,7 @@
 #include <IDisplayDevice.h>
 #include <common/base/HwcLayerList.h>
 #include <ips/tangier/TngDisplayContext.h>
+#include <sync/sync.h>
 
 namespace android {
 namespace intel {
@@ -104,6 +105,25 @@ bool TngDisplayContext::commitContents(hwc_display_contents_1_t *display, HwcLay
             continue;
         }
 
+        // post hands the acquire fence to the display, add the fence of
+        // content the plane produced itself
+        int fence = plane->takeFlipFence();
+        if (fence >= 0) {
+            hwc_layer_1_t& layer = display->hwLayers[i];
+            if (layer.acquireFenceFd < 0) {
+                layer.acquireFenceFd = fence;
+            } else {
+                int merged = sync_merge("hwc_flip", layer.acquireFenceFd, fence);
+                if (merged < 0) {
+                    sync_wait(fence, -1);
+                } else {
+                    close(layer.acquireFenceFd);
+                    layer.acquireFenceFd = merged;
+                }
+                close(fence);
+            }
+        }
+
         IMG_hwc_layer_t *imgLayer = &imgLayerList[mCount++];
         // update IMG layer
         imgLayer->psLayer = &display->hwLayers[i];
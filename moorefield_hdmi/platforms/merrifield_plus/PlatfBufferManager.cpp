@@ -54,24 +54,27 @@ BufferMapper* PlatfBufferManager::createBufferMapper(DataBuffer& buffer)
 }
 
 bool PlatfBufferManager::blitGrallocBuffer(uint32_t srcHandle, uint32_t dstHandle,
-                                  crop_t& srcCrop, uint32_t async)
+                                  crop_t& srcCrop, int *fenceFd)
 
 {
-    int fenceFd;
+    int fence;
 
     if (gralloc_blit_handle_to_handle_img(mGralloc,
                                 (buffer_handle_t)srcHandle,
                                 (buffer_handle_t)dstHandle,
                                 srcCrop.w, srcCrop.h, srcCrop.x,
-                                srcCrop.y, 0, -1, &fenceFd)) {
+                                srcCrop.y, 0, -1, &fence)) {
         ELOGTRACE("Blit failed");
         return false;
     }
 
-    if (!async) {
-        sync_wait(fenceFd, -1);
+    if (fenceFd) {
+        *fenceFd = fence;
+        return true;
     }
-    close(fenceFd);
+
+    sync_wait(fence, -1);
+    close(fence);
     return true;
 }
 
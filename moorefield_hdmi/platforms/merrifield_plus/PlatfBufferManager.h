@@ -34,7 +34,7 @@ protected:
     DataBuffer* createDataBuffer(uint32_t handle);
     BufferMapper* createBufferMapper(DataBuffer& buffer);
     bool blitGrallocBuffer(uint32_t srcHandle, uint32_t dstHandle,
-                                  crop_t& srcCrop, uint32_t async);
+                                  crop_t& srcCrop, int *fenceFd);
 };
 
 }
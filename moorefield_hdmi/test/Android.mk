@@ -0,0 +1,32 @@
+# Build the unit tests,
+LOCAL_PATH:= $(call my-dir)
+
+# Unit tests of the common helpers, the kernel interfaces are faked
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := hwc_hdmi_utils_test
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+    fake_hwcomposer.cpp \
+    framebuffer_scaler_test.cpp \
+    hdcp_control_test.cpp \
+    ../ips/common/FramebufferScaler.cpp \
+    ../ips/common/HdcpControl.cpp \
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libdrm \
+	libhardware \
+	liblog \
+	libsync \
+	libutils \
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/.. \
+    $(LOCAL_PATH)/../include \
+    $(LOCAL_PATH)/../include/pvr/hal \
+    $(TARGET_OUT_HEADERS)/libdrm \
+
+include $(BUILD_NATIVE_TEST)
@@ -0,0 +1,42 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <Hwcomposer.h>
+
+namespace android {
+namespace intel {
+
+// the units under test reach the kernel through virtual methods the
+// tests override, these only satisfy the linker
+
+Hwcomposer* Hwcomposer::sInstance(0);
+
+Hwcomposer* Hwcomposer::createHwcomposer()
+{
+    return 0;
+}
+
+Drm* Hwcomposer::getDrm()
+{
+    return mDrm;
+}
+
+int Drm::getDrmFd() const
+{
+    return -1;
+}
+
+} // namespace intel
+} // namespace android
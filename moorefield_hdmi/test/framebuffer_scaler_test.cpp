@@ -0,0 +1,286 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/sw_sync.h>
+#include <sync/sync.h>
+#include <utils/Timers.h>
+
+#include <ips/common/FramebufferScaler.h>
+
+using namespace android;
+using namespace android::intel;
+
+// software sync timeline standing in for the GPU
+class Timeline {
+public:
+    Timeline()
+        : mFd(open("/dev/sw_sync", O_RDWR)),
+          mValue(0),
+          mQueued(0)
+    {
+    }
+    ~Timeline() {
+        if (mFd >= 0) {
+            close(mFd);
+        }
+    }
+
+    bool initCheck() const { return mFd >= 0; }
+
+    // fence of a job queued behind all earlier ones
+    int queue() {
+        struct sw_sync_create_fence_data data;
+        memset(&data, 0, sizeof(data));
+        data.value = ++mQueued;
+        strcpy(data.name, "hwc_test_blit");
+        if (ioctl(mFd, SW_SYNC_IOC_CREATE_FENCE, &data) < 0) {
+            return -1;
+        }
+        return data.fence;
+    }
+
+    // complete every queued job
+    void finish() {
+        __u32 count = mQueued - mValue;
+        ioctl(mFd, SW_SYNC_IOC_INC, &count);
+        mValue = mQueued;
+    }
+
+private:
+    int mFd;
+    uint32_t mValue;
+    uint32_t mQueued;
+};
+
+static bool isSignaled(int fence)
+{
+    return sync_wait(fence, 0) == 0;
+}
+
+// blitter whose blits complete when the test finishes the GPU timeline,
+// a blit that is waited for takes GPU_TIME_US
+class FakeScaler : public FramebufferScaler {
+public:
+    enum {
+        GPU_TIME_US = 4000,
+    };
+
+    FakeScaler()
+        : blitCount(0),
+          waitCount(0),
+          allocCount(0),
+          freeCount(0),
+          failBlit(false),
+          mNextTarget(0x1000)
+    {
+    }
+
+    Timeline gpu;
+    int blitCount;
+    int waitCount;
+    int allocCount;
+    int freeCount;
+    bool failBlit;
+
+protected:
+    uint32_t allocTarget(uint32_t /* width */, uint32_t /* height */) {
+        allocCount++;
+        return mNextTarget++;
+    }
+
+    void freeTarget(uint32_t /* target */) {
+        freeCount++;
+    }
+
+    bool blit(uint32_t /* source */, uint32_t /* target */, crop_t& /* crop */, int *fenceFd) {
+        if (failBlit) {
+            return false;
+        }
+        blitCount++;
+        if (!fenceFd) {
+            waitCount++;
+            usleep(GPU_TIME_US);
+            return true;
+        }
+        *fenceFd = gpu.queue();
+        return *fenceFd >= 0;
+    }
+
+private:
+    uint32_t mNextTarget;
+};
+
+class FramebufferScalerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ASSERT_TRUE(scaler.gpu.initCheck());
+        memset(&crop, 0, sizeof(crop));
+        crop.w = 1920;
+        crop.h = 1080;
+    }
+
+    virtual void TearDown() {
+        scaler.gpu.finish();
+        scaler.reset();
+    }
+
+    // what the plane does for one commit of a scaled frame buffer target,
+    // returns the fence the display waits on
+    int commit(uint32_t source) {
+        uint32_t target = scaler.getTarget(source, 1920, 1080);
+        EXPECT_NE(0u, target);
+        EXPECT_TRUE(scaler.flip(source, target, crop));
+        return scaler.takeFence();
+    }
+
+    FakeScaler scaler;
+    crop_t crop;
+};
+
+TEST_F(FramebufferScalerTest, RepeatedSourceIsNotBlitted)
+{
+    int fence = commit(0xa);
+    EXPECT_GE(fence, 0);
+    close(fence);
+
+    // SurfaceFlinger can't render into the frame buffer on screen
+    EXPECT_EQ(-1, commit(0xa));
+    EXPECT_EQ(-1, commit(0xa));
+    EXPECT_EQ(1, scaler.blitCount);
+    EXPECT_EQ(1u, scaler.getBlitCount());
+    EXPECT_EQ(2u, scaler.getSkipCount());
+}
+
+TEST_F(FramebufferScalerTest, SourceShownAgainIsBlitted)
+{
+    close(commit(0xa));
+    close(commit(0xb));
+
+    // 0xa was released by the flip of 0xb and may hold a new frame
+    close(commit(0xa));
+    EXPECT_EQ(3, scaler.blitCount);
+    EXPECT_EQ(2, scaler.allocCount);
+}
+
+TEST_F(FramebufferScalerTest, FlipWithoutScalingIsBlittedAgain)
+{
+    close(commit(0xa));
+
+    // the plane showed something else in between
+    scaler.invalidate();
+    close(commit(0xa));
+    EXPECT_EQ(2, scaler.blitCount);
+    EXPECT_EQ(1, scaler.allocCount);
+}
+
+TEST_F(FramebufferScalerTest, TargetOnScreenIsNotReused)
+{
+    close(commit(0xa));
+    close(commit(0xb));
+    close(commit(0xc));
+    EXPECT_EQ(3, scaler.allocCount);
+
+    // targets of 0xa and then 0xb are the least recently used ones
+    close(commit(0xd));
+    EXPECT_EQ(0x1000u, scaler.getTarget(0xd, 1920, 1080));
+    close(commit(0xe));
+    EXPECT_EQ(0x1001u, scaler.getTarget(0xe, 1920, 1080));
+    EXPECT_EQ(3, scaler.allocCount);
+
+    // the target on screen is never handed to another source
+    uint32_t onScreen = scaler.getTarget(0xe, 1920, 1080);
+    for (uint32_t source = 0x10; source < 0x20; source++) {
+        EXPECT_NE(onScreen, scaler.getTarget(source, 1920, 1080));
+    }
+}
+
+TEST_F(FramebufferScalerTest, FailedBlitIsRetried)
+{
+    uint32_t target = scaler.getTarget(0xa, 1920, 1080);
+    scaler.failBlit = true;
+    EXPECT_FALSE(scaler.flip(0xa, target, crop));
+    EXPECT_EQ(-1, scaler.takeFence());
+
+    scaler.failBlit = false;
+    int fence = commit(0xa);
+    EXPECT_GE(fence, 0);
+    close(fence);
+    EXPECT_EQ(1u, scaler.getBlitCount());
+    EXPECT_EQ(0u, scaler.getSkipCount());
+}
+
+TEST_F(FramebufferScalerTest, FenceIsTakenOnce)
+{
+    int fence = commit(0xa);
+    ASSERT_GE(fence, 0);
+    EXPECT_EQ(-1, scaler.takeFence());
+
+    // the display owns its copy, the scaler keeps one to wait on reset
+    EXPECT_FALSE(isSignaled(fence));
+    scaler.gpu.finish();
+    EXPECT_TRUE(isSignaled(fence));
+    close(fence);
+
+    scaler.reset();
+    EXPECT_EQ(1, scaler.freeCount);
+    EXPECT_EQ(-1, scaler.takeFence());
+}
+
+TEST_F(FramebufferScalerTest, CommitReplay)
+{
+    // frame buffer targets SurfaceFlinger posts to HDMI with forced
+    // scaling: 20 frames of animation over 3 buffers, 30 static frames
+    // with only overlay updates, then 10 more frames of animation
+    const uint32_t buffers[] = { 0xa, 0xb, 0xc };
+    uint32_t sources[60];
+    for (int i = 0; i < 60; i++) {
+        if (i < 20)
+            sources[i] = buffers[i % 3];
+        else if (i < 50)
+            sources[i] = sources[19];
+        else
+            sources[i] = buffers[(i - 30) % 3];
+    }
+
+    nsecs_t maxCommit = 0;
+    for (int i = 0; i < 60; i++) {
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        int fence = commit(sources[i]);
+        nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+        if (elapsed > maxCommit)
+            maxCommit = elapsed;
+
+        // the commit returns before the GPU is done, the display waits
+        if (fence >= 0) {
+            EXPECT_FALSE(isSignaled(fence));
+            close(fence);
+        }
+        scaler.gpu.finish();
+    }
+
+    // blitting every commit and waiting for it, as before, costs 60 blits
+    // and 60 * GPU_TIME_US of commit time
+    EXPECT_EQ(30, scaler.blitCount);
+    EXPECT_EQ(30u, scaler.getSkipCount());
+    EXPECT_EQ(0, scaler.waitCount);
+    EXPECT_EQ(3, scaler.allocCount);
+    EXPECT_LT(maxCommit, FakeScaler::GPU_TIME_US * 1000LL);
+}
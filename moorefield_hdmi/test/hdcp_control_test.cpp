@@ -0,0 +1,181 @@
+/*
+// Copyright (c) 2014 Intel Corporation 
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <cutils/atomic.h>
+#include <utils/Timers.h>
+
+#include <ips/common/HdcpControl.h>
+
+using namespace android;
+using namespace android::intel;
+
+// HDCP backend of a sink: authentication takes AUTH_TIME_US, a link
+// status read is immediate
+class FakeHdcpControl : public HdcpControl {
+public:
+    enum {
+        AUTH_TIME_US = 20000,
+    };
+
+    FakeHdcpControl()
+        : linkUp(false),
+          enableCount(0),
+          disableCount(0),
+          checkCount(0)
+    {
+    }
+
+    // link status the sink reports, set up by a successful authentication
+    volatile bool linkUp;
+    volatile int32_t enableCount;
+    volatile int32_t disableCount;
+    volatile int32_t checkCount;
+
+protected:
+    bool enableAuthentication() {
+        android_atomic_inc(&enableCount);
+        usleep(AUTH_TIME_US);
+        linkUp = true;
+        return true;
+    }
+
+    bool disableAuthentication() {
+        android_atomic_inc(&disableCount);
+        linkUp = false;
+        return true;
+    }
+
+    bool checkAuthenticated() {
+        android_atomic_inc(&checkCount);
+        mAuthenticated = linkUp;
+        return mAuthenticated;
+    }
+};
+
+// wait up to a second for the control thread to authenticate count times
+static bool waitForEnable(FakeHdcpControl& hdcp, int32_t count)
+{
+    for (int i = 0; i < 1000; i++) {
+        if (android_atomic_acquire_load(&hdcp.enableCount) >= count)
+            return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+TEST(HdcpControlTest, ResumeKeepsLiveLink)
+{
+    FakeHdcpControl hdcp;
+    ASSERT_TRUE(hdcp.startHdcp());
+    EXPECT_EQ(1, hdcp.enableCount);
+
+    EXPECT_TRUE(hdcp.suspendHdcp());
+    EXPECT_TRUE(hdcp.resumeHdcp());
+
+    // one link read, no authentication
+    EXPECT_EQ(1, hdcp.checkCount);
+    EXPECT_EQ(1, hdcp.enableCount);
+    EXPECT_EQ(0, hdcp.disableCount);
+
+    hdcp.stopHdcp();
+    EXPECT_EQ(1, hdcp.disableCount);
+}
+
+TEST(HdcpControlTest, ResumeAuthenticatesLostLink)
+{
+    FakeHdcpControl hdcp;
+    ASSERT_TRUE(hdcp.startHdcp());
+
+    // the sink dropped the session while blanked
+    EXPECT_TRUE(hdcp.suspendHdcp());
+    hdcp.linkUp = false;
+    EXPECT_TRUE(hdcp.resumeHdcp());
+    EXPECT_EQ(1, hdcp.checkCount);
+
+    // the control thread authenticates again right away
+    EXPECT_TRUE(waitForEnable(hdcp, 2));
+    hdcp.stopHdcp();
+}
+
+TEST(HdcpControlTest, ResumeWithoutSuspend)
+{
+    FakeHdcpControl hdcp;
+    ASSERT_TRUE(hdcp.startHdcp());
+
+    EXPECT_TRUE(hdcp.resumeHdcp());
+    EXPECT_EQ(0, hdcp.checkCount);
+    hdcp.stopHdcp();
+}
+
+TEST(HdcpControlTest, StoppedSessionIsNotKept)
+{
+    FakeHdcpControl hdcp;
+
+    // the caller starts HDCP when there is no session to keep
+    EXPECT_FALSE(hdcp.suspendHdcp());
+    EXPECT_FALSE(hdcp.resumeHdcp());
+
+    ASSERT_TRUE(hdcp.startHdcp());
+    hdcp.stopHdcp();
+    EXPECT_FALSE(hdcp.suspendHdcp());
+    EXPECT_FALSE(hdcp.resumeHdcp());
+}
+
+TEST(HdcpControlTest, StopWhileSuspended)
+{
+    FakeHdcpControl hdcp;
+    ASSERT_TRUE(hdcp.startHdcp());
+    EXPECT_TRUE(hdcp.suspendHdcp());
+
+    // hot unplug during blank, the parked thread has to exit
+    EXPECT_TRUE(hdcp.stopHdcp());
+    EXPECT_EQ(1, hdcp.disableCount);
+    EXPECT_EQ(0, hdcp.checkCount);
+    EXPECT_FALSE(hdcp.resumeHdcp());
+}
+
+TEST(HdcpControlTest, UnblankLatency)
+{
+    const int cycles = 5;
+    FakeHdcpControl hdcp;
+
+    // stopping on blank pays a full authentication on every unblank
+    nsecs_t restart = 0;
+    for (int i = 0; i < cycles; i++) {
+        hdcp.stopHdcp();
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        ASSERT_TRUE(hdcp.startHdcp());
+        restart += systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    }
+    EXPECT_EQ(cycles, hdcp.enableCount);
+
+    // a kept session only reads the link status
+    nsecs_t resume = 0;
+    for (int i = 0; i < cycles; i++) {
+        ASSERT_TRUE(hdcp.suspendHdcp());
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        ASSERT_TRUE(hdcp.resumeHdcp());
+        resume += systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    }
+    EXPECT_EQ(cycles, hdcp.enableCount);
+    EXPECT_EQ(cycles, hdcp.checkCount);
+
+    EXPECT_GE(restart, cycles * FakeHdcpControl::AUTH_TIME_US * 1000LL);
+    EXPECT_LT(resume, FakeHdcpControl::AUTH_TIME_US * 1000LL);
+    hdcp.stopHdcp();
+}